@@ -37,8 +37,13 @@ core::core()
     _log_level = debug;
     _output_station_ptv = true;
     _use_netcdf=false;
+    _netcdf_prefetch=4;
+    _netcdf_first_ts=0;
     _load_from_checkpoint=false;
     _do_checkpoint=false;
+    _use_task_graph=false;
+    _face_tile_size=0;
+    _point_output_rows = 1024;
 }
 
 core::~core()
@@ -101,6 +106,53 @@ void core::config_options( pt::ptree &value)
         LOG_WARNING << "Unknown interpolant selected, defaulting to spline";
     }
 
+    // chunked: run the data/domain chunks in order, one after another
+    // graph: run the modules as a task graph so independent domain modules run concurrently. Opt-in, as the graph's
+    //        edges only come from what the modules declare with depends/optionals/provides: a module that reads a
+    //        variable it doesn't declare may run at the same time as the module writing it. Modules that declare no
+    //        inputs at all are kept in the chunked order.
+    std::string sched = value.get<std::string>("scheduler","chunked");
+    if (sched == "graph")
+    {
+#ifdef USE_MPI
+        // the halo exchanges have to happen in the same order on every process
+        LOG_WARNING << "The task graph scheduler is not available with MPI, defaulting to chunked";
+#else
+        _use_task_graph = true;
+        LOG_DEBUG << "Using the task graph scheduler";
+#endif
+    }
+    else if (sched != "chunked")
+    {
+        LOG_WARNING << "Unknown scheduler selected, defaulting to chunked";
+    }
+
+    // faces per tile for the data parallel sweeps, 0 = per face. A few hundred faces keeps a tile's variables in L2
+    int tile = value.get<int>("tile_size", 0);
+    if (tile < 0)
+    {
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("tile_size must be >= 0"));
+    }
+    _face_tile_size = tile;
+    if (_face_tile_size > 0)
+        LOG_DEBUG << "Running data parallel modules on tiles of " << _face_tile_size << " faces";
+
+    // number of output snapshots that may wait for the output writer thread before the timestep loop blocks
+    int queue = value.get<int>("output_queue", 2);
+    if (queue < 1)
+    {
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("output_queue must be >= 1"));
+    }
+    _output_writer.set_capacity(queue);
+
+    // point outputs are written out every point_output_rows timesteps
+    int rows = value.get<int>("point_output_rows", 1024);
+    if (rows < 1)
+    {
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("point_output_rows must be >= 1"));
+    }
+    _point_output_rows = rows;
+
 
     // project name
     boost::optional<std::string> prj = value.get_optional<std::string>("prj_name");
@@ -348,6 +400,9 @@ void core::config_forcing(pt::ptree &value)
     //need to determine if we have been given a netcdf file
     _use_netcdf = value.get("use_netcdf",false);
 
+    // number of netcdf timesteps held in memory and read ahead of the model
+    _netcdf_prefetch = value.get("prefetch",4);
+
     size_t nstations = 0;
     timer c;
 
@@ -483,7 +538,10 @@ void core::config_forcing(pt::ptree &value)
                     //this ctor will init an empty timeseries for us
                     boost::shared_ptr<station> s = boost::make_shared<station>(station_name, longitude, latitude,
                                                                                elevation);
-                    s->raw_timeseries()->init(variables, date_vec);
+
+                    // The station only holds the current timestep, which is filled from the prefetch buffer every
+                    // timestep. Allocating the whole run for every grid point does not scale.
+                    s->raw_timeseries()->init(variables, netcdf::date_vec(1, date_vec.front()));
                     s->reset_itrs();
 
                     try
@@ -526,8 +584,9 @@ void core::config_forcing(pt::ptree &value)
             BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Something has gone wrong in forcing file read."));
         }
 
-        //#pragma omp parallel for
-        //TODO: this dead locks, not sure why <-- json reader isn't parallel safe
+        // The config (ptree) and the coordinate transform aren't thread safe, so the station metadata is read serially.
+        // The files themselves are independent and are the slow part, so they are parsed in parallel below.
+        std::vector<std::string> station_files(nstations);
         for(size_t i =0; i < nstations; ++i)
         {
             auto& itr = forcings.at(i);
@@ -573,7 +632,36 @@ void core::config_forcing(pt::ptree &value)
 
             std::string file = itr.second.get<std::string>("file");
             auto f = cwd_dir / file;
-            s->open(f.string());
+            station_files.at(i) = f.string();
+
+            pstations.at(i) = s;
+        }
+
+        // exceptions can't leave an omp region, so keep the first one and rethrow it once all the threads are done
+        std::exception_ptr open_error = nullptr;
+        #pragma omp parallel for
+        for(size_t i =0; i < nstations; ++i)
+        {
+            try
+            {
+                pstations.at(i)->open(station_files.at(i));
+            }
+            catch(...)
+            {
+                #pragma omp critical
+                {
+                    if(!open_error)
+                        open_error = std::current_exception();
+                }
+            }
+        }
+        if(open_error)
+            std::rethrow_exception(open_error);
+
+        for(size_t i =0; i < nstations; ++i)
+        {
+            auto& itr = forcings.at(i);
+            auto s = pstations.at(i);
 
             //filters with text timeseries behave differently than filters with the netcdf
             //these will be run once, over the entire timeseries. netcdf will call the filters and run it on every lazyload.
@@ -599,13 +687,15 @@ void core::config_forcing(pt::ptree &value)
             {
                 //ignore
             }
-
-            pstations.at(i) = s;
-
         }
 
     }
 
+    std::vector<Point_2> station_points;
+    for(size_t i = 0; i<nstations;i++)
+        station_points.push_back(Point_2(pstations.at(i)->x(), pstations.at(i)->y()));
+    auto closest_faces = _mesh->find_closest_faces(station_points);
+
     for(size_t i = 0; i<nstations;i++)
     {
         auto s = pstations.at(i);
@@ -614,8 +704,7 @@ void core::config_forcing(pt::ptree &value)
             points->InsertNextPoint(s->x(), s->y(), s->z());
             labels->SetValue(i, s->ID() );
         }
-        auto cf = _mesh->find_closest_face(s->x(),s->y());
-        s->set_closest_face(cf->cell_global_id);
+        s->set_closest_face(closest_faces[i]->cell_global_id);
 
         //do a few things behind _global's back for efficiency.
 //        auto s = pstations.at(i);
@@ -689,16 +778,39 @@ void core::config_meshes( pt::ptree &value)
     _find_and_insert_subjson(value);
 
     std::string mesh_path = value.get<std::string>("mesh");
+    bool triarea_found = false;
     LOG_DEBUG << "Found mesh:" << mesh_path;
 
     mesh_path = (cwd_dir / mesh_path).string();
 
-    pt::ptree mesh = read_json(mesh_path);
+    // Binary meshes (see tools/mesh2bin) are mmap'd by the triangulation. In that case this tree only collects any
+    // additional json parameters and initial conditions
+    bool is_binary_mesh = mesh_binary::is_binary(mesh_path);
+
+    pt::ptree mesh;
+    bool is_geographic = false;
+    if(is_binary_mesh)
+    {
+        LOG_DEBUG << "Mesh is binary";
+        mesh_binary bin(mesh_path);
+        is_geographic = bin.is_geographic();
+
+        // the binary file can already hold the area
+        for(auto& p : bin.parameters())
+        {
+            if(p == "area")
+                triarea_found = true;
+        }
+    }
+    else
+    {
+        mesh = read_json(mesh_path);
+        is_geographic = (bool)mesh.get<int>("mesh.is_geographic");
+    }
 
     //we need to check if we've read in a geographic (lat/long) mesh or a UTM mesh. We then need to swap in the right distance and point_bearing functions
     //so the modules and future code can blindly use them without worrying about these things
 
-    bool is_geographic = (bool)mesh.get<int>("mesh.is_geographic");
     _global->_is_geographic = is_geographic; // save it here so modules can determine if this is true
     if(is_geographic)
     {
@@ -712,7 +824,6 @@ void core::config_meshes( pt::ptree &value)
         math::gis::distance = &math::gis::distance_UTM;
     }
 
-    bool triarea_found = false;
     //see if we have additional parameter files to load
     try
     {
@@ -776,8 +887,14 @@ void core::config_meshes( pt::ptree &value)
     //we need to let the mesh know about any parameters the modules will provide so they can be correctly build into the static hashmaps
     for(auto& p : _provided_parameters)
         _mesh->_parameters.insert(p);
+
+    // renumber the faces so that neighbours are close in memory and, with MPI, on the same process
+    _mesh->set_face_order(value.get<std::string>("face_order", "none"));
     
-    _mesh->from_json(mesh);
+    if(is_binary_mesh)
+        _mesh->from_binary(mesh_path, mesh);
+    else
+        _mesh->from_json(mesh);
 
     _provided_parameters = _mesh->parameters();
     
@@ -846,6 +963,7 @@ void core::config_output(pt::ptree &value)
 
     _find_and_insert_subjson(value);
 
+    std::vector<output_info> outputs;
     for (auto &itr : value)
     {
         output_info out;
@@ -909,25 +1027,7 @@ void core::config_output(pt::ptree &value)
                 delete coordTrans;
             }
 
-            out.face = _mesh->locate_face(out.longitude, out.latitude);
-
-            if(out.face != nullptr)
-            {
-                // In MPI mode, we might not thave the output triangle on this node, so we just have to fail gracefully and hope that the other nodes have this.
-                // in the future we need a comms here to check if the nodes successfully figured out the output points
-                // for now, if we don't have it, print an error but keep going
-
-                //set the point to be the center of the triangle that the output point lies on
-                points->InsertNextPoint(out.face->get_x(), out.face->get_y(), out.face->get_z());
-                labels->InsertNextValue(out.name);
-
-                LOG_DEBUG << "Triangle geometry for output triangle = " << out_type << " slope: "
-                          << out.face->slope() * 180. / M_PI << " aspect:" << out.face->aspect() * 180. / M_PI;
-
-                out.face->_debug_name = out.name; //out_type holds the station name
-                out.face->_debug_ID = ID;
-                ++ID;
-            }
+            // out.face is found below, for all the output points at once
         }
         else if (out_type == "mesh")
         {
@@ -938,7 +1038,8 @@ void core::config_output(pt::ptree &value)
             boost::filesystem::create_directories(f.parent_path());
             out.fname = f.string();
 
-            _mesh->write_param_to_vtu( itr.second.get("write_parameters",true) ) ;
+            out.write_parameters = itr.second.get("write_parameters",true);
+            _mesh->write_param_to_vtu( out.write_parameters ) ;
 
             try
             {
@@ -955,13 +1056,91 @@ void core::config_output(pt::ptree &value)
             out.frequency = itr.second.get("frequency",1); //defaults to every timestep
             LOG_DEBUG << "Output every " << out.frequency <<" timesteps.";
 
-            out.mesh_output_formats.push_back(output_info::mesh_outputs::vtu);
+            // vtu: one file per output step
+            // netcdf: a single file with the geometry written once and each variable as a compressed [time, face] array
+            std::string format = itr.second.get<std::string>("format","vtu");
+            if (format == "vtu")
+            {
+                out.mesh_output_formats.push_back(output_info::mesh_outputs::vtu);
+            }
+            else if (format == "netcdf")
+            {
+                out.mesh_output_formats.push_back(output_info::mesh_outputs::netcdf);
+            }
+            else
+            {
+                BOOST_THROW_EXCEPTION(config_error() << errstr_info("Unknown mesh output format " + format + ". Use vtu or netcdf"));
+            }
+            out.compression = itr.second.get("compression",4);
+
+            // "aggregate": { "period": "day", "stat": "mean", "stats": { "swe": "max" } }
+            if (auto agg = itr.second.get_child_optional("aggregate"))
+            {
+                out.aggregate = true;
+                out.aggregate_period = mesh_aggregate::to_period(agg->get<std::string>("period", "day"));
+                out.aggregate_stat = mesh_aggregate::to_stat(agg->get<std::string>("stat", "mean"));
+
+                if (auto stats = agg->get_child_optional("stats"))
+                {
+                    for (auto &jtr : *stats)
+                    {
+                        if (!out.variables.empty() && out.variables.find(jtr.first) == out.variables.end())
+                        {
+                            BOOST_THROW_EXCEPTION(config_error() << errstr_info(
+                                    "Aggregation given for " + jtr.first + ", which is not an output variable"));
+                        }
+                        out.aggregate_stats[jtr.first] = mesh_aggregate::to_stat(jtr.second.data());
+                    }
+                }
+
+                if (itr.second.get_optional<size_t>("frequency"))
+                    LOG_WARNING << "Mesh output " << fname << " is aggregated, frequency is ignored";
+                LOG_DEBUG << "Output is aggregated over each " << agg->get<std::string>("period", "day");
+            }
 
         } else
         {
             LOG_WARNING << "Unknown output type: " << itr.second.data();
         }
 
+        outputs.push_back(out);
+    }
+
+    // locate_faces walks on from one output point's face to the next, rather than searching for each from scratch
+    std::vector<Point_2> output_points;
+    for (auto &out : outputs)
+    {
+        if (out.type == output_info::time_series)
+            output_points.push_back(Point_2(out.longitude, out.latitude));
+    }
+    auto output_faces = _mesh->locate_faces(output_points);
+
+    size_t next_point = 0;
+    for (auto &out : outputs)
+    {
+        if (out.type == output_info::time_series)
+        {
+            out.face = output_faces[next_point++];
+
+            if(out.face != nullptr)
+            {
+                // In MPI mode, we might not thave the output triangle on this node, so we just have to fail gracefully and hope that the other nodes have this.
+                // in the future we need a comms here to check if the nodes successfully figured out the output points
+                // for now, if we don't have it, print an error but keep going
+
+                //set the point to be the center of the triangle that the output point lies on
+                points->InsertNextPoint(out.face->get_x(), out.face->get_y(), out.face->get_z());
+                labels->InsertNextValue(out.name);
+
+                LOG_DEBUG << "Triangle geometry for output triangle = " << out.name << " slope: "
+                          << out.face->slope() * 180. / M_PI << " aspect:" << out.face->aspect() * 180. / M_PI;
+
+                out.face->_debug_name = out.name; //out.name holds the station name
+                out.face->_debug_ID = ID;
+                ++ID;
+            }
+        }
+
         //ensure we aren't adding timeseries outputs with invalid faces bc of MPI
         if(  out.type == output_info::time_series &&
              out.face == nullptr)
@@ -1513,13 +1692,24 @@ void core::init(int argc, char **argv)
         BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("no stations"));
 
 
-    auto start_time = _global->_stations.at(0)->date_timeseries().at(0);
-    auto end_time = _global->_stations.at(0)->date_timeseries().back();
+    boost::posix_time::ptime start_time, end_time;
+
+    // netcdf stations only hold the current timestep, so the dates come from the file
+    if(_use_netcdf)
+    {
+        start_time = nc.get_start();
+        end_time = nc.get_end();
+    }
+    else
+    {
+        start_time = _global->_stations.at(0)->date_timeseries().at(0);
+        end_time = _global->_stations.at(0)->date_timeseries().back();
+    }
 
     //if the user gives both a custom start and end time, don't bother with this.
     //this does assume the user knows what they are doing and subsets a time period that is correct
     //if they do not, the sanity check after this period that double checks consistent timestepping will catch it
-    if(!_start_ts && !_end_ts)
+    if(!_start_ts && !_end_ts && !_use_netcdf)
     {
         // find the latest start time and the earliest end time
         for (size_t i = 0; i < _global->_stations.size(); ++i)
@@ -1586,45 +1776,71 @@ void core::init(int argc, char **argv)
         BOOST_THROW_EXCEPTION(model_init_error() << errstr_info(ss.str()));
     }
 
-    if( _global->_stations.at(0)->date_timeseries().size() == 1)
+    if(_use_netcdf)
     {
-        BOOST_THROW_EXCEPTION(model_init_error() << errstr_info("Unable to determine model timestep from only 1 input timestep."));
-    }
-    //figure out what our timestepping is. Needs to happen before we subset as we may end up with only 1 timestep
-    auto t0 = _global->_stations.at(0)->date_timeseries().at(0);
-    auto t1 = _global->_stations.at(0)->date_timeseries().at(1);
-    auto dt = (t1 - t0);
-    _global->_dt = dt.total_seconds();
-    LOG_DEBUG << "model dt = " << _global->dt() << " (s)";
+        _global->_dt = nc.get_dt().total_seconds();
+        LOG_DEBUG << "model dt = " << _global->dt() << " (s)";
 
+        // subset to [start,end] by keeping track of where in the file we start
+        auto all_dates = nc.get_datevec();
+        _netcdf_dates.clear();
+        for(size_t i = 0; i < all_dates.size(); i++)
+        {
+            if(all_dates[i] < *_start_ts || all_dates[i] > *_end_ts)
+                continue;
 
-    LOG_DEBUG << "Subsetting station timeseries";
+            if(_netcdf_dates.empty())
+                _netcdf_first_ts = i;
+            _netcdf_dates.push_back(all_dates[i]);
+        }
 
-#pragma omp for
-    for(size_t i = 0; i < _global->_stations.size(); ++i)
-    {
-        _global->_stations.at(i)->raw_timeseries()->subset(*_start_ts, *_end_ts);
-        _global->_stations.at(i)->reset_itrs();
-        auto s= _global->_stations.at(i);
-//         LOG_VERBOSE << s->ID() << " Start = " << s->date_timeseries().front() << " End = " << s->date_timeseries().back();
+        if(_netcdf_dates.size() < 2)
+        {
+            BOOST_THROW_EXCEPTION(model_init_error() << errstr_info("Need at least 2 NetCDF timesteps between the start and end time."));
+        }
     }
+    else
+    {
+        if( _global->_stations.at(0)->date_timeseries().size() == 1)
+        {
+            BOOST_THROW_EXCEPTION(model_init_error() << errstr_info("Unable to determine model timestep from only 1 input timestep."));
+        }
+        //figure out what our timestepping is. Needs to happen before we subset as we may end up with only 1 timestep
+        auto t0 = _global->_stations.at(0)->date_timeseries().at(0);
+        auto t1 = _global->_stations.at(0)->date_timeseries().at(1);
+        auto dt = (t1 - t0);
+        _global->_dt = dt.total_seconds();
+        LOG_DEBUG << "model dt = " << _global->dt() << " (s)";
 
-    //ensure all the stations have the same start and end times
-    // per-timestep agreeent happens during runtime.
-    start_time = _global->_stations.at(0)->date_timeseries().at(0);
-    end_time = _global->_stations.at(0)->date_timeseries().back();
 
+        LOG_DEBUG << "Subsetting station timeseries";
 
-    for (size_t i = 1; //on purpose to skip first station
-         i < _global->_stations.size();
-         i++)
-    {
-        if (_global->_stations.at(i)->date_timeseries().at(0) != start_time ||
-            _global->_stations.at(i)->date_timeseries().back() != end_time)
+        #pragma omp for
+        for(size_t i = 0; i < _global->_stations.size(); ++i)
         {
-            BOOST_THROW_EXCEPTION(forcing_timestep_mismatch()
-                                  <<
-                                  errstr_info("Timestep mismatch at station: " + _global->_stations.at(i)->ID()));
+            _global->_stations.at(i)->raw_timeseries()->subset(*_start_ts, *_end_ts);
+            _global->_stations.at(i)->reset_itrs();
+            auto s= _global->_stations.at(i);
+    //         LOG_VERBOSE << s->ID() << " Start = " << s->date_timeseries().front() << " End = " << s->date_timeseries().back();
+        }
+
+        //ensure all the stations have the same start and end times
+        // per-timestep agreeent happens during runtime.
+        start_time = _global->_stations.at(0)->date_timeseries().at(0);
+        end_time = _global->_stations.at(0)->date_timeseries().back();
+
+
+        for (size_t i = 1; //on purpose to skip first station
+             i < _global->_stations.size();
+             i++)
+        {
+            if (_global->_stations.at(i)->date_timeseries().at(0) != start_time ||
+                _global->_stations.at(i)->date_timeseries().back() != end_time)
+            {
+                BOOST_THROW_EXCEPTION(forcing_timestep_mismatch()
+                                      <<
+                                      errstr_info("Timestep mismatch at station: " + _global->_stations.at(i)->ID()));
+            }
         }
     }
 
@@ -1634,29 +1850,34 @@ void core::init(int argc, char **argv)
 
 
 
-    //setup output timeseries sinks
-    auto date = _global->_stations.at(0)->date_timeseries();
-
+    //setup output timeseries sinks. These are written out in blocks as the model runs
+    std::vector<std::string> point_vars(_provided_var_module.begin(), _provided_var_module.end());
     for (auto &itr : _outputs)
     {
         if (itr.type == output_info::output_type::time_series)
         {
-            itr.ts.init(_provided_var_module, date); /*length of all the vectors to initialize*/
+            itr.point = boost::make_shared<point_output>(itr.fname, point_vars, _point_output_rows);
         }
     }
 
 
 
     LOG_DEBUG << "Allocating face variable storage";
-    #pragma omp parallel for
-    for (size_t it = 0; it < _mesh->size_faces(); it++)
-    {
-      auto face = _mesh->face(it);
-      if(point_mode.enable && face->_debug_name != _outputs[0].name )
-	continue;
+    _mesh->init_time_series(_provided_var_module);
 
-	       face->init_time_series(_provided_var_module);
+    for (auto& itr : _modules)
+    {
+        itr.first->resolve_handles(_mesh);
+    }
 
+    // Stations don't move, so do the spatial search for each face's interpolating stations once here
+    // instead of in every module, every timestep.
+    LOG_DEBUG << "Finding the stations for each face";
+    #pragma omp parallel for
+    for (size_t i = 0; i < _mesh->size_faces(); i++)
+    {
+        auto face = _mesh->face(i);
+        face->set_stations(_global->get_stations(face->get_x(), face->get_y()));
     }
 
 
@@ -2163,6 +2384,142 @@ void core::_schedule_modules()
         }
         chunks++;
     }
+
+    if (!_use_task_graph)
+        return;
+
+    // Module j must run after module i (i < j in the make order) if either one uses a variable the other provides.
+    // This is stricter than the dependency graph as it keeps the order of the edges removed by a user override,
+    // which otherwise would let the two modules race on that variable.
+    auto uses = [](const module& a, const module& b) -> bool
+    {
+        for (auto &v : *(a->provides()))
+        {
+            if (std::find(b->depends()->begin(), b->depends()->end(), v) != b->depends()->end() ||
+                std::find(b->optionals()->begin(), b->optionals()->end(), v) != b->optionals()->end())
+                return true;
+        }
+        return false;
+    };
+
+    std::vector<bool> data_parallel(_modules.size());
+    std::vector<bool> keep_order(_modules.size());
+    std::vector< std::vector<size_t> > deps(_modules.size());
+    for (size_t j = 0; j < _modules.size(); j++)
+    {
+        data_parallel[j] = _modules[j].first->parallel_type() == module_base::parallel::data;
+
+        // nothing declared doesn't mean nothing read, so don't let it move relative to anything else
+        keep_order[j] = _modules[j].first->depends()->empty() && _modules[j].first->optionals()->empty();
+        if (keep_order[j])
+            LOG_DEBUG << _modules[j].first->ID << " declares no inputs, keeping it in order in the task graph";
+
+        for (size_t i = 0; i < j; i++)
+        {
+            if (uses(_modules[i].first, _modules[j].first) || uses(_modules[j].first, _modules[i].first))
+                deps[j].push_back(i);
+        }
+    }
+
+    _module_graph.build(data_parallel, deps,
+                        [this](size_t n)
+                        {
+                            auto &modules = _graph_modules.at(n);
+                            if (_module_graph.nodes().at(n).data_parallel)
+                            {
+                                _run_face_sweep(modules);
+                            } else
+                            {
+                                for (auto &m : modules)
+                                {
+                                    m->run(_mesh);
+                                }
+                            }
+                        },
+                        keep_order);
+
+    _graph_modules.clear();
+    size_t n = 0;
+    for (auto &node : _module_graph.nodes())
+    {
+        std::vector<module> modules;
+        std::stringstream ss;
+        for (auto i : node.items)
+        {
+            modules.push_back(_modules[i].first);
+            ss << _modules[i].first->ID << " ";
+        }
+        _graph_modules.push_back(modules);
+
+        std::stringstream ds;
+        for (auto d : node.deps)
+            ds << d << " ";
+
+        LOG_DEBUG << "Task " << n << (node.data_parallel ? " data" : " domain") << ": " << ss.str()
+                  << "after: " << ds.str();
+        n++;
+    }
+}
+
+void core::_wait_for_checkpoint()
+{
+    if (_checkpoint_write.valid())
+    {
+        try
+        {
+            _checkpoint_write.get(); // rethrows anything the writer threw
+        }
+        catch(netCDF::exceptions::NcException& e)
+        {
+            BOOST_THROW_EXCEPTION(file_write_error() << errstr_info(std::string("Writing checkpoint failed: ") + e.what()));
+        }
+    }
+}
+
+void core::_run_face_sweep(const std::vector<module>& modules)
+{
+    if (_face_tile_size > 0)
+    {
+        // Each module runs over the whole tile before the next one, so the tile's face data stays in cache across
+        // modules and each module streams through a contiguous range of the variable store.
+        // This is the same result as the per face order below as data parallel modules only touch their own face.
+        size_t nfaces = _mesh->size_faces();
+        size_t ntiles = (nfaces + _face_tile_size - 1) / _face_tile_size;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t t = 0; t < ntiles; t++)
+        {
+            size_t begin = t * _face_tile_size;
+            size_t end = std::min(nfaces, begin + _face_tile_size);
+
+            for (auto &jtr : modules)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    auto face = _mesh->face(i);
+                    if (point_mode.enable && face->_debug_name != _outputs[0].name)
+                        continue;
+
+                    jtr->run(face);
+                }
+            }
+        }
+        return;
+    }
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < _mesh->size_faces(); i++)
+    {
+        auto face = _mesh->face(i);
+        if (point_mode.enable && face->_debug_name != _outputs[0].name)
+            continue;
+
+         //module calls
+         for (auto &jtr : modules)
+         {
+             jtr->run(face);
+         }
+    }
 }
 
 void core::run()
@@ -2185,35 +2542,82 @@ void core::run()
     double meantime = 0;
     size_t current_ts = 0;
     _global->timestep_counter = 0; //use this to pass the timestep info to the modules for easier debugging specific timesteps
-    size_t max_ts = _global->_stations.at(0)->date_timeseries().size();
+    size_t max_ts = _use_netcdf ? _netcdf_dates.size() : _global->_stations.at(0)->date_timeseries().size();
     bool done = false;
 
+    // the point outputs' variables, and the row of them copied out each timestep
+    std::vector<var_handle> point_handles;
+    for (auto &v : _provided_var_module)
+        point_handles.push_back(_mesh->variable_handle(v));
+    std::vector<double> point_row(point_handles.size());
+
+    // column of each forcing variable in each station's timeseries, [station * nvars + var]
+    std::vector<size_t> nc_columns;
+
+    if(_use_netcdf)
+    {
+        //sanity check that we are getting the right station for each xy pair
+        for (size_t i = 0; i < _global->_stations.size(); i++)
+        {
+            if (_global->_stations.at(i)->ID() != std::to_string(i))
+            {
+                BOOST_THROW_EXCEPTION(
+                        forcing_error() << errstr_info("Station=" + _global->_stations.at(i)->ID() + ": wrong ID"));
+            }
+        }
+
+        // don't use the stations variable map as it'll contain anything inserted by a filter which won't exist in the nc file
+        auto vars = nc.get_variable_names();
+
+        LOG_DEBUG << "Starting NetCDF read ahead of " << _netcdf_prefetch << " timesteps";
+        _forcing_prefetch.start(nc, std::vector<std::string>(vars.begin(), vars.end()),
+                                _netcdf_first_ts, max_ts, _netcdf_prefetch);
+
+        // resolve these once so the per-timestep copy doesn't look the variables up by name
+        auto& pvars = _forcing_prefetch.variables();
+        nc_columns.resize(_global->_stations.size() * pvars.size());
+        for (size_t i = 0; i < _global->_stations.size(); i++)
+        {
+            for (size_t v = 0; v < pvars.size(); v++)
+            {
+                nc_columns[i * pvars.size() + v] = _global->_stations[i]->raw_timeseries()->column_index(pvars[v]);
+            }
+        }
+    }
+
 
         while (!done)
         {
             //ensure all the stations are at the same timestep
             boost::posix_time::ptime t;
-            t = _global->_stations.at(0)->now().get_posix(); //get first stations time
-            for (size_t i = 1; //on purpose to skip first station
-                 i < _global->_stations.size();
-                 i++)
+            if (_use_netcdf)
+            {
+                t = _netcdf_dates.at(current_ts);
+            }
+            else
             {
-                if (t != _global->_stations.at(i)->now().get_posix())
+                t = _global->_stations.at(0)->now().get_posix(); //get first stations time
+                for (size_t i = 1; //on purpose to skip first station
+                     i < _global->_stations.size();
+                     i++)
                 {
-                    std::stringstream expected;
-                    expected << _global->_stations.at(0)->now().get_posix();
-                    std::stringstream found;
-                    found << _global->_stations.at(i)->now().get_posix();
-                    BOOST_THROW_EXCEPTION(forcing_timestep_mismatch()
-                                          <<
-                                          errstr_info("Timestep mismatch at station: " + _global->_stations.at(i)->ID()
-                                                      + "\nExpected: " + expected.str()
-                                                      + "\nFound: " + found.str()
-                                          ));
+                    if (t != _global->_stations.at(i)->now().get_posix())
+                    {
+                        std::stringstream expected;
+                        expected << _global->_stations.at(0)->now().get_posix();
+                        std::stringstream found;
+                        found << _global->_stations.at(i)->now().get_posix();
+                        BOOST_THROW_EXCEPTION(forcing_timestep_mismatch()
+                                              <<
+                                              errstr_info("Timestep mismatch at station: " + _global->_stations.at(i)->ID()
+                                                          + "\nExpected: " + expected.str()
+                                                          + "\nFound: " + found.str()
+                                              ));
+                    }
                 }
             }
 
-            _global->_current_date = _global->_stations.at(0)->now().get_posix();
+            _global->_current_date = t;
 
 
             if (!_enable_ui)
@@ -2224,35 +2628,29 @@ void core::run()
             if(_use_netcdf)
             {
 //                c.tic();
-                // don't use the stations variable map as it'll contain anything inserted by a filter which won't exist in the nc file
-                for (auto &itr: nc.get_variable_names() )
+                // the prefetch thread has most likely already read this timestep while the previous one was computed
+                size_t nc_ts = _netcdf_first_ts + current_ts;
+                try
                 {
-                    auto data = nc.get_var(itr, t);
+                    _forcing_prefetch.wait(nc_ts);
+                }
+                catch(netCDF::exceptions::NcException& e)
+                {
+                    BOOST_THROW_EXCEPTION(forcing_error() << errstr_info(e.what()));
+                }
+
+                size_t nvars = _forcing_prefetch.variables().size();
+                for (size_t v = 0; v < nvars; v++)
+                {
+                    const double* data = _forcing_prefetch.get(nc_ts, v);
 
                     #pragma omp parallel for
-                    for (size_t y = 0; y < nc.get_ysize(); y++)
+                    for (size_t i = 0; i < _global->_stations.size(); i++)
                     {
-
-			       for (size_t x = 0; x < nc.get_xsize(); x++)
-			       {
-				   size_t index = x + y * nc.get_xsize();
-				   auto s = _global->_stations.at(index);
-
-				   //sanity check that we are getting the right station for this xy pair
-				   if (s->ID() != std::to_string(index))
-				   {
-				       BOOST_THROW_EXCEPTION(
-							     forcing_error() << errstr_info("Station=" + s->ID() + ": wrong ID"));
-				   }
-
-				   double d = data[y][x];
-				   s->now().set(itr, d);
-
-			       }
-
-		    }
-
+                        _global->_stations[i]->now().set(nc_columns[i * nvars + v], data[i]);
+                    }
                 }
+                _forcing_prefetch.release(nc_ts);
 
 //                LOG_DEBUG << "Done loading forcing [" << c.toc<s>() << "s]";
 
@@ -2307,40 +2705,34 @@ void core::run()
             size_t chunks = 0;
             try
             {
-                for (auto &itr : _chunked_modules)
+                if (_use_task_graph)
                 {
-//                    LOG_VERBOSE << "Working on chunk[" << chunks << "]:parallel=" <<
-//                                (itr.at(0)->parallel_type() == module_base::parallel::data ? "data" : "domain");
-
-                    if (itr.at(0)->parallel_type() == module_base::parallel::data)
+                    _module_graph.run();
+                }
+                else
+                {
+                    for (auto &itr : _chunked_modules)
                     {
+//                        LOG_VERBOSE << "Working on chunk[" << chunks << "]:parallel=" <<
+//                                    (itr.at(0)->parallel_type() == module_base::parallel::data ? "data" : "domain");
 
-                        #pragma omp parallel for
-                        for (size_t i = 0; i < _mesh->size_faces(); i++)
+                        if (itr.at(0)->parallel_type() == module_base::parallel::data)
                         {
-                            auto face = _mesh->face(i);
-                            if (point_mode.enable && face->_debug_name != _outputs[0].name)
-                                continue;
-
-                             //module calls
-                             for (auto &jtr : itr)
-                             {
-                                 jtr->run(face);
-                             }
-                        }
-
-
-                    } else
-                    {
-                        //module calls for domain parallel
-                        for (auto &jtr : itr)
+                            _run_face_sweep(itr);
+                        } else
                         {
-                          jtr->run(_mesh);
+                            //module calls for domain parallel
+                            for (auto &jtr : itr)
+                            {
+                              // neighbours across a process boundary need to be current before a domain module reads them
+                              _mesh->exchange_halo(jtr->halo_handles());
+                              jtr->run(_mesh);
+                            }
                         }
-                    }
 
-                    chunks++;
+                        chunks++;
 
+                    }
                 }
             }
             catch (exception_base &e)
@@ -2354,24 +2746,18 @@ void core::run()
 
             }
 
-            //check that we actually need a mesh output.
-            for (auto &itr : _outputs)
-            {
-                if(itr.type == output_info::output_type::mesh)
-                {
-                    std::vector<std::string> output;
-                    output.assign(itr.variables.begin(),itr.variables.end()); //convert to list to match internal lists
-
-                    _mesh->update_vtk_data(output); //update the internal vtk mesh
-                    break; // we're done as soon as we've called update once. No need to do it multiple times.
-                }
-            }
-
             // save the current state
             if(_do_checkpoint && (current_ts % _checkpoint_feq ==0) )
             {
                 LOG_DEBUG << "Checkpointing...";
                 c.tic();
+
+                // the previous checkpoint may still be being written
+                _wait_for_checkpoint();
+
+                // the modules only copy their state into memory here, it is written out on a background thread while
+                // the next timesteps run
+                _savestate.begin_staging();
                 for (auto &itr : _chunked_modules)
                 {
                     //module calls
@@ -2387,70 +2773,141 @@ void core::run()
                 //also write it out in seconds because netcdf is struggling with the string
                 unsigned long long int ts_sec = _global->posix_time_int()+_global->_dt;
 
-                _savestate.get_ncfile().putAtt("restart_time",timestr.str());
-                _savestate.get_ncfile().putAtt("restart_time_sec", netCDF::ncUint64,ts_sec);
+                std::string restart_time = timestr.str();
+                _checkpoint_write = std::async(std::launch::async, [this, restart_time, ts_sec]()
+                {
+                    _savestate.write_staged();
+
+                    // the forcing prefetch thread may be reading the netcdf forcing file
+                    std::lock_guard<std::mutex> nc_lock(netcdf::lib_mutex());
+                    _savestate.get_ncfile().putAtt("restart_time",restart_time);
+                    _savestate.get_ncfile().putAtt("restart_time_sec", netCDF::ncUint64,ts_sec);
+                    _savestate.get_ncfile().sync();
+                });
 
-                LOG_DEBUG << "Done checkpoint [ " << c.toc<s>() << "s]";
+                LOG_DEBUG << "Done checkpoint staging [ " << c.toc<s>() << "s]";
             }
 
+            // The mesh outputs are snapshotted here and written by the output writer thread while the next timesteps
+            // run. This only blocks if the writer has fallen behind by more than output_queue snapshots.
             for (auto &itr : _outputs)
             {
-                if (itr.type == output_info::output_type::mesh)
+                if (itr.type != output_info::output_type::mesh)
+                    continue;
+
+                uint64_t time = _global->posix_time_int();
+
+                // aggregated outputs are only written once the window is complete, or at the end of the run, and then
+                // hold the reduced values and the start of the window
+                boost::shared_ptr< std::vector<float> > reduced;
+                if (itr.aggregate)
                 {
-                    if(current_ts % itr.frequency == 0)
+                    if (!itr.aggregator)
                     {
+                        std::vector<std::string> output(itr.variables.begin(), itr.variables.end());
+                        if (output.empty())
+                            output = _mesh->face(0)->variables();
 
-                        #pragma omp parallel
+                        std::vector<mesh_aggregate::stat> stats;
+                        for (auto &v : output)
                         {
-                            #pragma omp single
-                            {
-                                for (auto jtr : itr.mesh_output_formats)
-                                {
-                                    #pragma omp task
-                                    {
-                                        std::string base_name = itr.fname + std::to_string(_global->posix_time_int());
-                                        boost::filesystem::path p(base_name);
+                            auto s = itr.aggregate_stats.find(v);
+                            stats.push_back(s == itr.aggregate_stats.end() ? itr.aggregate_stat : s->second);
+                        }
+                        itr.aggregator = boost::make_shared<mesh_aggregate>(_mesh, itr.aggregate_period, output, stats);
+                    }
+
+                    itr.aggregator->add(_mesh, _global->posix_time());
+
+                    auto next = _global->posix_time() + boost::posix_time::seconds(_global->dt());
+                    if (current_ts + 1 != max_ts && !itr.aggregator->closed_by(next))
+                        continue;
+
+                    time = (itr.aggregator->start() - boost::posix_time::from_time_t(0)).total_seconds();
+                    reduced = boost::make_shared< std::vector<float> >(itr.aggregator->result());
+                }
+                else if (current_ts % itr.frequency != 0)
+                {
+                    continue;
+                }
 
-                                        if (jtr == output_info::mesh_outputs::vtu  )
-                                        {
+                for (auto jtr : itr.mesh_output_formats)
+                {
+                    std::string base_name = itr.fname + std::to_string(time);
+                    boost::filesystem::path p(base_name);
+
+                    if (jtr == output_info::mesh_outputs::vtu  )
+                    {
 
-                                            // this really only works if we let rank0 handle the io.
-                                            // If we let each process do it, they walk all over each other's output
+                        // this really only works if we let rank0 handle the io.
+                        // If we let each process do it, they walk all over each other's output
 #ifdef USE_MPI
-                                            if(_comm_world.rank() == 0)
-                                            {
-                                                for(int rank = 0; rank < _comm_world.size(); rank++)
-                                                {
+                        if(_comm_world.rank() == 0)
+                        {
+                            for(int rank = 0; rank < _comm_world.size(); rank++)
+                            {
 #else
-                                                    int rank = 0;
+                                int rank = 0;
 #endif
-                                                    pt::ptree &dataset = pvd.add("VTKFile.Collection.DataSet", "");
-                                                    dataset.add("<xmlattr>.timestep", _global->posix_time_int());
-                                                    dataset.add("<xmlattr>.group", "");
-                                                    dataset.add("<xmlattr>.part", rank);
-                                                    dataset.add("<xmlattr>.file", p.filename().string()+"_"+std::to_string(rank) + ".vtu");
+                                pt::ptree &dataset = pvd.add("VTKFile.Collection.DataSet", "");
+                                dataset.add("<xmlattr>.timestep", time);
+                                dataset.add("<xmlattr>.group", "");
+                                dataset.add("<xmlattr>.part", rank);
+                                dataset.add("<xmlattr>.file", p.filename().string()+"_"+std::to_string(rank) + ".vtu");
 #ifdef USE_MPI
-                                                }
-                                            }
+                            }
+                        }
 #endif
 
-                                            //because a full path can be provided for the base_name, we need to strip this off
-                                            //to make it a relative path in the xml file.
+                        //because a full path can be provided for the base_name, we need to strip this off
+                        //to make it a relative path in the xml file.
 
 #ifdef USE_MPI
-                                            _mesh->write_vtu(base_name + "_"+std::to_string(_comm_world.rank() )+ ".vtu");
+                        std::string file = base_name + "_"+std::to_string(_comm_world.rank() )+ ".vtu";
 #else
-                                            _mesh->write_vtu(base_name + ".vtu");
+                        std::string file = base_name + ".vtu";
 #endif
+                        std::vector<std::string> output(itr.variables.begin(), itr.variables.end());
+                        _mesh->update_vtk_data(output); //update the internal vtk mesh
+
+                        auto snapshot = reduced ? _mesh->vtu_snapshot(itr.aggregator->variables(), *reduced)
+                                                : _mesh->vtu_snapshot();
+                        _output_writer.submit([snapshot, file]()
+                                              {
+                                                  triangulation::write_vtu(snapshot, file);
+                                              });
+                    }
 
-                                        }
-
-
-
-                                    }
-                                }
+                    if (jtr == output_info::mesh_outputs::netcdf)
+                    {
+                        if (!itr.nc_mesh)
+                        {
+                            // safe while the writer thread is busy, mesh_nc_output takes netcdf::lib_mutex()
+                            std::vector<std::string> output(itr.variables.begin(), itr.variables.end());
+                            std::vector<std::string> cell_methods;
+                            if (itr.aggregator)
+                            {
+                                output = itr.aggregator->variables();
+                                for (auto s : itr.aggregator->stats())
+                                    cell_methods.push_back("time: " + mesh_aggregate::to_string(s));
                             }
+#ifdef USE_MPI
+                            std::string file = itr.fname + "_" + std::to_string(_comm_world.rank()) + ".nc";
+#else
+                            std::string file = itr.fname + ".nc";
+#endif
+                            itr.nc_mesh = boost::make_shared<mesh_nc_output>(file, _mesh, output,
+                                                                             itr.write_parameters, itr.compression,
+                                                                             cell_methods);
                         }
+
+                        auto nc_mesh = itr.nc_mesh;
+                        auto snapshot = reduced ? reduced
+                                                : boost::make_shared< std::vector<float> >(nc_mesh->snapshot(_mesh));
+                        _output_writer.submit([nc_mesh, snapshot, time]()
+                                              {
+                                                  nc_mesh->write(*snapshot, time);
+                                              });
                     }
                 }
             }
@@ -2459,24 +2916,42 @@ void core::run()
             //Each output knows what face it corresponds to
             for (auto &itr : _outputs)
             {
-                //only update the full timeseries
                 if (itr.type == output_info::output_type::time_series)
                 {
-                    for (auto v : _provided_var_module)
+                    for (size_t v = 0; v < point_handles.size(); v++)
                     {
-                        auto data = (*itr.face)[v];
-                        itr.ts.at(v, current_ts) = data;
+                        point_row[v] = (*itr.face)[point_handles[v]];
+                    }
+                    itr.point->append(_global->posix_time(), point_row.data());
+
+                    if (itr.point->full())
+                    {
+                        auto point = itr.point;
+                        auto block = point->take();
+                        _output_writer.submit([point, block]()
+                                              {
+                                                  point->write(*block);
+                                              });
                     }
                 }
             }
 
             //update all the stations internal iterators to point to the next time step
-            for (auto &itr : _global->_stations)
+            if (_use_netcdf)
             {
-                if (!itr->next()) //this met station has no more met data, so doesn't matter what, we need to end now.
-                {
+                // netcdf stations only hold the current timestep, so there is nothing to advance
+                if (current_ts + 1 == max_ts)
                     done = true;
-                    break;
+            }
+            else
+            {
+                for (auto &itr : _global->_stations)
+                {
+                    if (!itr->next()) //this met station has no more met data, so doesn't matter what, we need to end now.
+                    {
+                        done = true;
+                        break;
+                    }
                 }
             }
 
@@ -2516,6 +2991,25 @@ void core::run()
 
 
         }
+        // the rest of the point outputs
+        for (auto &itr : _outputs)
+        {
+            if (itr.type == output_info::output_type::time_series && itr.point->pending() > 0)
+            {
+                auto point = itr.point;
+                auto block = point->take();
+                _output_writer.submit([point, block]()
+                                      {
+                                          point->write(*block);
+                                      });
+            }
+        }
+
+        // make sure the last checkpoint and outputs are on disk
+        _wait_for_checkpoint();
+        _output_writer.wait();
+        LOG_DEBUG << "The output writer fell behind " << _output_writer.stalls() << " times";
+
         double elapsed = c.toc<s>();
         LOG_DEBUG << "Total runtime was " << elapsed << "s";
 
@@ -2526,7 +3020,17 @@ void core::run()
 
     for (auto &itr : _outputs)
     {
-        if (itr.type == output_info::output_type::mesh)
+        // the writer has finished above, but the forcing prefetch may still be in netcdf, so close under its lock
+        if (itr.nc_mesh)
+            itr.nc_mesh->close();
+        itr.nc_mesh.reset();
+    }
+
+    for (auto &itr : _outputs)
+    {
+        if (itr.type == output_info::output_type::mesh &&
+            std::find(itr.mesh_output_formats.begin(), itr.mesh_output_formats.end(),
+                      output_info::mesh_outputs::vtu) != itr.mesh_output_formats.end())
         {
 
 #ifdef USE_MPI
@@ -2549,12 +3053,8 @@ void core::run()
 
     for (auto &itr : _outputs)
     {
-        //save the full timeseries
-        if (itr.type == output_info::output_type::time_series)
-        {
-            itr.ts.subset(*_start_ts,*_end_ts); // in the event of an exception, _end_ts will be reset to have the esception timestep so-as to no write massive amounts of nan values
-            itr.ts.to_file(itr.fname);
-        }
+        // closes the point output files
+        itr.point.reset();
     }
 
 
@@ -48,6 +48,8 @@
 #include <cstdlib>
 #include <chrono>
 #include <algorithm>
+#include <exception>
+#include <future>
 
 //boost includes
 #include <boost/graph/graph_traits.hpp>
@@ -79,6 +81,10 @@ namespace po = boost::program_options;
 #include "logger.hpp"
 #include "exception.hpp"
 #include "triangulation.hpp"
+#include "mesh_binary.hpp"
+#include "mesh_nc_output.hpp"
+#include "mesh_aggregate.hpp"
+#include "timeseries/point_output.hpp"
 #include "filter_base.hpp"
 #include "module_base.hpp"
 #include "station.hpp"
@@ -91,6 +97,9 @@ namespace po = boost::program_options;
 #include "version.h"
 #include "math/coordinates.hpp"
 #include "timeseries/netcdf.hpp"
+#include "timeseries/forcing_prefetch.hpp"
+#include "module_graph.hpp"
+#include "output_writer.hpp"
 #include "gsl/gsl_errno.h"
 
 #ifdef USE_MPI
@@ -190,6 +199,11 @@ public:
      * Determines the order modules need to be scheduleled in to maximize parallelism
      */
     void _schedule_modules();
+
+    /**
+     * Runs the data parallel modules, in order, on every face
+     */
+    void _run_face_sweep(const std::vector<module>& modules);
     void _find_and_insert_subjson(pt::ptree& value);
 
     // .first = config file to use
@@ -241,6 +255,12 @@ protected:
     //if we use netcdf, store it here
     netcdf nc;
 
+    // reads the netcdf forcing ahead of the model. Declared after nc so it is stopped before nc is closed
+    forcing_prefetch _forcing_prefetch;
+    size_t _netcdf_prefetch; // number of timesteps the prefetch holds
+    netcdf::date_vec _netcdf_dates; // the timesteps we run, subset from the netcdf file
+    size_t _netcdf_first_ts; // index of _netcdf_dates[0] in the netcdf file
+
 
 #ifdef MATLAB
     //matlab engine
@@ -251,6 +271,20 @@ protected:
     //pair as we also need to store the make order
     std::vector< std::pair<module,size_t> > _modules;
     std::vector< std::vector < module> > _chunked_modules;
+
+    // option.scheduler = "graph": run the modules as a task graph instead of the chunks in order
+    bool _use_task_graph;
+    module_graph _module_graph;
+    std::vector< std::vector < module> > _graph_modules; // the modules of each _module_graph node
+
+    // option.tile_size: if > 0, face sweeps run each module over a tile of this many faces before the next module
+    size_t _face_tile_size;
+
+    // option.output_queue: how many mesh output snapshots may wait for this writer thread before core::run blocks
+    output_writer _output_writer;
+
+    // option.point_output_rows: rows of each point output held in memory before they are written out
+    size_t _point_output_rows;
     std::vector< std::pair<std::string,std::string> > _overrides;
     boost::shared_ptr<global> _global;
 
@@ -300,6 +334,11 @@ protected:
             longitude = 0;
             face = nullptr;
             name = "";
+            write_parameters = true;
+            compression = 4;
+            aggregate = false;
+            aggregate_period = mesh_aggregate::period::day;
+            aggregate_stat = mesh_aggregate::stat::mean;
         }
         enum output_type
         {
@@ -310,7 +349,8 @@ protected:
         {
             vtp,
             vtu,
-            ascii
+            ascii,
+            netcdf
         };
 
         output_type type;
@@ -321,9 +361,20 @@ protected:
         double longitude;
         std::set<std::string> variables;
         mesh_elem face;
-        timeseries ts;
+        boost::shared_ptr<point_output> point; // streams the time series to fname
         size_t frequency;
 
+        bool write_parameters;
+        int compression; // deflate level of the netcdf mesh output
+        boost::shared_ptr<mesh_nc_output> nc_mesh; // created on the first netcdf mesh write
+
+        // if aggregate, every timestep is reduced over calendar windows and only those are written, instead of frequency
+        bool aggregate;
+        mesh_aggregate::period aggregate_period;
+        mesh_aggregate::stat aggregate_stat; // for the variables not in aggregate_stats
+        std::map<std::string, mesh_aggregate::stat> aggregate_stats;
+        boost::shared_ptr<mesh_aggregate> aggregator; // created on the first timestep
+
     };
 
     bool _enable_ui;
@@ -333,6 +384,8 @@ protected:
     netcdf _savestate; //file to save to when checkpointing.
     netcdf _in_savestate; // if we are loading from checkpoint
     bool _do_checkpoint; // should we check point?
+    std::future<void> _checkpoint_write; // the checkpoint being written in the background, if any
+    void _wait_for_checkpoint();
     bool _load_from_checkpoint; // are we loading from a checkpoint?
     std::string _checkpoint_file;//file to load from
     size_t _checkpoint_feq; // frequency of checkpoints
@@ -27,117 +27,220 @@
 double thin_plate_spline::operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point)
 {
     //see if we can reuse our
-    if(sample_points.size() +1 != size)
+    resize(sample_points.size());
+
+    // The LU decomp only depends on the sample locations, which only change when the set of stations with valid (non-nan)
+    // values changes. So unless the caller has promised the locations never change (reuse_LU), check if they are the same
+    // as last time and only refactor if they are not.
+    if(!uninit_lu_decomp && !reuse_LU)
     {
-        size = sample_points.size();
-        size++; // need to make room for the constants
-        A = MatrixXXd::Zero(size,size);
-        b = VectorXd::Zero(size);
-        x = VectorXd::Zero(size);
+        for (size_t i = 0; i < size - 1; i++)
+        {
+            if(sample_xy[2*i] != sample_points[i].get<0>() || sample_xy[2*i+1] != sample_points[i].get<1>())
+            {
+                uninit_lu_decomp = true;
+                break;
+            }
+        }
     }
 
     if(uninit_lu_decomp)
     {
-        //build the LU decomp
-        for (unsigned int i = 0; i < size - 1; i++)
+        for (size_t i = 0; i < size - 1; i++)
         {
-            double sxi = sample_points.at(i).get<0>(); //x
-            double syi = sample_points.at(i).get<1>(); //y
+            sample_xy[2*i] = sample_points[i].get<0>();
+            sample_xy[2*i+1] = sample_points[i].get<1>();
+        }
+        factor();
+    }
 
-            for (unsigned int j = i; j < size - 1; j++)
-            {
-                double sxj = sample_points.at(j).get<0>(); //x
-                double syj = sample_points.at(j).get<1>(); //y
+    double ex = query_point.get<0>();
+    double ey =  query_point.get<1>();
 
-                double xdiff = (sxi - sxj);
-                double ydiff = (syi - syj);
+    // The query point basis functions also only depend on the locations, and as each face has its own interpolant
+    // the query point is nearly always the same
+    if(uninit_query_Rd || ex != query_x || ey != query_y)
+    {
+        query_Rd.resize(size - 1);
+        for (unsigned int i = 0; i < size - 1; i++)
+        {
+            double sx = sample_xy[2*i]; //x
+            double sy = sample_xy[2*i+1]; //y
+
+            double xdiff = (sx  - ex);
+            double ydiff = (sy  - ey);
+            double dij = sqrt(xdiff*xdiff + ydiff*ydiff);
+            dij = (dij * weight/2.0) * (dij * weight/2.0);
+            query_Rd(i) = -(log(dij) + c + gsl_sf_expint_E1(dij));
+        }
+        query_x = ex;
+        query_y = ey;
+        uninit_query_Rd = false;
+    }
 
-                //don't add in a duplicate point, otherwise we get nan
-                if (xdiff == 0. && ydiff == 0.)
-                    continue;
+    for(size_t i=0;i<size-1;i++)
+    {
+        b(i) = sample_points[i].get<2>() ;
+    }
 
-                double Rd = 0.;
-                if (j == i) // diagonal
-                {
-                    Rd = 0.0;
-                } else
-                {
-                    double dij = sqrt(xdiff * xdiff + ydiff * ydiff); //distance between this set of observation points
+    b(size-1) = 0.0; //constant
 
-                    //none of the books and papers, despite citing Helena Mitášová, Lubos Mitáš seem to agree on the exact formula
-                    //so I am following http://link.springer.com/article/10.1007/BF00893171#page-1
-                    // eqn 10
+    //solve equation
+    x =  lu.solve(b) ; //ldlt.solve(b);
 
-                    dij = (dij * weight / 2.0) * (dij * weight / 2.0);
+    double z0 = x(0);//little a
 
-                    //Chang 4th edition 2008 uses bessel_k0
-                    //gsl_sf_bessel_K0
-                    // and has a -0.5 weight out fron
-//                     Rd = -0.5/(pi*weight*weight)*( log(dij*weight/2.0) + c + gsl_sf_bessel_K0(dij*weight));
+    //skip x[0] we already pulled off above
+    for (unsigned int i = 1; i < x.size() ;i++)
+    {
+        z0 = z0 + x(i)*query_Rd(i-1);
+    }
 
-                    //And Hengl and Evans in geomorphometry p.52 do not, but have some undefined omega_0/omega_1 weights
-                    //it is all rather confusing. But this follows Mitášová exactly, and produces essentially the same answer
-                    //as the worked example in box 16.2 in Chang
-                    Rd = -(log(dij) + c + gsl_sf_expint_E1(dij));
+    return z0;
+}
 
-                }
+void thin_plate_spline::batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+                              size_t nquery, const double* qx, const double* qy, double* out)
+{
+    if (nsample == 0)
+    {
+        BOOST_THROW_EXCEPTION(interpolation_error() << errstr_info("Spline requires >=1 stations"));
+    }
 
-                A(i, j + 1) = Rd;
-                A(j, i + 1) = Rd;
+    resize(nsample);
 
+    if(!uninit_lu_decomp && !reuse_LU)
+    {
+        for (size_t i = 0; i < nsample; i++)
+        {
+            if(sample_xy[2*i] != sx[i] || sample_xy[2*i+1] != sy[i])
+            {
+                uninit_lu_decomp = true;
+                break;
             }
         }
+    }
 
-
-        //set constants and build b values
-        for (unsigned int i = 0; i < size; i++)
+    if(uninit_lu_decomp)
+    {
+        for (size_t i = 0; i < nsample; i++)
         {
-            A(i, 0) = 1;
-            A(size - 1, i) = 1;
+            sample_xy[2*i] = sx[i];
+            sample_xy[2*i+1] = sy[i];
         }
-        A(size - 1, 0) = 0;
-        lu.compute(A);
+        factor();
     }
 
+    // the weights are shared by all the query points, so there is only one solve per block
+    for(size_t i = 0; i < nsample; i++)
+    {
+        b(i) = sz[i];
+    }
+    b(size-1) = 0.0; //constant
 
-    //this will skip the above computation of the lu decomp next time this is called
-    if(reuse_LU)
-        uninit_lu_decomp = false;
+    x = lu.solve(b);
 
-    for(size_t i=0;i<size-1;i++)
+    const double* xs = x.data();
+    const double* sxy = sample_xy.data();
+    const double k = weight * weight / 4.0; // (d*weight/2)^2 == d^2 * k
+
+#pragma omp simd
+    for (size_t q = 0; q < nquery; q++)
     {
-        b(i) = sample_points.at(i).get<2>() ;
+        double z0 = xs[0];
+        for (size_t i = 0; i < nsample; i++)
+        {
+            double xdiff = sxy[2*i] - qx[q];
+            double ydiff = sxy[2*i+1] - qy[q];
+            double d2 = xdiff * xdiff + ydiff * ydiff;
+
+            // same as the matrix diagonal, so the spline passes through a coincident sample point
+            double Rd = d2 > 0 ? -(c + fast_e1_log(k * d2)) : 0.0;
+
+            z0 += xs[i+1] * Rd;
+        }
+        out[q] = z0;
     }
+}
 
-    b(size-1) = 0.0; //constant
+void thin_plate_spline::resize(size_t nsample)
+{
+    if(nsample + 1 != size || sample_xy.size() != 2 * nsample)
+    {
+        size = nsample;
+        size++; // need to make room for the constants
+        b = VectorXd::Zero(size);
+        x = VectorXd::Zero(size);
+        sample_xy.resize(2 * nsample);
+        uninit_lu_decomp = true;
+    }
+}
 
-    //solve equation
-    int s				= 0;
+void thin_plate_spline::factor()
+{
+    MatrixXXd A = MatrixXXd::Zero(size,size);
 
-    x =  lu.solve(b) ; //ldlt.solve(b);
+    //build the LU decomp
+    for (unsigned int i = 0; i < size - 1; i++)
+    {
+        double sxi = sample_xy[2*i]; //x
+        double syi = sample_xy[2*i+1]; //y
 
+        for (unsigned int j = i; j < size - 1; j++)
+        {
+            double sxj = sample_xy[2*j]; //x
+            double syj = sample_xy[2*j+1]; //y
 
-    double z0 = x(0);//little a
+            double xdiff = (sxi - sxj);
+            double ydiff = (syi - syj);
 
-    //skip x[0] we already pulled off above
-    double ex = query_point.get<0>();
-    double ey =  query_point.get<1>();
+            //don't add in a duplicate point, otherwise we get nan
+            if (xdiff == 0. && ydiff == 0.)
+                continue;
 
-    for (unsigned int i = 1; i < x.size() ;i++)
-    {
-        double sx = sample_points.at(i-1).get<0>(); //x
-        double sy = sample_points.at(i-1).get<1>(); //y
+            double Rd = 0.;
+            if (j == i) // diagonal
+            {
+                Rd = 0.0;
+            } else
+            {
+                double dij = sqrt(xdiff * xdiff + ydiff * ydiff); //distance between this set of observation points
+
+                //none of the books and papers, despite citing Helena Mitášová, Lubos Mitáš seem to agree on the exact formula
+                //so I am following http://link.springer.com/article/10.1007/BF00893171#page-1
+                // eqn 10
+
+                dij = (dij * weight / 2.0) * (dij * weight / 2.0);
 
-        double xdiff = (sx  - ex);
-        double ydiff = (sy  - ey);
-        double dij = sqrt(xdiff*xdiff + ydiff*ydiff);
-        dij = (dij * weight/2.0) * (dij * weight/2.0);
-        double Rd = -(log(dij) + c + gsl_sf_expint_E1(dij));
+                //Chang 4th edition 2008 uses bessel_k0
+                //gsl_sf_bessel_K0
+                // and has a -0.5 weight out fron
 
-        z0 = z0 + x(i)*Rd;
+                //And Hengl and Evans in geomorphometry p.52 do not, but have some undefined omega_0/omega_1 weights
+                //it is all rather confusing. But this follows Mitášová exactly, and produces essentially the same answer
+                //as the worked example in box 16.2 in Chang
+                Rd = -(log(dij) + c + gsl_sf_expint_E1(dij));
+
+            }
+
+            A(i, j + 1) = Rd;
+            A(j, i + 1) = Rd;
+
+        }
     }
 
-    return z0;
+
+    //set constants and build b values
+    for (unsigned int i = 0; i < size; i++)
+    {
+        A(i, 0) = 1;
+        A(size - 1, i) = 1;
+    }
+    A(size - 1, 0) = 0;
+    lu.compute(A);
+
+    uninit_lu_decomp = false;
+    uninit_query_Rd = true;
 }
 
 thin_plate_spline::thin_plate_spline(size_t sz, std::map<std::string,std::string> config )
@@ -147,9 +250,9 @@ thin_plate_spline::thin_plate_spline(size_t sz, std::map<std::string,std::string
     size = sz;
     size++; // need to make room for the constants
 
-    A = MatrixXXd::Zero(size,size);
     b = VectorXd::Zero(size);
     x = VectorXd::Zero(size);
+    sample_xy.resize(2 * sz);
 
     auto itr = config.find("reuse_LU");
     if(itr != config.end())
@@ -168,6 +271,9 @@ thin_plate_spline::thin_plate_spline()
 
     reuse_LU    = false;
     uninit_lu_decomp = true;
+    uninit_query_Rd = true;
+    query_x     = 0;
+    query_y     = 0;
 
 
 }
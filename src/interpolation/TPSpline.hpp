@@ -47,7 +47,7 @@ public:
     ~thin_plate_spline();
 
     /**
-     * Allocating A,b,x, and p every time this is called adds up.
+     * Allocating b and x every time this is called adds up.
      * So the sz can be pre-set to pre allocate all the arrays.
      */
     thin_plate_spline(size_t sz,std::map<std::string,std::string> config = std::map<std::string,std::string>());
@@ -60,12 +60,58 @@ public:
     */
     double operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point);
 
+    /**
+    * Spline of the sample points at a block of query points. See interp_base::batch.
+    * The LU decomposition and solve are done once for the whole block, and the basis functions use
+    * fast_e1_log instead of gsl so the loop over the query points vectorizes.
+    */
+    void batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+               size_t nquery, const double* qx, const double* qy, double* out);
+
+    /**
+     * Approximation of E1(x) + ln(x), the x dependent part of the spline basis function, for x >= 0.
+     * For x <= 1 this is the series for Ein(x) - gamma (Abramowitz and Stegun 5.1.11), truncated where the terms drop below
+     * double precision. This avoids the cancellation between E1 and ln, which matters as the basis values are small.
+     * For x > 1 it uses Abramowitz and Stegun 5.1.54 (|error| in x e^x E1(x) < 2e-8).
+     * Unlike the gsl version it is inlineable and has no error handling, so it can be used in simd loops.
+     * It is finite at x = 0, so coincident points don't produce a nan.
+     */
+    static inline double fast_e1_log(double x)
+    {
+        const double gamma = 0.57721566490153286;
+
+        if (x <= 1.0)
+        {
+            // (-1)^(k+1) / (k k!), k = 1..18
+            static const double a[] = {1, -0.25, 0.055555555555555552, -0.010416666666666666, 0.0016666666666666668,
+                                       -0.00023148148148148149, 2.834467120181406e-05, -3.1001984126984127e-06,
+                                       3.0619243582206544e-07, -2.7557319223985891e-08, 2.27746439867652e-09,
+                                       -1.7397297489890083e-10, 1.2353110643708935e-11, -8.1933897126640886e-13,
+                                       5.0981091545465446e-14, -2.9871733327421158e-15, 1.6537983849091297e-16,
+                                       -8.6773372047701253e-18};
+            double ein = 0;
+            for (int k = 17; k >= 0; k--)
+            {
+                ein = (ein + a[k]) * x;
+            }
+            return ein - gamma;
+        }
+
+        // x e^x E1(x) = (x^4 + a1 x^3 + a2 x^2 + a3 x + a4) / (x^4 + b1 x^3 + b2 x^2 + b3 x + b4)
+        double num = (((x + 8.5733287401) * x + 18.0590169730) * x + 8.6347608925) * x + 0.2677737343;
+        double den = (((x + 9.5733223454) * x + 25.6329561486) * x + 21.0996530827) * x + 3.9584969228;
+        return std::exp(-x) / x * num / den + std::log(x);
+    }
+
+    /**
+     * The LU decomposition is reused as long as the sample point locations don't change, which is checked on each call.
+     * If true, the caller guarantees the locations never change (e.g., a face's fixed neighbours) and the check is skipped.
+     */
     bool reuse_LU;
 private:
     typedef Eigen::Matrix<double,Eigen::Dynamic,1> VectorXd;
     typedef Eigen::Matrix<double,Eigen::Dynamic, Eigen::Dynamic> MatrixXXd;
 
-    MatrixXXd A ;
     VectorXd b; // known values - constant value of 0 goes in b[size-1]
     VectorXd x;
 
@@ -73,7 +119,22 @@ private:
     double pi;
     double c; //euler constant
     double weight;
+    // resizes the arrays for nsample points, flagging the LU decomp for recomputation if the size changed
+    void resize(size_t nsample);
+
+    // builds and factors the spline matrix for the locations in sample_xy
+    void factor();
+
     bool uninit_lu_decomp;
     size_t size;
 
+    // sample point locations the LU decomp was built for, as x0,y0,x1,y1,...
+    std::vector<double> sample_xy;
+
+    // basis function values between the query point and each sample point
+    VectorXd query_Rd;
+    double query_x;
+    double query_y;
+    bool uninit_query_Rd;
+
 };
@@ -47,6 +47,35 @@ public:
         return -9999.0;
     };
 
+    /**
+    * Interpolates one set of sample points to a block of query points, e.g., a chunk of faces that share the same stations.
+    * Points are given as structure of arrays so that the methods can use vectorizable kernels.
+    * The default implementation calls operator() for each query point.
+    * \param nsample Number of sample points
+    * \param sx Sample point x values
+    * \param sy Sample point y values
+    * \param sz Sample point values to interpolate
+    * \param nquery Number of query points
+    * \param qx Query point x values
+    * \param qy Query point y values
+    * \param out Interpolated value at each query point. Must hold nquery values
+    */
+    virtual void batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+                       size_t nquery, const double* qx, const double* qy, double* out)
+    {
+        std::vector< boost::tuple<double,double,double> > sample_points(nsample);
+        for (size_t i = 0; i < nsample; i++)
+        {
+            sample_points[i] = boost::make_tuple(sx[i], sy[i], sz[i]);
+        }
+
+        for (size_t q = 0; q < nquery; q++)
+        {
+            auto query = boost::make_tuple(qx[q], qy[q], 0.);
+            out[q] = this->operator()(sample_points, query);
+        }
+    };
+
     virtual ~interp_base(){};
     interp_base(){};
 
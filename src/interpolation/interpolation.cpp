@@ -82,3 +82,19 @@ double interpolation::operator()(std::vector< boost::tuple<double,double,double>
 
     return base->operator()(sample_points,query_point);
 }
+
+void interpolation::batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+                          size_t nquery, const double* qx, const double* qy, double* out)
+{
+    if (nsample == 0)
+    {
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("Interpolation sample point length = 0."));
+    }
+
+    if (nsample > 15 && ia == interp_alg::tpspline)
+    {
+        LOG_WARNING << "More than 15 sample points is likely to cause slow downs";
+    }
+
+    base->batch(nsample, sx, sy, sz, nquery, qx, qy, out);
+}
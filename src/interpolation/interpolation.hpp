@@ -58,6 +58,15 @@ public:
     void init(interp_alg ia, size_t size=0, std::map<std::string,std::string> config = std::map<std::string,std::string>());
 
     double operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point);
+
+    /*
+     * Interpolates the same sample points to a block of query points. Sample and query points are structure of arrays.
+     * Use this when many faces share the same stations, e.g., to interpolate a chunk of faces at once.
+     * See interp_base::batch
+     */
+    void batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+               size_t nquery, const double* qx, const double* qy, double* out);
+
     boost::shared_ptr<interp_base> base;
 private:
 
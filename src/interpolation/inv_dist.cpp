@@ -23,9 +23,13 @@
 
 #include "inv_dist.hpp"
 
+#include <algorithm>
+#include <limits>
+
 inv_dist::inv_dist()
 {
-    
+    query_x = 0;
+    query_y = 0;
 }
 
 inv_dist::~inv_dist()
@@ -45,33 +49,50 @@ double inv_dist::operator()(std::vector< boost::tuple<double,double,double> >& s
         BOOST_THROW_EXCEPTION( interpolation_error()
                                 << errstr_info("IDW requires >=1 stations"));
     }
-    for(size_t i=0;i<sample_points.size();i++)
+
+    double ex = query_point.get<0>();
+    double ey = query_point.get<1>();
+
+    // The weights only depend on the locations. These only change if the set of stations with valid values changes,
+    // so only recompute them if that has happened.
+    bool same = sample_points.size() == weights.size() && ex == query_x && ey == query_y;
+    for(size_t i=0; same && i<sample_points.size();i++)
     {
-        double z = sample_points.at(i).get<2>();
-
-        double sx = sample_points.at(i).get<0>();
-        double sy = sample_points.at(i).get<1>();
-        
-        double ex = query_point.get<0>();
-        double ey = query_point.get<1>();
-        
-        double xdiff = (sx  - ex);
-        double ydiff = (sy  - ey);
-        double di = pow(sqrt(
-                             pow(xdiff,2.0) + pow(ydiff,2.0)
-                            )
-                        ,2.0
-                    );
-        if(di == 0)
-        {
-                numerator = z;
-                denominator = 1.0;
-        }
-        else
+        same = sample_xy[2*i] == sample_points[i].get<0>() && sample_xy[2*i+1] == sample_points[i].get<1>();
+    }
+
+    if(!same)
+    {
+        weights.resize(sample_points.size());
+        sample_xy.resize(2 * sample_points.size());
+
+        for(size_t i=0;i<sample_points.size();i++)
         {
-                numerator += z/ di;
-                denominator += 1 / di; 
+            double sx = sample_points[i].get<0>();
+            double sy = sample_points[i].get<1>();
+
+            double xdiff = (sx  - ex);
+            double ydiff = (sy  - ey);
+            double di = xdiff*xdiff + ydiff*ydiff;
+
+            sample_xy[2*i] = sx;
+            sample_xy[2*i+1] = sy;
+            weights[i] = di == 0 ? -1 : 1.0 / di; // -1 flags coincident points
         }
+        query_x = ex;
+        query_y = ey;
+    }
+
+    for(size_t i=0;i<sample_points.size();i++)
+    {
+        double z = sample_points[i].get<2>();
+
+        // a sample at the query point is taken exactly
+        if(weights[i] < 0)
+            return z;
+
+        numerator += z * weights[i];
+        denominator += weights[i];
     }
 
    z0 = (numerator/denominator);
@@ -79,3 +100,42 @@ double inv_dist::operator()(std::vector< boost::tuple<double,double,double> >& s
    return z0;
 
 }
+
+void inv_dist::batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+                     size_t nquery, const double* qx, const double* qy, double* out)
+{
+    if (nsample == 0)
+    {
+        BOOST_THROW_EXCEPTION( interpolation_error()
+                                << errstr_info("IDW requires >=1 stations"));
+    }
+
+    // Vectorize over the query points, as there are usually far more of them than sample points
+#pragma omp simd
+    for (size_t q = 0; q < nquery; q++)
+    {
+        double numerator = 0.0;
+        double denominator = 0.0;
+
+        // as in operator(), the first sample at the query point is taken exactly. Selects instead of branches so the
+        // loop still vectorizes; the distance is only clamped to keep the discarded weight finite
+        bool coincident = false;
+        double exact = 0.0;
+
+        for (size_t i = 0; i < nsample; i++)
+        {
+            double xdiff = sx[i] - qx[q];
+            double ydiff = sy[i] - qy[q];
+            double d2 = xdiff * xdiff + ydiff * ydiff;
+
+            exact = (d2 == 0 && !coincident) ? sz[i] : exact;
+            coincident = coincident || d2 == 0;
+
+            double w = 1.0 / std::max(d2, std::numeric_limits<double>::min());
+            numerator += sz[i] * w;
+            denominator += w;
+        }
+
+        out[q] = coincident ? exact : numerator / denominator;
+    }
+}
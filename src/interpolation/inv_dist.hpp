@@ -43,5 +43,20 @@ public:
     * \return Interpolated value at the query_point
     */
     double operator()(std::vector< boost::tuple<double,double,double> >& sample_points, boost::tuple<double,double,double>& query_point);
-           
+
+    /**
+    * IDW of the sample_points at a block of query points. See interp_base::batch.
+    * A query point coincident with a sample point takes that sample's value.
+    */
+    void batch(size_t nsample, const double* sx, const double* sy, const double* sz,
+               size_t nquery, const double* qx, const double* qy, double* out);
+
+private:
+    // sample locations and query point the weights were computed for
+    std::vector<double> sample_xy;
+    double query_x;
+    double query_y;
+
+    // inverse squared distance to each sample point
+    std::vector<double> weights;
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \class precond_refresh
+ * \brief Decides when a preconditioner kept across timesteps should be rebuilt
+ *
+ * The iterations of the first solve after a rebuild are the reference. The preconditioner is stale once a later solve
+ * needs more than ratio times that, or doesn't converge. A ratio <= 0 rebuilds before every solve.
+ */
+class precond_refresh
+{
+public:
+    precond_refresh(double ratio = 2.0)
+        : _ratio(ratio), _iters(0), _stale(true)
+    {
+    }
+
+    /**
+     * True if the preconditioner should be rebuilt before the next solve
+     */
+    bool stale() const
+    {
+        return _stale || _ratio <= 0;
+    }
+
+    /**
+     * Call after rebuilding the preconditioner
+     */
+    void rebuilt()
+    {
+        _iters = 0;
+        _stale = false;
+    }
+
+    /**
+     * Call after every solve with the preconditioner
+     * @param iters Iterations the solve took
+     * @param max_iters Iteration limit of the solver, reaching it means it didn't converge
+     */
+    void solved(size_t iters, size_t max_iters)
+    {
+        if (iters > 0)
+        {
+            if (_iters == 0)
+                _iters = iters;
+            else if (iters > _ratio * _iters)
+                _stale = true;
+        }
+        if (iters >= max_iters)
+            _stale = true;
+    }
+
+    /**
+     * Forget the reference, e.g., when the matrices are rebuilt
+     */
+    void reset()
+    {
+        _iters = 0;
+        _stale = true;
+    }
+
+    double ratio() const
+    {
+        return _ratio;
+    }
+
+    /**
+     * Iterations of the first solve after the last rebuild, 0 until known
+     */
+    size_t reference_iters() const
+    {
+        return _iters;
+    }
+
+private:
+    double _ratio;
+    size_t _iters;
+    bool _stale;
+};
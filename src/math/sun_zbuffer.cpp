@@ -0,0 +1,320 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "sun_zbuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+inline int omp_get_thread_num() { return 0; }
+inline int omp_get_max_threads() { return 1; }
+#endif
+
+namespace
+{
+    // sun_zbuffer::_lit
+    enum : uint8_t
+    {
+        below_cutoff = 0,
+        lit = 1,
+        facing_away = 2
+    };
+
+    // twice the signed area of abc, > 0 if counter clockwise
+    inline double edge(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    }
+
+    // first and last row (or col) of the grid whose cell centers are within [lo, hi]. first > last if there are none.
+    inline void cell_range(double lo, double hi, double origin, double cell, long& first, long& last)
+    {
+        first = static_cast<long>(std::ceil((lo - origin) / cell - 0.5));
+        last = static_cast<long>(std::floor((hi - origin) / cell - 0.5));
+    }
+}
+
+sun_zbuffer::sun_zbuffer()
+        : raster_size(0), bias(1), band_rows(16), _cell(0), _nrows(0), _ncols(0)
+{
+
+}
+
+bool sun_zbuffer::facing_away(size_t i) const
+{
+    return _lit[i] == ::facing_away;
+}
+
+void sun_zbuffer::run(const std::vector<double>& xyz, const std::vector<double>& sun, const std::vector<uint32_t>& faces,
+                      const std::vector<double>& elevation)
+{
+    const size_t nvertex = xyz.size() / 3;
+    const size_t nfaces = faces.size() / 3;
+
+    _prj.resize(nvertex * 3);
+    _zoff.resize(nvertex);
+    _tri.resize(nfaces * 9);
+    _lit.resize(nfaces);
+    _shadow.assign(nfaces, 0);
+    _z_prime.assign(nfaces, 0);
+    _cell = 0;
+    _nrows = 0;
+    _ncols = 0;
+
+    if (nvertex == 0)
+        return;
+
+    // rotate relative to the first vertex, so z' keeps its precision in the float z-buffer
+    const double ox = xyz[0];
+    const double oy = xyz[1];
+    const double oz = xyz[2];
+
+    //compute the rotation of each vertex
+#pragma omp parallel for
+    for (size_t i = 0; i < nvertex; i++)
+    {
+        double A = sun[i * 2 + 0];
+        double E = sun[i * 2 + 1];
+
+        //euler rotation matrix K, eqns(6) & (7) in Montero
+        double z0 = M_PI - A * M_PI / 180.0;
+        double q0 = M_PI / 2.0 - E * M_PI / 180.0;
+
+        double x = xyz[i * 3 + 0] - ox;
+        double y = xyz[i * 3 + 1] - oy;
+        double z = xyz[i * 3 + 2] - oz;
+
+        double* p = &_prj[i * 3];
+        p[0] = cos(z0) * x + sin(z0) * y;
+        p[1] = -cos(q0) * sin(z0) * x + cos(q0) * cos(z0) * y + sin(q0) * z;
+        p[2] = sin(q0) * sin(z0) * x - cos(z0) * sin(q0) * y + cos(q0) * z;
+
+        _zoff[i] = sin(q0) * sin(z0) * ox - cos(z0) * sin(q0) * oy + cos(q0) * oz;
+    }
+
+    // gather the rotated faces and the extent of the lit ones
+    double xmin = std::numeric_limits<double>::max();
+    double ymin = std::numeric_limits<double>::max();
+    double xmax = std::numeric_limits<double>::lowest();
+    double ymax = std::numeric_limits<double>::lowest();
+    double area = 0;
+    size_t nlit = 0;
+
+#pragma omp parallel for reduction(min:xmin,ymin) reduction(max:xmax,ymax) reduction(+:area,nlit)
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        _lit[i] = elevation[i] >= 5 ? lit : below_cutoff;
+        if (_lit[i] == below_cutoff)
+            continue;
+
+        const uint32_t* f = &faces[i * 3];
+        double* t = &_tri[i * 9];
+        for (int v = 0; v < 3; v++)
+        {
+            const double* p = &_prj[f[v] * 3];
+            t[v * 3 + 0] = p[0];
+            t[v * 3 + 1] = p[1];
+            t[v * 3 + 2] = p[2];
+
+            xmin = std::min(xmin, p[0]);
+            xmax = std::max(xmax, p[0]);
+            ymin = std::min(ymin, p[1]);
+            ymax = std::max(ymax, p[1]);
+        }
+        double a = edge(t[0], t[1], t[3], t[4], t[6], t[7]);
+        area += 0.5 * std::fabs(a);
+        nlit++;
+
+        // the winding flips if the face is turned away from the sun
+        const double* p0 = &xyz[f[0] * 3];
+        const double* p1 = &xyz[f[1] * 3];
+        const double* p2 = &xyz[f[2] * 3];
+        if (a * edge(p0[0], p0[1], p1[0], p1[1], p2[0], p2[1]) < 0)
+            _lit[i] = ::facing_away;
+    }
+
+    if (nlit == 0)
+        return;
+
+    // grid in the sun's frame, cell centers at x0 + (col + 0.5) * cell
+    double cell = raster_size > 0 ? raster_size : 0.5 * std::sqrt(area / nlit);
+    if (!(cell > 0))
+        cell = 1;
+
+    // a few nearly edge on faces shouldn't be able to blow up the grid
+    const double max_cells = 64.0 * nlit + (1 << 20);
+    double ncells = std::ceil((xmax - xmin) / cell + 1) * std::ceil((ymax - ymin) / cell + 1);
+    if (ncells > max_cells)
+        cell *= std::sqrt(ncells / max_cells);
+
+    const double x0 = xmin;
+    const double y0 = ymin;
+    const size_t ncols = static_cast<size_t>((xmax - xmin) / cell) + 1;
+    const size_t nrows = static_cast<size_t>((ymax - ymin) / cell) + 1;
+    const size_t rows_per_band = std::max<size_t>(band_rows, 1);
+    const size_t nbands = (nrows + rows_per_band - 1) / rows_per_band;
+
+    _cell = cell;
+    _nrows = nrows;
+    _ncols = ncols;
+
+    _zbuf.assign(nrows * ncols, std::numeric_limits<float>::lowest());
+
+    // bin the faces by band in thread local lists, so a band's rows are only ever written by one thread
+    _bins.resize(omp_get_max_threads());
+    for (auto& b : _bins)
+    {
+        b.resize(nbands);
+        for (auto& l : b)
+            l.clear();
+    }
+
+#pragma omp parallel
+    {
+        auto& bins = _bins[omp_get_thread_num()];
+
+#pragma omp for
+        for (size_t i = 0; i < nfaces; i++)
+        {
+            if (_lit[i] == below_cutoff)
+                continue;
+            const double* t = &_tri[i * 9];
+            double lo = std::min(t[1], std::min(t[4], t[7]));
+            double hi = std::max(t[1], std::max(t[4], t[7]));
+            size_t b0 = static_cast<size_t>((lo - y0) / cell) / rows_per_band;
+            size_t b1 = std::min(static_cast<size_t>((hi - y0) / cell) / rows_per_band, nbands - 1);
+            for (size_t b = b0; b <= b1; b++)
+                bins[b].push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // rasterize each band, keeping the largest z' per cell
+#pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < nbands; b++)
+    {
+        long band_r0 = static_cast<long>(b * rows_per_band);
+        long band_r1 = static_cast<long>(std::min((b + 1) * rows_per_band, nrows)) - 1;
+
+        for (auto& bins : _bins)
+        {
+            for (auto i : bins[b])
+            {
+                const double* t = &_tri[i * 9];
+                double ax = t[0], ay = t[1], az = t[2];
+                double bx = t[3], by = t[4], bz = t[5];
+                double cx = t[6], cy = t[7], cz = t[8];
+
+                // rows and cols whose centers are within the bbox
+                long r0, r1, c0, c1;
+                cell_range(std::min(ay, std::min(by, cy)), std::max(ay, std::max(by, cy)), y0, cell, r0, r1);
+                cell_range(std::min(ax, std::min(bx, cx)), std::max(ax, std::max(bx, cx)), x0, cell, c0, c1);
+
+                double a = edge(ax, ay, bx, by, cx, cy);
+
+                // smaller than a cell, or edge on: it still blocks the cell its center is in
+                if (r0 > r1 || c0 > c1 || a == 0)
+                {
+                    long r = static_cast<long>(((ay + by + cy) / 3.0 - y0) / cell);
+                    long c = static_cast<long>(((ax + bx + cx) / 3.0 - x0) / cell);
+                    if (r >= band_r0 && r <= band_r1)
+                    {
+                        float& z = _zbuf[r * ncols + c];
+                        z = std::max(z, static_cast<float>((az + bz + cz) / 3.0));
+                    }
+                    continue;
+                }
+
+                r0 = std::max(r0, band_r0);
+                r1 = std::min(r1, band_r1);
+                c1 = std::min(c1, static_cast<long>(ncols) - 1);
+
+                for (long r = r0; r <= r1; r++)
+                {
+                    double py = y0 + (r + 0.5) * cell;
+                    for (long c = std::max(c0, 0L); c <= c1; c++)
+                    {
+                        double px = x0 + (c + 0.5) * cell;
+
+                        double w0 = edge(bx, by, cx, cy, px, py) / a;
+                        double w1 = edge(cx, cy, ax, ay, px, py) / a;
+                        double w2 = 1.0 - w0 - w1;
+                        if (w0 < 0 || w1 < 0 || w2 < 0)
+                            continue;
+
+                        float& z = _zbuf[r * ncols + c];
+                        z = std::max(z, static_cast<float>(w0 * az + w1 * bz + w2 * cz));
+                    }
+                }
+            }
+        }
+    }
+
+    // a face is shadowed if it is turned away from the sun, or if the closest surface to the sun in front of its
+    // center is further than the bias
+#pragma omp parallel for
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        if (_lit[i] == below_cutoff)
+            continue;
+
+        const double* t = &_tri[i * 9];
+
+        double mx = (t[0] + t[3] + t[6]) / 3.0;
+        double my = (t[1] + t[4] + t[7]) / 3.0;
+        double mz = (t[2] + t[5] + t[8]) / 3.0;
+
+        size_t r = static_cast<size_t>((my - y0) / cell);
+        size_t c = static_cast<size_t>((mx - x0) / cell);
+
+        // compare against the plane of this face at the cell center, where the cell was rasterized. The bias grows
+        // with how steeply z' changes across the face, as the cell center can be up to a cell from the face.
+        double self = mz;
+        double slope = 1;
+        double a = edge(t[0], t[1], t[3], t[4], t[6], t[7]);
+        if (a != 0)
+        {
+            double px = x0 + (c + 0.5) * cell;
+            double py = y0 + (r + 0.5) * cell;
+            double w0 = edge(t[3], t[4], t[6], t[7], px, py) / a;
+            double w1 = edge(t[6], t[7], t[0], t[1], px, py) / a;
+            self = w0 * t[2] + w1 * t[5] + (1.0 - w0 - w1) * t[8];
+
+            double gx = (t[2] * (t[4] - t[7]) + t[5] * (t[7] - t[1]) + t[8] * (t[1] - t[4])) / a;
+            double gy = (t[2] * (t[6] - t[3]) + t[5] * (t[0] - t[6]) + t[8] * (t[3] - t[0])) / a;
+            slope = std::max(1.0, std::sqrt(gx * gx + gy * gy));
+        }
+
+        _shadow[i] = _lit[i] == ::facing_away || _zbuf[r * ncols + c] > self + bias * slope * cell;
+
+        // back in the frame of the original coordinates
+        _z_prime[i] = mz + _zoff[faces[i * 3]];
+    }
+}
@@ -0,0 +1,116 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \class sun_zbuffer
+ * \brief Terrain shadows from a z-buffer in the sun's frame
+ *
+ * Every vertex is rotated into a frame looking down from the sun, z' towards the sun, and the faces are rasterized on
+ * a grid in that frame keeping the largest z' per cell. A face is shadowed if it faces away from the sun or something
+ * closer to the sun is in front of its center. This is O(n) in the number of faces plus the number of cells.
+ *
+ * The rows of cells are split into bands, each only written by one thread. The coordinates are taken
+ * relative to the first vertex before rotating, so the float z-buffer keeps its precision with UTM coordinates.
+ *
+ * Used by Marsh_shading_iswr.
+ */
+class sun_zbuffer
+{
+public:
+    sun_zbuffer();
+
+    /**
+     * @param xyz [vertex][x y z]
+     * @param sun [vertex][azimuth elevation] of the sun seen from each vertex, degrees
+     * @param faces [face][3] vertex indexes
+     * @param elevation Solar elevation of each face, degrees. Faces with the sun below 5 degrees are neither shadowed
+     * nor shadowing.
+     */
+    void run(const std::vector<double>& xyz, const std::vector<double>& sun, const std::vector<uint32_t>& faces,
+             const std::vector<double>& elevation);
+
+    bool shadowed(size_t i) const
+    {
+        return _shadow[i] != 0;
+    }
+
+    /**
+     * True if the face is turned away from the sun, which also makes it shadowed
+     */
+    bool facing_away(size_t i) const;
+
+    /**
+     * z' of the face's center, how near it is to the sun. 0 below the cutoff.
+     */
+    double z_prime(size_t i) const
+    {
+        return _z_prime[i];
+    }
+
+    // size of the last run's grid
+    double cell() const
+    {
+        return _cell;
+    }
+
+    size_t rows() const
+    {
+        return _nrows;
+    }
+
+    size_t cols() const
+    {
+        return _ncols;
+    }
+
+    // Cell size [m]. 0 is half the mean projected face size.
+    double raster_size;
+
+    // How far behind, in cell sizes, a face must be to be shadowed. Scaled up for faces near edge on to the sun.
+    double bias;
+
+    // Rows per band. Each band is rasterized by one thread.
+    size_t band_rows;
+
+private:
+    std::vector<double> _prj;      // rotated vertex relative to the first one, [vertex][x' y' z']
+    std::vector<double> _zoff;     // z' of the first vertex in each vertex's rotation
+    std::vector<double> _tri;      // rotated vertexes of each face, [face][3][x' y' z']
+    std::vector<uint8_t> _lit;     // sun below the cutoff, lit, or facing away, per face
+    std::vector<float> _zbuf;      // largest z' per cell, [row][col]
+    std::vector<std::vector<std::vector<uint32_t>>> _bins; // per thread, faces overlapping each band of rows
+
+    std::vector<uint8_t> _shadow;
+    std::vector<double> _z_prime;
+
+    double _cell;
+    size_t _nrows;
+    size_t _ncols;
+};
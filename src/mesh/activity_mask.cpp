@@ -0,0 +1,55 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "activity_mask.hpp"
+
+void activity_mask::_collect()
+{
+    _faces.clear();
+    for (size_t i = 0; i < _mask.size(); i++)
+    {
+        if (_mask[i])
+            _faces.push_back(i);
+    }
+}
+
+const std::vector<size_t>& activity_mask::faces() const
+{
+    return _faces;
+}
+
+size_t activity_mask::count() const
+{
+    return _faces.size();
+}
+
+bool activity_mask::none() const
+{
+    return _faces.empty();
+}
+
+bool activity_mask::all() const
+{
+    return _faces.size() == _mask.size();
+}
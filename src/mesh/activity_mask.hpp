@@ -0,0 +1,100 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "triangulation.hpp"
+
+/**
+ * \class activity_mask
+ * \brief Per face flag of where a module has anything to do this timestep
+ *
+ * A module derives it cheaply at the start of run(), e.g., swe > 0 and the wind above a threshold, and then only
+ * loops over faces(), or skips the timestep entirely if none() are active.
+ */
+class activity_mask
+{
+public:
+    /**
+     * Sets each face active if active(face) is true. Evaluated in parallel.
+     * @param domain
+     * @param active bool(mesh_elem)
+     */
+    template<typename Pred>
+    void update(mesh& domain, Pred active);
+
+    /**
+     * Sets face i active if active(i) is true. Evaluated in parallel.
+     * @param nfaces
+     * @param active bool(size_t)
+     */
+    template<typename Pred>
+    void update(size_t nfaces, Pred active);
+
+    /**
+     * @param i cell_local_id
+     */
+    bool active(size_t i) const
+    {
+        return _mask[i] != 0;
+    }
+
+    /**
+     * cell_local_id of the active faces, ascending
+     */
+    const std::vector<size_t>& faces() const;
+
+    size_t count() const;
+    bool none() const;
+    bool all() const;
+
+private:
+    void _collect();
+
+    std::vector<uint8_t> _mask; // not vector<bool>, so faces can be set from multiple threads
+    std::vector<size_t> _faces;
+};
+
+template<typename Pred>
+void activity_mask::update(mesh& domain, Pred active)
+{
+    update(domain->size_faces(), [&](size_t i) -> bool { return active(domain->face(i)); });
+}
+
+template<typename Pred>
+void activity_mask::update(size_t nfaces, Pred active)
+{
+    _mask.resize(nfaces);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        _mask[i] = active(i) ? 1 : 0;
+    }
+
+    _collect();
+}
@@ -0,0 +1,100 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * \class downhill_queue
+ * \brief Visits faces highest first, starting from a few and adding those that receive something from a higher one
+ *
+ * For a downhill redistribution (e.g., snow_slide) where only some faces start anything and a face can only change
+ * because a higher face gave to it. Visiting the seeds and the receivers in descending z gives the same result as
+ * visiting every face of a full sort by z, without sorting the whole mesh. Receivers that aren't lower than the
+ * giving face are left out, as a full sort would already have passed them.
+ *
+ * The storage is kept between calls.
+ */
+class downhill_queue
+{
+public:
+    /**
+     * @param nfaces Faces are 0..nfaces-1
+     * @param seeds Faces to start from, in any order
+     * @param z double(size_t), the visiting order. Must not change during the call
+     * @param visit void(size_t face, std::vector<size_t>& receivers). Appends the faces it gave to, to receivers
+     */
+    template<typename Z, typename Visit>
+    void run(size_t nfaces, const std::vector<size_t>& seeds, Z z, Visit visit);
+
+private:
+    typedef std::pair<double, size_t> queued_face;
+
+    std::vector<uint8_t> _queued;
+    std::vector<size_t> _receivers;
+    std::vector<queued_face> _heap;
+};
+
+template<typename Z, typename Visit>
+void downhill_queue::run(size_t nfaces, const std::vector<size_t>& seeds, Z z, Visit visit)
+{
+    _queued.assign(nfaces, 0);
+
+    // max-heap on z, ties broken by the face index so the order is deterministic
+    _heap.clear();
+    for (auto i : seeds)
+    {
+        _queued[i] = 1;
+        _heap.push_back(std::make_pair(z(i), i));
+    }
+    std::make_heap(_heap.begin(), _heap.end());
+
+    while (!_heap.empty())
+    {
+        std::pop_heap(_heap.begin(), _heap.end());
+        auto top = _heap.back();
+        _heap.pop_back();
+
+        _receivers.clear();
+        visit(top.second, _receivers);
+
+        for (auto j : _receivers)
+        {
+            if (_queued[j])
+                continue;
+
+            double zj = z(j);
+            if (zj < top.first || (zj == top.first && j < top.second))
+            {
+                _queued[j] = 1;
+                _heap.push_back(std::make_pair(zj, j));
+                std::push_heap(_heap.begin(), _heap.end());
+            }
+        }
+    }
+}
@@ -0,0 +1,161 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "face_locator.hpp"
+
+#include <algorithm>
+#include <limits>
+
+face_locator::face_locator(const std::vector<double>& centers, double extent)
+    : _x0(0), _y0(0), _cell(1), _nx(0), _ny(0), _extent(extent)
+{
+    size_t n = centers.size() / 2;
+    if (n == 0)
+        return;
+
+    double xmax = std::numeric_limits<double>::lowest();
+    double ymax = std::numeric_limits<double>::lowest();
+    _x0 = std::numeric_limits<double>::max();
+    _y0 = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < n; i++)
+    {
+        _x0 = std::min(_x0, centers[2 * i]);
+        _y0 = std::min(_y0, centers[2 * i + 1]);
+        xmax = std::max(xmax, centers[2 * i]);
+        ymax = std::max(ymax, centers[2 * i + 1]);
+    }
+
+    // about one center per cell
+    double w = xmax - _x0;
+    double h = ymax - _y0;
+    if (w > 0 && h > 0)
+        _cell = std::sqrt(w * h / n);
+    else if (std::max(w, h) > 0)
+        _cell = std::max(w, h) / n;
+
+    _nx = static_cast<size_t>(w / _cell) + 1;
+    _ny = static_cast<size_t>(h / _cell) + 1;
+
+    // counting sort of the centers into their cells
+    std::vector<uint32_t> cell_of(n);
+    _start.assign(_nx * _ny + 1, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        cell_of[i] = static_cast<uint32_t>(_row(centers[2 * i + 1]) * _nx + _col(centers[2 * i]));
+        _start[cell_of[i] + 1]++;
+    }
+    for (size_t c = 0; c < _nx * _ny; c++)
+        _start[c + 1] += _start[c];
+
+    _index.resize(n);
+    _points.resize(2 * n);
+    std::vector<uint32_t> next(_start.begin(), _start.end() - 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t k = next[cell_of[i]]++;
+        _index[k] = static_cast<uint32_t>(i);
+        _points[2 * k] = centers[2 * i];
+        _points[2 * k + 1] = centers[2 * i + 1];
+    }
+}
+
+size_t face_locator::closest(double x, double y) const
+{
+    long cx = _col(x);
+    long cy = _row(y);
+
+    double best = std::numeric_limits<double>::max();
+    size_t best_face = 0;
+
+    for (long ring = 0;; ring++)
+    {
+        for (long r = cy - ring; r <= cy + ring; r++)
+        {
+            if (r < 0 || r >= static_cast<long>(_ny))
+                continue;
+            bool edge_row = r == cy - ring || r == cy + ring;
+            for (long c = cx - ring; c <= cx + ring; c += edge_row ? 1 : 2 * ring)
+            {
+                if (c >= 0 && c < static_cast<long>(_nx))
+                {
+                    size_t cell = r * _nx + c;
+                    for (uint32_t k = _start[cell]; k < _start[cell + 1]; k++)
+                    {
+                        double dx = _points[2 * k] - x;
+                        double dy = _points[2 * k + 1] - y;
+                        double d = dx * dx + dy * dy;
+                        if (d < best || (d == best && _index[k] < best_face))
+                        {
+                            best = d;
+                            best_face = _index[k];
+                        }
+                    }
+                }
+                if (ring == 0)
+                    break;
+            }
+        }
+
+        // the cells not searched yet are all beyond the box of rings searched so far. Stop once the best is closer
+        // than the nearest side of that box that still has cells behind it.
+        double bound = std::numeric_limits<double>::max();
+        bool more = false;
+        if (cx - ring > 0)
+        {
+            bound = std::min(bound, x - (_x0 + (cx - ring) * _cell));
+            more = true;
+        }
+        if (cx + ring + 1 < static_cast<long>(_nx))
+        {
+            bound = std::min(bound, _x0 + (cx + ring + 1) * _cell - x);
+            more = true;
+        }
+        if (cy - ring > 0)
+        {
+            bound = std::min(bound, y - (_y0 + (cy - ring) * _cell));
+            more = true;
+        }
+        if (cy + ring + 1 < static_cast<long>(_ny))
+        {
+            bound = std::min(bound, _y0 + (cy + ring + 1) * _cell - y);
+            more = true;
+        }
+
+        if (!more || (best < std::numeric_limits<double>::max() && bound >= 0 && best < bound * bound))
+            break;
+    }
+
+    return best_face;
+}
+
+std::vector<size_t> face_locator::in_radius(double x, double y, double radius) const
+{
+    std::vector<size_t> faces;
+    for_each_near(x, y, radius, [&faces](size_t f) {
+        faces.push_back(f);
+        return false;
+    });
+    std::sort(faces.begin(), faces.end());
+    return faces;
+}
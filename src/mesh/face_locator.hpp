@@ -0,0 +1,227 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \class face_locator
+ * \brief Uniform bucket grid over the face centers
+ *
+ * Sized to hold about one center per cell, with the centers stored bucket by bucket so a query only touches a few
+ * contiguous runs of memory. Answers the exact nearest center and within-radius queries the centroid kd-tree used to,
+ * at a fraction of its size. locate() finds the face containing a point by walking the adjacency from closest(), and
+ * falls back on for_each_near() if the walk leaves the mesh.
+ */
+/**
+ * Visibility walk along the adjacency from start towards x, y. The edge tested first rotates each step, so the walk
+ * can't cycle. Works with either winding.
+ * @param start Any handle with vertex(i)->point(), neighbor(i) (across from vertex(i), nullptr on the boundary),
+ * _is_ghost and contains(x, y)
+ * @return The face containing x, y, or nullptr if the walk leaves the (local) mesh, ends on an edge, or gives up after
+ * max_steps
+ */
+template<typename Face>
+Face walk_to(Face start, double x, double y, size_t max_steps = 64)
+{
+    Face f = start;
+    for (size_t step = 0; f != nullptr && step < max_steps; step++)
+    {
+        int next = -1;
+        for (int e = 0; e < 3 && next < 0; e++)
+        {
+            int i = (e + step) % 3;
+            auto a = f->vertex((i + 1) % 3)->point();
+            auto b = f->vertex((i + 2) % 3)->point();
+            auto v = f->vertex(i)->point();
+
+            double side_p = (b.x() - a.x()) * (y - a.y()) - (b.y() - a.y()) * (x - a.x());
+            double side_v = (b.x() - a.x()) * (v.y() - a.y()) - (b.y() - a.y()) * (v.x() - a.x());
+            if (side_p * side_v < 0)
+                next = i;
+        }
+
+        // on no edge's far side: inside, or on an edge, which contains() doesn't count
+        if (next < 0)
+            return !f->_is_ghost && f->contains(x, y) ? f : nullptr;
+
+        f = f->neighbor(next);
+        if (f != nullptr && f->_is_ghost)
+            return nullptr;
+    }
+
+    return nullptr;
+}
+
+class face_locator
+{
+public:
+    face_locator()
+        : _x0(0), _y0(0), _cell(1), _nx(0), _ny(0), _extent(0)
+    {
+    }
+
+    /**
+     * @param centers [face][x y]
+     * @param extent Largest distance from a face's center to one of its vertexes. Any face containing a point has its
+     * center within this distance of it.
+     */
+    face_locator(const std::vector<double>& centers, double extent);
+
+    size_t size() const
+    {
+        return _index.size();
+    }
+
+    double extent() const
+    {
+        return _extent;
+    }
+
+    /**
+     * Face with the nearest center. Ties go to the lowest index. Undefined if there are no faces.
+     */
+    size_t closest(double x, double y) const;
+
+    /**
+     * Faces with a center within radius, inclusive, in ascending order
+     */
+    std::vector<size_t> in_radius(double x, double y, double radius) const;
+
+    /**
+     * Calls f(face) for the faces with a center within radius of x, y, bucket by bucket outward from x, y, until f
+     * returns true.
+     * @return true if f did
+     */
+    template<typename F>
+    bool for_each_near(double x, double y, double radius, F f) const;
+
+    /**
+     * The face containing x, y, or nullptr if none does. Walks the adjacency from the face with the closest center
+     * (see walk_to), and if that runs off the mesh, e.g., around a concave boundary, tests the faces near x, y.
+     * @param face Face handle of index i, as used to build the locator
+     */
+    template<typename FaceAt>
+    auto locate(double x, double y, FaceAt face) const -> decltype(face(0));
+
+    size_t memory() const
+    {
+        return _start.size() * sizeof(uint32_t) + _index.size() * sizeof(uint32_t) + _points.size() * sizeof(double);
+    }
+
+private:
+    long _col(double x) const
+    {
+        long c = static_cast<long>(std::floor((x - _x0) / _cell));
+        return c < 0 ? 0 : (c >= static_cast<long>(_nx) ? static_cast<long>(_nx) - 1 : c);
+    }
+
+    long _row(double y) const
+    {
+        long r = static_cast<long>(std::floor((y - _y0) / _cell));
+        return r < 0 ? 0 : (r >= static_cast<long>(_ny) ? static_cast<long>(_ny) - 1 : r);
+    }
+
+    double _x0, _y0, _cell;
+    size_t _nx, _ny;
+    double _extent;
+
+    std::vector<uint32_t> _start;  // [cell] first entry of the cell in _index, plus one past the end
+    std::vector<uint32_t> _index;  // face of each entry, bucket by bucket
+    std::vector<double> _points;   // [entry][x y] center of _index[entry]
+};
+
+template<typename F>
+bool face_locator::for_each_near(double x, double y, double radius, F f) const
+{
+    if (_index.empty())
+        return false;
+
+    long cx = _col(x);
+    long cy = _row(y);
+    long reach = static_cast<long>(std::ceil(radius / _cell)) + 1;
+    double r2 = radius * radius;
+
+    // rings of cells around x, y
+    for (long ring = 0; ring <= reach; ring++)
+    {
+        bool any = false;
+        for (long r = cy - ring; r <= cy + ring; r++)
+        {
+            if (r < 0 || r >= static_cast<long>(_ny))
+                continue;
+            bool edge_row = r == cy - ring || r == cy + ring;
+            for (long c = cx - ring; c <= cx + ring; c += edge_row ? 1 : 2 * ring)
+            {
+                if (c >= 0 && c < static_cast<long>(_nx))
+                {
+                    any = true;
+                    size_t cell = r * _nx + c;
+                    for (uint32_t k = _start[cell]; k < _start[cell + 1]; k++)
+                    {
+                        double dx = _points[2 * k] - x;
+                        double dy = _points[2 * k + 1] - y;
+                        if (dx * dx + dy * dy <= r2 && f(static_cast<size_t>(_index[k])))
+                            return true;
+                    }
+                }
+                if (ring == 0)
+                    break;
+            }
+        }
+        if (!any && ring > 0 && cx - ring < 0 && cy - ring < 0 && cx + ring >= static_cast<long>(_nx) &&
+            cy + ring >= static_cast<long>(_ny))
+            break;
+    }
+    return false;
+}
+
+template<typename FaceAt>
+auto face_locator::locate(double x, double y, FaceAt face) const -> decltype(face(0))
+{
+    if (_index.empty())
+        return nullptr;
+
+    // the face with the nearest center is nearly always it, or one or two faces over
+    auto f = walk_to(face(closest(x, y)), x, y);
+    if (f != nullptr)
+        return f;
+
+    // any face that contains the point has its center within _extent of it
+    for_each_near(x, y, _extent, [&](size_t i) {
+        auto c = face(i);
+        if (!c->_is_ghost && c->contains(x, y))
+        {
+            f = c;
+            return true;
+        }
+        return false;
+    });
+
+    return f;
+}
+
@@ -0,0 +1,272 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "face_order.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+
+#include "exception.hpp"
+
+namespace face_order
+{
+    namespace
+    {
+        const uint32_t grid_bits = 16;
+
+        // Maps the points onto a 2^grid_bits square grid over their bounding box. A square keeps the cells isotropic.
+        void quantize(const std::vector<double>& x, const std::vector<double>& y,
+                      std::vector<uint32_t>& ix, std::vector<uint32_t>& iy)
+        {
+            const size_t n = x.size();
+            ix.resize(n);
+            iy.resize(n);
+            if (n == 0)
+                return;
+
+            double min_x = *std::min_element(x.begin(), x.end());
+            double max_x = *std::max_element(x.begin(), x.end());
+            double min_y = *std::min_element(y.begin(), y.end());
+            double max_y = *std::max_element(y.begin(), y.end());
+
+            double extent = std::max(max_x - min_x, max_y - min_y);
+            const double cells = static_cast<double>((1u << grid_bits) - 1);
+            double scale = extent > 0 ? cells / extent : 0;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                ix[i] = static_cast<uint32_t>((x[i] - min_x) * scale);
+                iy[i] = static_cast<uint32_t>((y[i] - min_y) * scale);
+            }
+        }
+
+        // https://en.wikipedia.org/wiki/Hilbert_curve, xy2d
+        uint64_t hilbert_index(uint32_t x, uint32_t y)
+        {
+            const uint32_t n = 1u << grid_bits;
+            uint64_t d = 0;
+            for (uint32_t s = n / 2; s > 0; s /= 2)
+            {
+                uint32_t rx = (x & s) > 0;
+                uint32_t ry = (y & s) > 0;
+                d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+                // rotate the quadrant
+                if (ry == 0)
+                {
+                    if (rx == 1)
+                    {
+                        x = n - 1 - x;
+                        y = n - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        }
+
+        // spreads the low 16 bits out to the even bits
+        uint64_t spread(uint32_t v)
+        {
+            uint64_t x = v & 0xFFFF;
+            x = (x | (x << 8)) & 0x00FF00FF;
+            x = (x | (x << 4)) & 0x0F0F0F0F;
+            x = (x | (x << 2)) & 0x33333333;
+            x = (x | (x << 1)) & 0x55555555;
+            return x;
+        }
+
+        std::vector<size_t> sort_by_key(const std::vector<uint64_t>& key)
+        {
+            std::vector<size_t> order(key.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [&key](size_t a, size_t b)
+                             {
+                                 return key[a] < key[b];
+                             });
+            return order;
+        }
+
+        void bisect_coordinates(const std::vector<double>& x, const std::vector<double>& y,
+                                std::vector<size_t>::iterator begin, std::vector<size_t>::iterator end)
+        {
+            if (end - begin <= 1)
+                return;
+
+            double min_x = x[*begin], max_x = x[*begin];
+            double min_y = y[*begin], max_y = y[*begin];
+            for (auto itr = begin; itr != end; ++itr)
+            {
+                min_x = std::min(min_x, x[*itr]);
+                max_x = std::max(max_x, x[*itr]);
+                min_y = std::min(min_y, y[*itr]);
+                max_y = std::max(max_y, y[*itr]);
+            }
+
+            const std::vector<double>& axis = (max_x - min_x) >= (max_y - min_y) ? x : y;
+
+            auto mid = begin + (end - begin) / 2;
+            std::nth_element(begin, mid, end,
+                             [&axis](size_t a, size_t b)
+                             {
+                                 return axis[a] < axis[b];
+                             });
+
+            bisect_coordinates(x, y, begin, mid);
+            bisect_coordinates(x, y, mid, end);
+        }
+
+        // BFS over the faces labelled `label`, starting at `start`. Returns them in visiting order.
+        void bfs(const std::vector<size_t>& neighbours, const std::vector<size_t>& label, size_t current,
+                 size_t start, std::vector<char>& seen, std::vector<size_t>& visited)
+        {
+            visited.clear();
+            std::queue<size_t> q;
+            q.push(start);
+            seen[start] = 1;
+            while (!q.empty())
+            {
+                size_t f = q.front();
+                q.pop();
+                visited.push_back(f);
+                for (size_t j = 0; j < 3; j++)
+                {
+                    size_t n = neighbours[3 * f + j];
+                    if (n != no_neighbour && label[n] == current && !seen[n])
+                    {
+                        seen[n] = 1;
+                        q.push(n);
+                    }
+                }
+            }
+        }
+
+        void bisect_graph(const std::vector<size_t>& neighbours, std::vector<size_t>& label, size_t& next_label,
+                          std::vector<char>& seen, std::vector<size_t>& order, size_t begin, size_t end)
+        {
+            if (end - begin <= 2)
+                return;
+
+            size_t current = next_label++;
+            for (size_t i = begin; i < end; i++)
+                label[order[i]] = current;
+
+            // At the top, the last face reached from an arbitrary start is (close to) peripheral. Starting there gives
+            // long, narrow BFS levels, so the split at the middle cuts few edges. Below that, a set's first face is
+            // where the parent's search entered it, which keeps each half continuing on from the one before.
+            std::vector<size_t> visited;
+            size_t start = order[begin];
+            if (begin == 0 && end == order.size())
+            {
+                bfs(neighbours, label, current, start, seen, visited);
+                for (auto f : visited)
+                    seen[f] = 0;
+                start = visited.back();
+            }
+            bfs(neighbours, label, current, start, seen, visited);
+
+            // anything not connected to the start within this set goes at the end, in its current order
+            for (size_t i = begin; i < end; i++)
+            {
+                if (!seen[order[i]])
+                    visited.push_back(order[i]);
+            }
+            for (size_t i = 0; i < visited.size(); i++)
+            {
+                seen[visited[i]] = 0;
+                order[begin + i] = visited[i];
+            }
+
+            size_t mid = begin + (end - begin) / 2;
+            bisect_graph(neighbours, label, next_label, seen, order, begin, mid);
+            bisect_graph(neighbours, label, next_label, seen, order, mid, end);
+        }
+    }
+
+    std::vector<size_t> hilbert(const std::vector<double>& x, const std::vector<double>& y)
+    {
+        std::vector<uint32_t> ix, iy;
+        quantize(x, y, ix, iy);
+
+        std::vector<uint64_t> key(x.size());
+        for (size_t i = 0; i < x.size(); i++)
+            key[i] = hilbert_index(ix[i], iy[i]);
+
+        return sort_by_key(key);
+    }
+
+    std::vector<size_t> morton(const std::vector<double>& x, const std::vector<double>& y)
+    {
+        std::vector<uint32_t> ix, iy;
+        quantize(x, y, ix, iy);
+
+        std::vector<uint64_t> key(x.size());
+        for (size_t i = 0; i < x.size(); i++)
+            key[i] = spread(ix[i]) | (spread(iy[i]) << 1);
+
+        return sort_by_key(key);
+    }
+
+    std::vector<size_t> coordinate_bisection(const std::vector<double>& x, const std::vector<double>& y)
+    {
+        std::vector<size_t> order(x.size());
+        std::iota(order.begin(), order.end(), 0);
+        bisect_coordinates(x, y, order.begin(), order.end());
+        return order;
+    }
+
+    std::vector<size_t> graph_bisection(const std::vector<size_t>& neighbours)
+    {
+        const size_t n = neighbours.size() / 3;
+
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+
+        std::vector<size_t> label(n, 0);
+        std::vector<char> seen(n, 0);
+        size_t next_label = 1;
+        bisect_graph(neighbours, label, next_label, seen, order, 0, n);
+        return order;
+    }
+
+    std::vector<size_t> compute(const std::string& method,
+                                const std::vector<double>& x, const std::vector<double>& y,
+                                const std::vector<size_t>& neighbours)
+    {
+        if (method == "hilbert")
+            return hilbert(x, y);
+        if (method == "morton")
+            return morton(x, y);
+        if (method == "rcb")
+            return coordinate_bisection(x, y);
+        if (method == "graph")
+            return graph_bisection(neighbours);
+
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("Unknown face order " + method +
+                                                            ". Use one of none, hilbert, morton, rcb, graph"));
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * Locality-aware face orderings. Each function returns a permutation in the convention of
+ * triangulation::reorder_faces, i.e., permutation[new_index] = old_index.
+ *
+ * As partition_mesh gives each MPI process a contiguous range of the ordering, these also act as the partitioner:
+ * a contiguous range of any of these orderings is a spatially compact set of faces.
+ */
+namespace face_order
+{
+    // marks a missing neighbour in the adjacency list
+    const size_t no_neighbour = std::numeric_limits<size_t>::max();
+
+    /**
+     * Sorts the faces along a Hilbert curve through their centres
+     * @param x Face centre x
+     * @param y Face centre y
+     * @return
+     */
+    std::vector<size_t> hilbert(const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+     * Sorts the faces along a Morton (z-order) curve through their centres. Cheaper to compute than hilbert but with
+     * jumps between the quadrants.
+     * @param x Face centre x
+     * @param y Face centre y
+     * @return
+     */
+    std::vector<size_t> morton(const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+     * Recursive coordinate bisection. The faces are split at the median of the longer axis of their bounding box,
+     * and each half is split again, until single faces remain.
+     * @param x Face centre x
+     * @param y Face centre y
+     * @return
+     */
+    std::vector<size_t> coordinate_bisection(const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+     * Recursive graph bisection over the face adjacency. Each set of faces is ordered by a breadth first search from a
+     * pseudo-peripheral face and split in half, so the halves follow the mesh connectivity rather than the coordinates.
+     * @param neighbours 3 entries per face, the indexes of its neighbours or no_neighbour
+     * @return
+     */
+    std::vector<size_t> graph_bisection(const std::vector<size_t>& neighbours);
+
+    /**
+     * Computes the ordering by name: "hilbert", "morton", "rcb" or "graph". Throws config_error for anything else.
+     * @param method
+     * @param x Face centre x
+     * @param y Face centre y
+     * @param neighbours As for graph_bisection
+     * @return
+     */
+    std::vector<size_t> compute(const std::string& method,
+                                const std::vector<double>& x, const std::vector<double>& y,
+                                const std::vector<size_t>& neighbours);
+}
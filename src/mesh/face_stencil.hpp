@@ -0,0 +1,118 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \class face_stencil
+ * \brief The faces hit walking out from every face's center along a set of azimuths
+ *
+ * For n evenly spaced azimuths (bin k is k * 360/n degrees, clockwise from north) and a list of distances, holds the
+ * cell_local_id of the face closest to each point along each ray. Terrain searches (shadowing, fetch, Sx, curvature,
+ * sky view) can then walk an array instead of making a kd-tree query per step. Built and shared by
+ * triangulation::directional_stencil.
+ */
+class face_stencil
+{
+public:
+    face_stencil(size_t nfaces, size_t azimuths, const std::vector<double>& distances)
+        : _nazimuths(azimuths), _distances(distances), _index(nfaces * azimuths * distances.size())
+    {
+    }
+
+    /**
+     * The distances of a search taking steps steps of size_of_step, i.e., size_of_step, 2 * size_of_step, ...
+     */
+    static std::vector<double> uniform_steps(size_t steps, double size_of_step)
+    {
+        std::vector<double> distances(steps);
+        for (size_t j = 0; j < steps; j++)
+            distances[j] = (j + 1) * size_of_step;
+        return distances;
+    }
+
+    size_t azimuths() const
+    {
+        return _nazimuths;
+    }
+
+    /**
+     * Azimuth of bin k, degrees
+     */
+    double azimuth(size_t k) const
+    {
+        return k * 360.0 / _nazimuths;
+    }
+
+    /**
+     * Nearest bin to an azimuth in degrees
+     */
+    size_t bin(double azimuth) const
+    {
+        double a = std::fmod(azimuth, 360.0);
+        if (a < 0)
+            a += 360.0;
+        return static_cast<size_t>(std::lround(a * _nazimuths / 360.0)) % _nazimuths;
+    }
+
+    const std::vector<double>& distances() const
+    {
+        return _distances;
+    }
+
+    size_t steps() const
+    {
+        return _distances.size();
+    }
+
+    /**
+     * cell_local_id of the faces at each distance along azimuth bin k from face i, steps() of them
+     */
+    const uint32_t* ray(size_t i, size_t k) const
+    {
+        return _index.data() + (i * _nazimuths + k) * _distances.size();
+    }
+
+    uint32_t* ray(size_t i, size_t k)
+    {
+        return _index.data() + (i * _nazimuths + k) * _distances.size();
+    }
+
+    /**
+     * Bytes held
+     */
+    size_t memory() const
+    {
+        return _index.size() * sizeof(uint32_t);
+    }
+
+private:
+    size_t _nazimuths;
+    std::vector<double> _distances;
+    std::vector<uint32_t> _index; // [face][azimuth][step]
+};
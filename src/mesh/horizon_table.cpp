@@ -0,0 +1,91 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "horizon_table.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "exception.hpp"
+
+namespace
+{
+    const char magic[8] = {'C', 'H', 'M', 'H', 'R', 'Z', 'N', '1'};
+
+    struct header
+    {
+        char magic[8];
+        uint64_t nfaces;
+        uint64_t nsectors;
+        uint64_t nsteps;
+        double checksum;
+    };
+}
+
+void horizon_table::save(const std::string& file) const
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out)
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info("Unable to write horizon table " + file));
+
+    header h;
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.nfaces = faces();
+    h.nsectors = _nsectors;
+    h.nsteps = _distances.size();
+    h.checksum = _checksum;
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(_distances.data()), _distances.size() * sizeof(double));
+    out.write(reinterpret_cast<const char*>(_phi.data()), _phi.size() * sizeof(float));
+
+    if (!out)
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info("Unable to write horizon table " + file));
+}
+
+bool horizon_table::load(const std::string& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return false;
+
+    header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || std::memcmp(h.magic, magic, sizeof(magic)) != 0)
+        return false;
+
+    if (h.nfaces != faces() || h.nsectors != _nsectors || h.nsteps != _distances.size() || h.checksum != _checksum)
+        return false;
+
+    std::vector<double> distances(h.nsteps);
+    if (!in.read(reinterpret_cast<char*>(distances.data()), distances.size() * sizeof(double)) ||
+        distances != _distances)
+        return false;
+
+    std::vector<float> phi(_phi.size());
+    if (!in.read(reinterpret_cast<char*>(phi.data()), phi.size() * sizeof(float)))
+        return false;
+
+    _phi.swap(phi);
+    return true;
+}
@@ -0,0 +1,155 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \class horizon_table
+ * \brief Horizon elevation angle of every face over n evenly spaced azimuth sectors
+ *
+ * Sector k is centred on k * 360/n degrees, clockwise from north, and holds the maximum elevation angle (radians,
+ * >= 0) of the terrain seen from the face's center along that azimuth. Computed once by
+ * triangulation::horizon_angles, after which shadowing is a lookup against the solar elevation and the sky view
+ * factor is a sum over the sectors. It depends on the terrain elevation, so it is stale once the mesh is deformed.
+ *
+ * It can be saved next to the mesh and reloaded on the next run. The file holds the sector count, the search
+ * distances, the number of faces and a checksum of the face centers; load() only accepts a file matching all four.
+ */
+class horizon_table
+{
+public:
+    horizon_table(size_t nfaces, size_t sectors, const std::vector<double>& distances)
+        : _nsectors(sectors), _distances(distances), _checksum(0), _phi(nfaces * sectors, 0.f)
+    {
+    }
+
+    size_t sectors() const
+    {
+        return _nsectors;
+    }
+
+    size_t faces() const
+    {
+        return _nsectors ? _phi.size() / _nsectors : 0;
+    }
+
+    /**
+     * Azimuth of sector k, degrees
+     */
+    double azimuth(size_t k) const
+    {
+        return k * 360.0 / _nsectors;
+    }
+
+    /**
+     * Search distances the horizon was computed over
+     */
+    const std::vector<double>& distances() const
+    {
+        return _distances;
+    }
+
+    /**
+     * Horizon angle of face i in sector k, radians
+     */
+    float& at(size_t i, size_t k)
+    {
+        return _phi[i * _nsectors + k];
+    }
+
+    float at(size_t i, size_t k) const
+    {
+        return _phi[i * _nsectors + k];
+    }
+
+    /**
+     * Horizon angle of face i towards azimuth, linearly interpolated between the two neighbouring sectors
+     * @param i cell_local_id
+     * @param azimuth degrees
+     * @return radians
+     */
+    double horizon(size_t i, double azimuth) const
+    {
+        double a = std::fmod(azimuth, 360.0);
+        if (a < 0)
+            a += 360.0;
+        a *= _nsectors / 360.0;
+
+        size_t k0 = static_cast<size_t>(a);
+        double w = a - k0;
+        k0 %= _nsectors;
+        size_t k1 = (k0 + 1) % _nsectors;
+
+        const float* phi = &_phi[i * _nsectors];
+        return (1.0 - w) * phi[k0] + w * phi[k1];
+    }
+
+    /**
+     * True if the terrain around face i blocks a sun at this azimuth and elevation (both degrees)
+     */
+    bool shadowed(size_t i, double azimuth, double elevation) const
+    {
+        return horizon(i, azimuth) > elevation * M_PI / 180.0;
+    }
+
+    /**
+     * Checksum of the face centers this table was computed for, see load()
+     */
+    double checksum() const
+    {
+        return _checksum;
+    }
+
+    void set_checksum(double checksum)
+    {
+        _checksum = checksum;
+    }
+
+    size_t memory() const
+    {
+        return _phi.size() * sizeof(float);
+    }
+
+    /**
+     * Writes the table to a binary file. Throws file_write_error.
+     */
+    void save(const std::string& file) const;
+
+    /**
+     * Reads a table written by save(). Returns false, leaving the table untouched, if the file doesn't exist or was
+     * written for a different sector count, distances, number of faces or checksum.
+     */
+    bool load(const std::string& file);
+
+private:
+    size_t _nsectors;
+    std::vector<double> _distances;
+    double _checksum;
+    std::vector<float> _phi; // [face][sector]
+};
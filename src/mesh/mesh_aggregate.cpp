@@ -0,0 +1,248 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "mesh_aggregate.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "exception.hpp"
+
+mesh_aggregate::period mesh_aggregate::to_period(const std::string& name)
+{
+    if (name == "day" || name == "daily")
+        return period::day;
+    if (name == "month" || name == "monthly")
+        return period::month;
+
+    BOOST_THROW_EXCEPTION(config_error() << errstr_info("Unknown aggregation period " + name + ". Use day or month"));
+}
+
+mesh_aggregate::stat mesh_aggregate::to_stat(const std::string& name)
+{
+    if (name == "mean")
+        return stat::mean;
+    if (name == "min")
+        return stat::min;
+    if (name == "max")
+        return stat::max;
+    if (name == "sum")
+        return stat::sum;
+    if (name == "last")
+        return stat::last;
+
+    BOOST_THROW_EXCEPTION(config_error() << errstr_info("Unknown aggregation " + name + ". Use mean, min, max, sum or last"));
+}
+
+std::string mesh_aggregate::to_string(stat s)
+{
+    switch (s)
+    {
+        case stat::mean:
+            return "mean";
+        case stat::min:
+            return "minimum";
+        case stat::max:
+            return "maximum";
+        case stat::sum:
+            return "sum";
+        case stat::last:
+            return "point";
+    }
+    return "";
+}
+
+boost::posix_time::ptime mesh_aggregate::window_start(period p, const boost::posix_time::ptime& t)
+{
+    auto d = t.date();
+    if (p == period::month)
+        return boost::posix_time::ptime(boost::gregorian::date(d.year(), d.month(), 1));
+
+    return boost::posix_time::ptime(d);
+}
+
+mesh_aggregate::mesh_aggregate(mesh& domain, period p, const std::vector<std::string>& variables,
+                               const std::vector<stat>& stats)
+{
+    _init(domain->size_faces(), p, variables.empty() ? domain->face(0)->variables() : variables, stats);
+
+    for (auto& v : _variables)
+        _handles.push_back(domain->variable_handle(v));
+}
+
+mesh_aggregate::mesh_aggregate(size_t nfaces, period p, const std::vector<std::string>& variables,
+                               const std::vector<stat>& stats)
+{
+    _init(nfaces, p, variables, stats);
+}
+
+void mesh_aggregate::_init(size_t nfaces, period p, const std::vector<std::string>& variables,
+                           const std::vector<stat>& stats)
+{
+    _period = p;
+    _variables = variables;
+    _stats = stats;
+    _stats.resize(_variables.size(), stat::mean);
+
+    _nfaces = nfaces;
+    _acc.resize(_variables.size() * _nfaces);
+    _n.resize(_variables.size() * _nfaces);
+    _reset();
+}
+
+void mesh_aggregate::_reset()
+{
+    _count = 0;
+
+    for (size_t v = 0; v < _variables.size(); v++)
+    {
+        double init = 0;
+        if (_stats[v] == stat::min)
+            init = std::numeric_limits<double>::max();
+        else if (_stats[v] == stat::max)
+            init = std::numeric_limits<double>::lowest();
+
+        std::fill(_acc.begin() + v * _nfaces, _acc.begin() + (v + 1) * _nfaces, init);
+    }
+    std::fill(_n.begin(), _n.end(), 0);
+}
+
+void mesh_aggregate::_open(const boost::posix_time::ptime& t)
+{
+    if (_count > 0 && closed_by(t))
+        _reset();
+
+    if (_count == 0)
+        _start = window_start(_period, t);
+}
+
+template<typename Get>
+void mesh_aggregate::_accumulate(size_t v, Get get)
+{
+    const stat s = _stats[v];
+    double* acc = _acc.data() + v * _nfaces;
+    uint32_t* n = _n.data() + v * _nfaces;
+
+#pragma omp parallel for
+    for (size_t i = 0; i < _nfaces; i++)
+    {
+        double d = get(i);
+        if (d == -9999.)
+            continue;
+
+        switch (s)
+        {
+            case stat::mean:
+            case stat::sum:
+                acc[i] += d;
+                break;
+            case stat::min:
+                acc[i] = std::min(acc[i], d);
+                break;
+            case stat::max:
+                acc[i] = std::max(acc[i], d);
+                break;
+            case stat::last:
+                acc[i] = d;
+                break;
+        }
+        n[i]++;
+    }
+}
+
+void mesh_aggregate::add(mesh& domain, const boost::posix_time::ptime& t)
+{
+    _open(t);
+
+    for (size_t v = 0; v < _variables.size(); v++)
+    {
+        const auto& h = _handles[v];
+        _accumulate(v, [&](size_t i) { return (*domain->face(i))[h]; });
+    }
+
+    _count++;
+}
+
+void mesh_aggregate::add(const std::vector<double>& values, const boost::posix_time::ptime& t)
+{
+    if (values.size() != _acc.size())
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("mesh_aggregate: expected " + std::to_string(_acc.size()) +
+                                                               " values, got " + std::to_string(values.size())));
+
+    _open(t);
+
+    for (size_t v = 0; v < _variables.size(); v++)
+    {
+        const double* d = values.data() + v * _nfaces;
+        _accumulate(v, [&](size_t i) { return d[i]; });
+    }
+
+    _count++;
+}
+
+bool mesh_aggregate::closed_by(const boost::posix_time::ptime& t) const
+{
+    return window_start(_period, t) != _start;
+}
+
+std::vector<float> mesh_aggregate::result()
+{
+    std::vector<float> values(_acc.size());
+
+    for (size_t v = 0; v < _variables.size(); v++)
+    {
+        const bool mean = _stats[v] == stat::mean;
+        for (size_t i = v * _nfaces; i < (v + 1) * _nfaces; i++)
+        {
+            if (_n[i] == 0)
+                values[i] = -9999.f;
+            else
+                values[i] = static_cast<float>(mean ? _acc[i] / _n[i] : _acc[i]);
+        }
+    }
+
+    _reset();
+    return values;
+}
+
+boost::posix_time::ptime mesh_aggregate::start() const
+{
+    return _start;
+}
+
+size_t mesh_aggregate::count() const
+{
+    return _count;
+}
+
+const std::vector<std::string>& mesh_aggregate::variables() const
+{
+    return _variables;
+}
+
+const std::vector<mesh_aggregate::stat>& mesh_aggregate::stats() const
+{
+    return _stats;
+}
@@ -0,0 +1,154 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "triangulation.hpp"
+
+/**
+ * \class mesh_aggregate
+ * \brief Running per face reductions of mesh output variables over calendar days or months
+ *
+ * Every timestep is add()ed, and once the window is complete result() returns the reduced fields, packed the same way
+ * as mesh_nc_output::snapshot(), i.e., [variable][face]. Only those are written, instead of every timestep.
+ *
+ * Values of -9999 are treated as missing and skipped. A face with no valid values in the window is -9999.
+ */
+class mesh_aggregate
+{
+public:
+    enum class period
+    {
+        day,
+        month
+    };
+
+    enum class stat
+    {
+        mean,
+        min,
+        max,
+        sum,
+        last
+    };
+
+    /**
+     * "day"/"daily" or "month"/"monthly", throws config_error otherwise
+     */
+    static period to_period(const std::string& name);
+
+    /**
+     * "mean", "min", "max", "sum" or "last", throws config_error otherwise
+     */
+    static stat to_stat(const std::string& name);
+    static std::string to_string(stat s);
+
+    /**
+     * Start of the window that t falls in
+     */
+    static boost::posix_time::ptime window_start(period p, const boost::posix_time::ptime& t);
+
+    /**
+     * @param domain
+     * @param p
+     * @param variables Variables to reduce, empty for all of them
+     * @param stats One per variable
+     */
+    mesh_aggregate(mesh& domain, period p, const std::vector<std::string>& variables, const std::vector<stat>& stats);
+
+    /**
+     * Same as above, but not tied to a mesh. Values are given to add() directly.
+     * @param nfaces
+     * @param p
+     * @param variables Variables to reduce
+     * @param stats One per variable
+     */
+    mesh_aggregate(size_t nfaces, period p, const std::vector<std::string>& variables, const std::vector<stat>& stats);
+
+    /**
+     * Adds the current values of every face to the window t falls in. If t is in a later window than the one open,
+     * the open one is discarded, so call result() first.
+     * @param domain
+     * @param t
+     */
+    void add(mesh& domain, const boost::posix_time::ptime& t);
+
+    /**
+     * As above, with the values of every face packed [variable][face]
+     * @param values
+     * @param t
+     */
+    void add(const std::vector<double>& values, const boost::posix_time::ptime& t);
+
+    /**
+     * True if t is outside of the open window, i.e., the open window should be written before adding t
+     * @param t
+     */
+    bool closed_by(const boost::posix_time::ptime& t) const;
+
+    /**
+     * The reduced values of the open window, [variable][face], and starts a new window
+     * @return
+     */
+    std::vector<float> result();
+
+    /**
+     * Start of the open window
+     */
+    boost::posix_time::ptime start() const;
+
+    /**
+     * Number of timesteps added to the open window
+     */
+    size_t count() const;
+
+    const std::vector<std::string>& variables() const;
+    const std::vector<stat>& stats() const;
+
+private:
+    void _init(size_t nfaces, period p, const std::vector<std::string>& variables, const std::vector<stat>& stats);
+    void _reset();
+    void _open(const boost::posix_time::ptime& t);
+
+    template<typename Get>
+    void _accumulate(size_t v, Get get);
+
+    period _period;
+    std::vector<std::string> _variables;
+    std::vector<stat> _stats;
+    std::vector<var_handle> _handles;
+
+    size_t _nfaces;
+    boost::posix_time::ptime _start;
+    size_t _count;
+
+    std::vector<double> _acc;   // [variable][face]
+    std::vector<uint32_t> _n;   // number of valid values, [variable][face]
+};
@@ -0,0 +1,143 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "mesh_binary.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char magic[8] = {'C', 'H', 'M', 'M', 'E', 'S', 'H', '\0'};
+}
+
+bool mesh_binary::is_binary(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char buf[8] = {0};
+    in.read(buf, sizeof(buf));
+
+    return in.gcount() == sizeof(buf) && std::memcmp(buf, magic, sizeof(magic)) == 0;
+}
+
+mesh_binary::mesh_binary(const std::string& path)
+    : _path(path), _map(nullptr), _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1)
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Unable to open binary mesh " + path));
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || st.st_size < (off_t) sizeof(header))
+    {
+        close(fd);
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Binary mesh " + path + " is truncated"));
+    }
+    _size = st.st_size;
+
+    _map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping holds its own reference
+
+    if(_map == MAP_FAILED)
+    {
+        _map = nullptr;
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Unable to mmap binary mesh " + path));
+    }
+
+    // we read it front to back, once
+    madvise(_map, _size, MADV_SEQUENTIAL);
+
+    // the dtor won't run if we throw, so clean up the mapping ourselves
+    try
+    {
+        _hdr = reinterpret_cast<const header*>(_map);
+
+        if(std::memcmp(_hdr->magic, magic, sizeof(magic)) != 0)
+            BOOST_THROW_EXCEPTION(mesh_error() << errstr_info(path + " is not a binary CHM mesh"));
+
+        if(_hdr->version != version)
+            BOOST_THROW_EXCEPTION(mesh_error() << errstr_info(
+                    "Binary mesh " + path + " is version " + std::to_string(_hdr->version) +
+                    ", expected version " + std::to_string(version) + ". Please reconvert it with mesh2bin."));
+
+        const size_t ne = _hdr->nelem;
+
+        _vertex = reinterpret_cast<const double*>(_at(_hdr->vertex_offset, sizeof(double) * 3 * _hdr->nvertex));
+        _elem = reinterpret_cast<const int64_t*>(_at(_hdr->elem_offset, sizeof(int64_t) * 3 * ne));
+        _neigh = reinterpret_cast<const int64_t*>(_at(_hdr->neigh_offset, sizeof(int64_t) * 3 * ne));
+        _global_id = has_global_id() ? reinterpret_cast<const int64_t*>(_at(_hdr->global_id_offset, sizeof(int64_t) * ne))
+                                     : nullptr;
+
+        _param_names = _read_names(_hdr->param_names_offset, _hdr->nparam);
+        _param = reinterpret_cast<const double*>(_at(_hdr->param_offset, sizeof(double) * _hdr->nparam * ne));
+
+        _ic_names = _read_names(_hdr->ic_names_offset, _hdr->nic);
+        _ic = reinterpret_cast<const double*>(_at(_hdr->ic_offset, sizeof(double) * _hdr->nic * ne));
+    }
+    catch(...)
+    {
+        munmap(_map, _size);
+        _map = nullptr;
+        throw;
+    }
+}
+
+mesh_binary::~mesh_binary()
+{
+    if(_map)
+        munmap(_map, _size);
+}
+
+std::string mesh_binary::proj4() const
+{
+    return std::string(_at(_hdr->proj4_offset, _hdr->proj4_len), _hdr->proj4_len);
+}
+
+const char* mesh_binary::_at(uint64_t offset, uint64_t len) const
+{
+    if(offset % 8 != 0 || offset > _size || len > _size - offset)
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Binary mesh " + _path + " is corrupt or truncated"));
+
+    return static_cast<const char*>(_map) + offset;
+}
+
+std::vector<std::string> mesh_binary::_read_names(uint64_t offset, uint64_t n) const
+{
+    std::vector<std::string> names;
+    for(uint64_t i = 0; i < n; i++)
+    {
+        uint64_t len = *reinterpret_cast<const uint64_t*>(_at(offset, sizeof(uint64_t)));
+        offset += sizeof(uint64_t);
+
+        names.emplace_back(_at(offset, len), len);
+
+        // names are padded to keep the next entry aligned
+        offset += (len + 7) & ~uint64_t(7);
+    }
+    return names;
+}
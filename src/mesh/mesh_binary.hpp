@@ -0,0 +1,158 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "exception.hpp"
+
+/**
+ * \class mesh_binary
+ * \brief Read-only, memory mapped view of a binary CHM mesh
+ *
+ * The binary mesh holds the same information as the .mesh json and any number of .param/.ic json files, but as flat
+ * arrays so that it can be mmap'd and used to build the triangulation directly.
+ * tools/mesh2bin/mesh2bin.py converts the json files to this format.
+ *
+ * Layout (little endian). All offsets are in bytes from the start of the file and are 8 byte aligned.
+ * @code
+ *   header            see mesh_binary::header
+ *   proj4             char[proj4_len]
+ *   vertex            double[nvertex][3]          x, y, z
+ *   elem              int64[nelem][3]             vertex indexes, 0 indexed
+ *   neigh             int64[nelem][3]             neighbour face indexes, -1 = no neighbour
+ *   cell_global_id    int64[nelem]                only if has_global_id
+ *   param names       nparam x { uint64 len; char name[len]; pad to 8 }
+ *   param             double[nparam][nelem]       one contiguous column per parameter
+ *   ic names          nic x { uint64 len; char name[len]; pad to 8 }
+ *   ic                double[nic][nelem]
+ * @endcode
+ */
+class mesh_binary
+{
+public:
+
+    static const uint32_t version = 1;
+
+    struct header
+    {
+        char magic[8];          // "CHMMESH\0"
+        uint32_t version;
+        uint32_t is_geographic;
+        uint64_t nvertex;
+        uint64_t nelem;
+        uint64_t nparam;
+        uint64_t nic;
+        uint64_t has_global_id;
+
+        uint64_t proj4_offset;
+        uint64_t proj4_len;
+        uint64_t vertex_offset;
+        uint64_t elem_offset;
+        uint64_t neigh_offset;
+        uint64_t global_id_offset;
+        uint64_t param_names_offset;
+        uint64_t param_offset;
+        uint64_t ic_names_offset;
+        uint64_t ic_offset;
+    };
+
+    /**
+     * Maps the file. Throws mesh_error if the file can't be opened or isn't a supported binary mesh.
+     * @param path
+     */
+    mesh_binary(const std::string& path);
+    ~mesh_binary();
+
+    mesh_binary(const mesh_binary&) = delete;
+    mesh_binary& operator=(const mesh_binary&) = delete;
+
+    /**
+     * Checks the file's magic number without mapping the whole file
+     * @param path
+     * @return true if path is a binary mesh
+     */
+    static bool is_binary(const std::string& path);
+
+    size_t nvertex() const { return _hdr->nvertex; }
+    size_t nelem() const { return _hdr->nelem; }
+    bool is_geographic() const { return _hdr->is_geographic != 0; }
+    bool has_global_id() const { return _hdr->has_global_id != 0; }
+    std::string proj4() const;
+
+    /**
+     * Vertex i as x,y,z
+     */
+    const double* vertex(size_t i) const { return _vertex + 3 * i; }
+
+    /**
+     * The 3 vertex indexes of element i
+     */
+    const int64_t* elem(size_t i) const { return _elem + 3 * i; }
+
+    /**
+     * The 3 neighbour indexes of element i. -1 if no neighbour
+     */
+    const int64_t* neigh(size_t i) const { return _neigh + 3 * i; }
+
+    /**
+     * cell_global_id permutation, nullptr if not present
+     */
+    const int64_t* global_id() const { return _global_id; }
+
+    const std::vector<std::string>& parameters() const { return _param_names; }
+    const std::vector<std::string>& initial_conditions() const { return _ic_names; }
+
+    /**
+     * Column of nelem values for the ith parameter
+     */
+    const double* parameter(size_t i) const { return _param + i * nelem(); }
+
+    /**
+     * Column of nelem values for the ith initial condition
+     */
+    const double* initial_condition(size_t i) const { return _ic + i * nelem(); }
+
+private:
+    // returns a pointer to offset in the mapping, checking that len bytes are available
+    const char* _at(uint64_t offset, uint64_t len) const;
+    std::vector<std::string> _read_names(uint64_t offset, uint64_t n) const;
+
+    std::string _path;
+    void* _map;
+    size_t _size;
+
+    const header* _hdr;
+    const double* _vertex;
+    const int64_t* _elem;
+    const int64_t* _neigh;
+    const int64_t* _global_id;
+    const double* _param;
+    const double* _ic;
+
+    std::vector<std::string> _param_names;
+    std::vector<std::string> _ic_names;
+};
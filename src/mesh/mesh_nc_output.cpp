@@ -0,0 +1,268 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "mesh_nc_output.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include "timeseries/netcdf.hpp"
+
+namespace
+{
+    const float fill_value = -9999.f;
+}
+
+mesh_nc_output::mesh_nc_output(const std::string& file, mesh& domain, const std::vector<std::string>& variables,
+                               bool write_parameters, int deflate_level,
+                               const std::vector<std::string>& cell_methods)
+{
+    _deflate_level = std::max(0, std::min(9, deflate_level));
+    _nfaces = domain->size_faces();
+    _record = 0;
+    _buffer.resize(_nfaces);
+
+    _variables = variables.empty() ? domain->face(0)->variables() : variables;
+    for (auto& v : _variables)
+        _handles.push_back(domain->variable_handle(v));
+
+    // the forcing prefetch thread may be reading the forcing file
+    std::lock_guard<std::mutex> lock(netcdf::lib_mutex());
+
+    try
+    {
+        _file.open(file, netCDF::NcFile::replace, netCDF::NcFile::nc4);
+
+        const size_t nnodes = domain->size_vertex();
+        _face_dim = _file.addDim("face", _nfaces);
+        auto node_dim = _file.addDim("node", nnodes);
+        auto three_dim = _file.addDim("three", 3);
+        _time_dim = _file.addDim("time"); // unlimited
+
+        _file.putAtt("Conventions", "UGRID-1.0");
+        _file.putAtt("proj4", domain->proj4());
+        _file.putAtt("is_geographic", netCDF::ncInt, domain->is_geographic() ? 1 : 0);
+
+        // mesh topology, see the UGRID conventions
+        auto topo = _file.addVar("mesh", netCDF::ncInt);
+        topo.putAtt("cf_role", "mesh_topology");
+        topo.putAtt("topology_dimension", netCDF::ncInt, 2);
+        topo.putAtt("node_coordinates", "mesh_node_x mesh_node_y");
+        topo.putAtt("face_node_connectivity", "mesh_face_nodes");
+        topo.putAtt("face_dimension", "face");
+
+        const size_t node_chunk = std::max<size_t>(1, std::min<size_t>(nnodes, 65536));
+        const size_t face_chunk = std::max<size_t>(1, std::min<size_t>(_nfaces, 65536));
+
+        std::vector<double> nx(nnodes), ny(nnodes), nz(nnodes);
+        for (size_t i = 0; i < nnodes; i++)
+        {
+            auto v = domain->vertex(i);
+            nx[v->get_id()] = v->point().x();
+            ny[v->get_id()] = v->point().y();
+            nz[v->get_id()] = v->point().z();
+        }
+        auto x = _add_var(_file, "mesh_node_x", netCDF::ncDouble, {node_dim}, {node_chunk});
+        auto y = _add_var(_file, "mesh_node_y", netCDF::ncDouble, {node_dim}, {node_chunk});
+        auto z = _add_var(_file, "mesh_node_z", netCDF::ncDouble, {node_dim}, {node_chunk});
+        x.putAtt("standard_name", domain->is_geographic() ? "longitude" : "projection_x_coordinate");
+        y.putAtt("standard_name", domain->is_geographic() ? "latitude" : "projection_y_coordinate");
+        z.putAtt("units", "m");
+        x.putVar(nx.data());
+        y.putVar(ny.data());
+        z.putVar(nz.data());
+
+        std::vector<int> face_nodes(3 * _nfaces);
+        std::vector<unsigned long long> global_id(_nfaces);
+        for (size_t i = 0; i < _nfaces; i++)
+        {
+            auto f = domain->face(i);
+            for (int j = 0; j < 3; j++)
+                face_nodes[3 * i + j] = static_cast<int>(f->vertex(j)->get_id());
+            global_id[i] = f->cell_global_id;
+        }
+        auto fn = _add_var(_file, "mesh_face_nodes", netCDF::ncInt, {_face_dim, three_dim}, {face_chunk, 3});
+        fn.putAtt("cf_role", "face_node_connectivity");
+        fn.putAtt("start_index", netCDF::ncInt, 0);
+        fn.putVar(face_nodes.data());
+
+        auto gid = _add_var(_file, "face_global_id", netCDF::ncUint64, {_face_dim}, {face_chunk});
+        gid.putVar(global_id.data());
+
+        _time = _add_var(_file, "time", netCDF::ncInt64, {_time_dim}, {1024});
+        _time.putAtt("units", "seconds since 1970-01-01 00:00:00");
+        _time.putAtt("calendar", "standard");
+
+        for (size_t v = 0; v < _variables.size(); v++)
+        {
+            auto var = _add_var(_file, _variables[v], netCDF::ncFloat, {_time_dim, _face_dim}, {1, face_chunk});
+            var.putAtt("_FillValue", netCDF::ncFloat, fill_value);
+            var.putAtt("mesh", "mesh");
+            var.putAtt("location", "face");
+            if (v < cell_methods.size() && !cell_methods[v].empty())
+                var.putAtt("cell_methods", cell_methods[v]);
+            _nc_vars.push_back(var);
+        }
+
+        if (write_parameters)
+        {
+            auto params = _file.addGroup("parameters");
+            for (auto& p : domain->face(0)->parameters())
+            {
+                for (size_t i = 0; i < _nfaces; i++)
+                    _buffer[i] = static_cast<float>(domain->face(i)->parameter(p));
+                _write_face_var(params, p, _buffer);
+            }
+
+            // same derived terrain values the vtu has
+            for (size_t i = 0; i < _nfaces; i++)
+                _buffer[i] = static_cast<float>(domain->face(i)->get_z());
+            _write_face_var(params, "Elevation", _buffer);
+            for (size_t i = 0; i < _nfaces; i++)
+                _buffer[i] = static_cast<float>(domain->face(i)->slope());
+            _write_face_var(params, "Slope", _buffer);
+            for (size_t i = 0; i < _nfaces; i++)
+                _buffer[i] = static_cast<float>(domain->face(i)->aspect());
+            _write_face_var(params, "Aspect", _buffer);
+            for (size_t i = 0; i < _nfaces; i++)
+                _buffer[i] = static_cast<float>(domain->face(i)->get_area());
+            _write_face_var(params, "Area", _buffer);
+
+            auto ics = _file.addGroup("initial_conditions");
+            for (auto& ic : domain->face(0)->initial_conditions())
+            {
+                for (size_t i = 0; i < _nfaces; i++)
+                    _buffer[i] = static_cast<float>(domain->face(i)->get_initial_condition(ic));
+                _write_face_var(ics, ic, _buffer);
+            }
+        }
+
+        _file.sync();
+    }
+    catch (netCDF::exceptions::NcException& e)
+    {
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info("Unable to create mesh output " + file + ": " + e.what()));
+    }
+}
+
+mesh_nc_output::~mesh_nc_output()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // nothing to be done about it here, and a destructor mustn't throw
+    }
+}
+
+void mesh_nc_output::close()
+{
+    std::lock_guard<std::mutex> lock(netcdf::lib_mutex());
+    try
+    {
+        // a no-op if already closed
+        _file.close();
+    }
+    catch (netCDF::exceptions::NcException& e)
+    {
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info(std::string("Closing the mesh output failed: ") + e.what()));
+    }
+}
+
+netCDF::NcVar mesh_nc_output::_add_var(netCDF::NcGroup group, const std::string& name, netCDF::NcType type,
+                                       const std::vector<netCDF::NcDim>& dims, std::vector<size_t> chunk)
+{
+    auto var = group.addVar(name, type, dims);
+    var.setChunking(netCDF::NcVar::nc_CHUNKED, chunk);
+    if (_deflate_level > 0)
+        var.setCompression(true, true, _deflate_level);
+    return var;
+}
+
+void mesh_nc_output::_write_face_var(netCDF::NcGroup group, const std::string& name, const std::vector<float>& values)
+{
+    const size_t face_chunk = std::max<size_t>(1, std::min<size_t>(_nfaces, 65536));
+    auto var = _add_var(group, name, netCDF::ncFloat, {_face_dim}, {face_chunk});
+    var.putAtt("_FillValue", netCDF::ncFloat, fill_value);
+    var.putAtt("mesh", "mesh");
+    var.putAtt("location", "face");
+    var.putVar(values.data());
+}
+
+std::vector<float> mesh_nc_output::snapshot(mesh& domain)
+{
+    std::vector<float> values(_variables.size() * _nfaces);
+
+    for (size_t v = 0; v < _variables.size(); v++)
+    {
+        const auto& h = _handles[v];
+        float* out = values.data() + v * _nfaces;
+
+#pragma omp parallel for
+        for (size_t i = 0; i < _nfaces; i++)
+            out[i] = static_cast<float>((*domain->face(i))[h]);
+    }
+
+    return values;
+}
+
+void mesh_nc_output::write(const std::vector<float>& values, uint64_t time)
+{
+    if (values.size() != _variables.size() * _nfaces)
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info("Mesh output snapshot has the wrong size"));
+
+    std::vector<size_t> start(2), count(2);
+    start[0] = _record;
+    start[1] = 0;
+    count[0] = 1;
+    count[1] = _nfaces;
+
+    try
+    {
+        for (size_t v = 0; v < _variables.size(); v++)
+        {
+            // per variable so the forcing prefetch isn't held up for the whole record
+            std::lock_guard<std::mutex> lock(netcdf::lib_mutex());
+            _nc_vars[v].putVar(start, count, values.data() + v * _nfaces);
+        }
+
+        std::lock_guard<std::mutex> lock(netcdf::lib_mutex());
+        long long t = static_cast<long long>(time);
+        _time.putVar(std::vector<size_t>(1, _record), std::vector<size_t>(1, 1), &t);
+        _file.sync();
+    }
+    catch (netCDF::exceptions::NcException& e)
+    {
+        BOOST_THROW_EXCEPTION(file_write_error() << errstr_info(std::string("Writing the mesh output failed: ") + e.what()));
+    }
+
+    _record++;
+}
+
+size_t mesh_nc_output::records()
+{
+    return _record;
+}
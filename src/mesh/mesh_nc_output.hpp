@@ -0,0 +1,120 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <netcdf>
+
+#include "triangulation.hpp"
+
+/**
+ * \class mesh_nc_output
+ * \brief Time-stacked mesh output in a single compressed netCDF-4 file
+ *
+ * The alternative to writing one .vtu per output step. The geometry, and optionally the parameters and initial
+ * conditions, are written once when the file is created. Each output variable is then a [time, face] float variable
+ * that every write() appends a record to. The variables are chunked one record at a time and deflated.
+ *
+ * The layout follows the UGRID conventions (http://ugrid-conventions.github.io/ugrid-conventions/) so that the file can
+ * be opened directly by, e.g., xarray/uxarray or ParaView:
+ *  - mesh_node_x/y/z[node], mesh_face_nodes[face, 3] and the mesh topology variable
+ *  - time[time] in seconds since the epoch
+ *  - face_global_id[face], the cell_global_id, so the per-process files of an MPI run can be joined
+ *  - one [time, face] variable per output variable
+ *  - "parameters" and "initial_conditions" groups of [face] variables
+ */
+class mesh_nc_output
+{
+public:
+    /**
+     * Creates the file and writes the geometry
+     * @param file
+     * @param domain
+     * @param variables Variables to output, empty for all of them
+     * @param write_parameters Also write the parameters, initial conditions and the face elevation/slope/aspect/area
+     * @param deflate_level 0 (off) to 9
+     * @param cell_methods CF cell_methods attribute of each variable, e.g., "time: mean" for aggregated outputs. Empty
+     * to not set it
+     */
+    mesh_nc_output(const std::string& file, mesh& domain, const std::vector<std::string>& variables,
+                   bool write_parameters, int deflate_level,
+                   const std::vector<std::string>& cell_methods = std::vector<std::string>());
+
+    /**
+     * Closes the file if close() wasn't called
+     */
+    ~mesh_nc_output();
+
+    /**
+     * Flushes and closes the file. Takes netcdf::lib_mutex(), as the forcing prefetch may still be reading. No write()
+     * may be pending or follow.
+     */
+    void close();
+
+    /**
+     * Copies the current values of the output variables, variable by variable, for a later write()
+     * @param domain
+     * @return
+     */
+    std::vector<float> snapshot(mesh& domain);
+
+    /**
+     * Appends a snapshot as a new record. Doesn't touch the mesh, so it can run on another thread while the model
+     * carries on. Calls must be in time order and not concurrent with each other.
+     * @param values From snapshot()
+     * @param time Seconds since the epoch
+     */
+    void write(const std::vector<float>& values, uint64_t time);
+
+    /**
+     * Number of records written so far
+     */
+    size_t records();
+
+private:
+    // a chunked and, if _deflate_level > 0, compressed variable
+    netCDF::NcVar _add_var(netCDF::NcGroup group, const std::string& name, netCDF::NcType type,
+                           const std::vector<netCDF::NcDim>& dims, std::vector<size_t> chunk);
+
+    // writes a [face] variable of per face values
+    void _write_face_var(netCDF::NcGroup group, const std::string& name, const std::vector<float>& values);
+
+    netCDF::NcFile _file;
+    netCDF::NcDim _time_dim;
+    netCDF::NcDim _face_dim;
+    netCDF::NcVar _time;
+
+    std::vector<std::string> _variables;
+    std::vector<var_handle> _handles;
+    std::vector<netCDF::NcVar> _nc_vars;
+
+    int _deflate_level;
+    size_t _nfaces;
+    size_t _record;
+    std::vector<float> _buffer; // geometry and parameters
+};
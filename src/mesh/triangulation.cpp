@@ -16,8 +16,11 @@
 
 
 #include "triangulation.hpp"
+#include "mesh_binary.hpp"
+#include "face_order.hpp"
 
 triangulation::triangulation()
+    : _variable_store("Variable"), _parameter_store("Parameter"), _face_order("none")
 {
  //   LOG_WARNING << "No Matlab engine, plotting and all Matlab functionality will be disabled";
 #ifdef MATLAB
@@ -42,6 +45,7 @@ triangulation::triangulation()
 #ifdef MATLAB
 
 triangulation::triangulation(boost::shared_ptr<maw::matlab_engine> engine)
+    : _variable_store("Variable"), _parameter_store("Parameter"), _face_order("none")
 {
     _engine = engine;
     _gfx = boost::make_shared<maw::graphics>(_engine.get());
@@ -115,39 +119,52 @@ mesh_elem triangulation::locate_face(double x, double y)
 
 mesh_elem triangulation::locate_face(Point_2 query)
 {
-    // In some limited cases triangles can be arranged in a circle around a central vertex
-    // In this case, there could be 360/21.5 = 16 and change triangles.
-    // So just grab the nearest 17 triangles, one of these will hold the point we need
-    K_neighbor_search search(*dD_tree, query, 17);
+    return _locator.locate(query.x(), query.y(), [this](size_t i) { return _face(i); });
+}
+
+std::vector<mesh_elem> triangulation::locate_faces(const std::vector<Point_2>& points)
+{
+    std::vector<mesh_elem> faces(points.size(), nullptr);
 
-    //check if the closest is what we wanted
-    for(auto itr: search)
+#pragma omp parallel
     {
-      auto f = boost::get<1>(itr.first); //grab the triangle from the iterator
-      if(!f->_is_ghost &&
-          f->contains(query.x(),query.y()))
-        return boost::get<1>(itr.first);
-    }
+        mesh_elem last = nullptr;
 
+#pragma omp for schedule(static)
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            // remember the last hit, falling back to the full search if the walk from it fails
+            mesh_elem f = last ? walk_to(last, points[i].x(), points[i].y()) : nullptr;
+            if (!f)
+                f = locate_face(points[i]);
+
+            faces[i] = f;
+            if (f)
+                last = f;
+        }
+    }
 
-    //we tried....
-    return nullptr;
+    return faces;
 }
 
-
-std::vector<mesh_elem > triangulation::find_faces_in_radius(Point_2 center, double radius) const
+std::vector<mesh_elem> triangulation::find_closest_faces(const std::vector<Point_2>& points) const
 {
-    // define exact circular range query  (fuzziness=0)
-    Fuzzy_circle exact_range(center, radius);
+    std::vector<mesh_elem> faces(points.size());
 
-    std::vector<boost::tuple<K::Point_2, mesh_elem > > result;
-    dD_tree->search(std::back_inserter(result), exact_range);
+#pragma omp parallel for
+    for (size_t i = 0; i < points.size(); i++)
+        faces[i] = find_closest_face(points[i]);
+
+    return faces;
+}
 
+std::vector<mesh_elem > triangulation::find_faces_in_radius(Point_2 center, double radius) const
+{
     std::vector< mesh_elem > faces;
 
-    for (auto& itr : result)
+    for (auto i : _locator.in_radius(center.x(), center.y(), radius))
     {
-        faces.push_back( boost::get<1>(itr));
+        faces.push_back(_face(i));
     }
     return faces;
 }
@@ -163,13 +180,114 @@ std::vector< mesh_elem > triangulation::find_faces_in_radius(double x, double y,
 
 mesh_elem triangulation::find_closest_face(Point_2 query) const
 {
-    K_neighbor_search search(*dD_tree, query, 1);
+    return _face(_locator.closest(query.x(), query.y()));
+}
+boost::shared_ptr<const face_stencil> triangulation::directional_stencil(size_t azimuths,
+                                                                        const std::vector<double>& distances)
+{
+    if (azimuths == 0)
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("A directional stencil needs at least one azimuth"));
+
+    std::lock_guard<std::mutex> lock(_stencil_mutex);
+
+    for (auto& w : _stencils)
+    {
+        auto s = w.lock();
+        if (s && s->azimuths() == azimuths && s->distances() == distances)
+            return s;
+    }
+
+    auto stencil = boost::make_shared<face_stencil>(this->size_faces(), azimuths, distances);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < this->size_faces(); i++)
+    {
+        auto face = this->face(i);
+        Point_3 me = face->center();
+        for (size_t k = 0; k < azimuths; k++)
+        {
+            uint32_t* ray = stencil->ray(i, k);
+            for (size_t j = 0; j < distances.size(); j++)
+            {
+                auto f = find_closest_face(math::gis::point_from_bearing(me, stencil->azimuth(k), distances[j]));
+                ray[j] = static_cast<uint32_t>(f->cell_local_id);
+            }
+        }
+    }
+
+    LOG_DEBUG << "Built a directional stencil of " << azimuths << " azimuths x " << distances.size() << " steps, "
+              << stencil->memory() / (1024 * 1024) << " MB";
+
+    // drop the ones nobody holds anymore
+    _stencils.erase(std::remove_if(_stencils.begin(), _stencils.end(),
+                                   [](const boost::weak_ptr<const face_stencil>& w) { return w.expired(); }),
+                    _stencils.end());
+    _stencils.push_back(stencil);
+
+    return stencil;
+}
+
+boost::shared_ptr<const horizon_table> triangulation::horizon_angles(size_t sectors,
+                                                                    const std::vector<double>& distances,
+                                                                    std::string file)
+{
+    auto table = boost::make_shared<horizon_table>(this->size_faces(), sectors, distances);
+
+    // cheap guard against reusing a file written for another mesh or a deformed one
+    double checksum = 0;
+    for (size_t i = 0; i < this->size_faces(); i++)
+    {
+        auto c = this->face(i)->center();
+        checksum += c.x() + c.y() + c.z();
+    }
+    table->set_checksum(checksum);
+
+    if (!file.empty())
+    {
+#ifdef USE_MPI
+        file += "." + std::to_string(_comm_world.rank());
+#endif
+        if (table->load(file))
+        {
+            LOG_DEBUG << "Loaded the horizon table from " << file;
+            return table;
+        }
+    }
+
+    auto stencil = directional_stencil(sectors, distances);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < this->size_faces(); i++)
+    {
+        auto face = this->face(i);
+        Point_3 me = face->center();
+        for (size_t k = 0; k < sectors; k++)
+        {
+            const uint32_t* ray = stencil->ray(i, k);
+            double phi = 0.;
+            for (size_t j = 0; j < distances.size(); j++)
+            {
+                auto f = this->face(ray[j]);
+                double z_diff = f->center().z() - me.z();
+                if (z_diff > 0)
+                {
+                    double dist = math::gis::distance(f->center(), me);
+                    phi = std::max(atan(z_diff / dist), phi);
+                }
+            }
+            table->at(i, k) = static_cast<float>(phi);
+        }
+    }
 
-    //return the first face only
-    auto it = search.begin();
-    return  boost::get<1>(it->first);
+    LOG_DEBUG << "Built a horizon table of " << sectors << " sectors x " << distances.size() << " steps, "
+              << table->memory() / (1024 * 1024) << " MB";
 
+    if (!file.empty())
+        table->save(file);
+
+    return table;
 }
+
 mesh_elem triangulation::find_closest_face(double x, double y) const
 {
 
@@ -284,11 +402,6 @@ void triangulation::from_json(pt::ptree &mesh)
     this->set_dimension(2);
 
 
-    //vectors to hold the center of a face to generate the spatial search tree
-    std::vector<Point_2> center_points;
-
-    i = 0;
-    size_t cid = 0;
     for (auto &itr : mesh.get_child("mesh.elem"))
     {
         std::vector<int> items;
@@ -301,45 +414,9 @@ void triangulation::from_json(pt::ptree &mesh)
         auto vert2 = _vertexes.at(items[1]);
         auto vert3 = _vertexes.at(items[2]);
 
-        auto face = this->create_face(vert1,vert2,vert3);
-        face->cell_global_id = cid++;
-        face->cell_local_id = face->cell_global_id;
-        
-        if( is_geographic == 1)
-        {
-            face->_is_geographic = true;
-        }
-        face->_debug_ID= --i; //all ids will be negative starting at -1. Named ids (for output) will be positive starting at 0
-        face->_debug_name= std::to_string(i);
-        face->_domain = this;
-
-        vert1->set_face(face);
-        vert2->set_face(face);
-        vert3->set_face(face);
-
-
-        _faces.push_back(face);
-
-// If we aren't using MPI, we can build the centre points here for efficiency.
-// these centre points will be used to build the spatial search tree. If we are using MPI,
-// we need to wait until we've figured out the per-node triangle partition so we can build
-// a per-node spatial search tree that only takes into account this node's elements.
-// If MPI, we do that at the end of this function
-
-#ifndef USE_MPI
-        Point_2 pt2(face->center().x(),face->center().y());
-        center_points.push_back(pt2);
-#endif
-
+        _add_face(vert1,vert2,vert3);
     }
 
-#ifndef USE_MPI
-    //make the search tree
-    dD_tree = boost::make_shared<Tree>(boost::make_zip_iterator(boost::make_tuple( center_points.begin(),_faces.begin() )),
-                                       boost::make_zip_iterator(boost::make_tuple( center_points.end(), _faces.end() ) )
-    );
-#endif
-
     _num_faces = this->number_of_faces();
 
     LOG_DEBUG << "Created a mesh with " << this->size_faces() << " triangles";
@@ -380,9 +457,284 @@ void triangulation::from_json(pt::ptree &mesh)
 
         i++;
     }
-    //loop over parameter name
+    _load_parameters(mesh);
+    _load_initial_conditions(mesh);
+
+    // Permute the faces if they have explicit IDs set in the mesh file
+    std::vector<size_t> permutation;
+    try
+    {
+      for (auto itr : mesh.get_child("mesh.cell_global_id"))
+      {
+	    permutation.push_back(itr.second.get_value<size_t>());
+      }
+    }catch(pt::ptree_bad_path& e)
+    {
+        // If not, just ignore the exception
+        LOG_DEBUG << "No face permutation.";
+    }
+
+    _finalize_mesh(permutation);
+}
+
+void triangulation::_finalize_mesh(const std::vector<size_t>& permutation)
+{
+    _num_faces = this->number_of_faces();
+    _num_vertex = this->number_of_vertices();
+
+    if(_face_order != "none")
+    {
+        if(!permutation.empty())
+            LOG_WARNING << "The mesh has a cell_global_id permutation. It is replaced by the " << _face_order << " face order";
+
+        // the faces haven't been permuted yet, so cell_global_id is the position in _faces
+        std::vector<double> x(_faces.size()), y(_faces.size());
+        std::vector<size_t> neighbours(3 * _faces.size(), face_order::no_neighbour);
+
+#pragma omp parallel for
+        for(size_t i = 0; i < _faces.size(); i++)
+        {
+            auto c = _faces[i]->center();
+            x[i] = c.x();
+            y[i] = c.y();
+            for(size_t j = 0; j < 3; j++)
+            {
+                auto neigh = _faces[i]->neighbor(j);
+                if(neigh != nullptr)
+                    neighbours[3 * i + j] = neigh->cell_global_id;
+            }
+        }
+
+        LOG_DEBUG << "Computing the " << _face_order << " face order";
+        reorder_faces(face_order::compute(_face_order, x, y, neighbours));
+    }
+    else if(!permutation.empty())
+    {
+        reorder_faces(permutation);
+    }
 
+    partition_mesh();
+
+// If we aren't using MPI, the locator holds all the faces. If we are using MPI,
+// we need to wait until we've figured out the per-node triangle partition so we can build
+// a per-node locator that only takes into account this node's elements.
+#ifdef USE_MPI
+    _num_faces = _local_faces.size();
+    determine_local_boundary_faces();
+    build_halo();
+#endif // USE_MPI
+
+    //centers of the faces, plus how far a face reaches from its center, for the locator
+    std::vector<double> center_points(2 * _num_faces);
+    double extent = 0;
+
+#pragma omp parallel for reduction(max:extent)
+    for(size_t ii=0; ii < _num_faces; ++ii)
+    {
+        auto face = _face(ii);
+        center_points[2 * ii] = face->center().x();
+        center_points[2 * ii + 1] = face->center().y();
+
+        for (int v = 0; v < 3; v++)
+        {
+            double dx = face->vertex(v)->point().x() - center_points[2 * ii];
+            double dy = face->vertex(v)->point().y() - center_points[2 * ii + 1];
+            extent = std::max(extent, std::sqrt(dx * dx + dy * dy));
+        }
+    }
+
+    _locator = face_locator(center_points, extent);
+    LOG_DEBUG << "Face locator is " << _locator.memory() / (1024 * 1024) << " MB";
+
+
+  std::vector<double> temp_slope(_num_faces);
+
+#pragma omp parallel for
+  for (size_t i = 0; i < _num_faces; i++)
+  {
+
+    auto f = face(i);
+    std::vector<boost::tuple<double, double, double> > u;
+    for (size_t j = 0; j < 3; j++)
+    {
+      auto neigh = f->neighbor(j);
+      if (neigh != nullptr && !neigh->_is_ghost)
+        u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), neigh->slope()));
+    }
+
+    auto query = boost::make_tuple(f->get_x(), f->get_y(), f->get_z());
+
+    interpolation interp(interp_alg::tpspline);
+    double new_slope = f->slope();
+
+    if(u.size() > 0)
+    {
+      new_slope = interp(u, query);
+    }
+
+    temp_slope.at(i) = new_slope;
+  }
+
+#pragma omp parallel for
+  for (size_t i = 0; i < size_faces(); i++)
+  {
+    auto f = face(i);
+    f->_slope = temp_slope.at(i);
+    //init these
+    f->aspect();
+    f->center();
+    f->normal();
+  }
+
+
+}
+
+void triangulation::from_binary(const std::string& path, pt::ptree& extra)
+{
+    LOG_DEBUG << "Mapping binary mesh " << path;
+    mesh_binary bin(path);
+
+    _is_geographic = bin.is_geographic();
+    _srs_wkt = bin.proj4();
+
+    if(_srs_wkt == "")
+    {
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("proj4 field in binary mesh is empty!"));
+    }
+
+    LOG_DEBUG << "Reading in #vertex=" << bin.nvertex();
+    _vertexes.reserve(bin.nvertex());
+    for (size_t i = 0; i < bin.nvertex(); i++)
+    {
+        const double* v = bin.vertex(i);
+        Point_3 pt( v[0], v[1], v[2]);
+
+        _max_z = std::max(_max_z,v[2]);
+        _min_z = std::min(_min_z,v[2]);
+
+        Vertex_handle Vh = this->create_vertex();
+        Vh->set_point(pt);
+        Vh->set_id(i);
+        _vertexes.push_back(Vh);
+    }
+    _num_vertex = this->number_of_vertices();
+
+    LOG_DEBUG << "Reading in #elem = " << bin.nelem();
+    this->set_dimension(2);
+
+    _faces.reserve(bin.nelem());
+    for (size_t i = 0; i < bin.nelem(); i++)
+    {
+        const int64_t* e = bin.elem(i);
+        for (int j = 0; j < 3; j++)
+        {
+            if (e[j] < 0 || (size_t)e[j] >= bin.nvertex())
+                BOOST_THROW_EXCEPTION(config_error() << errstr_info(
+                        "Face " + std::to_string(i) + " has out of bound vertexes."));
+        }
+
+        _add_face(_vertexes[e[0]], _vertexes[e[1]], _vertexes[e[2]]);
+    }
+    _num_faces = this->number_of_faces();
+    LOG_DEBUG << "Created a mesh with " << this->size_faces() << " triangles";
+
+    LOG_DEBUG << "Building face neighbours";
+    for (size_t i = 0; i < bin.nelem(); i++)
+    {
+        const int64_t* n = bin.neigh(i);
+        Face_handle neigh[3];
+        for (int j = 0; j < 3; j++)
+        {
+            //-1 is the no neighbour value
+            if (n[j] < -1 || n[j] >= (int64_t) bin.nelem())
+                BOOST_THROW_EXCEPTION(config_error() << errstr_info(
+                        "Face " + std::to_string(i) + " has out of bound neighbours."));
+
+            neigh[j] = n[j] != -1 ? _faces[n[j]] : nullptr;
+        }
+        _faces[i]->set_neighbors(neigh[0], neigh[1], neigh[2]);
+    }
+
+    // Parameters given in json files override those of the same name in the binary mesh
+    std::set<std::string> json_params;
+    if (auto json = extra.get_child_optional("parameters"))
+    {
+        for (auto &itr : *json)
+        {
+            json_params.insert(itr.first.data());
+        }
+    }
+
+    for (auto& name : bin.parameters())
+        _parameters.insert(name);
+
+    // this also builds the storage for all of the parameters
+    _load_parameters(extra);
+
+    for (size_t p = 0; p < bin.parameters().size(); p++)
+    {
+        auto& name = bin.parameters()[p];
+        if (json_params.find(name) != json_params.end())
+            continue;
+
+        LOG_DEBUG << "Applying parameter: " << name;
+
+        // the faces haven't been permuted yet, so cell_local_id is the position in the file
+        const double* col = bin.parameter(p);
+        std::copy(col, col + bin.nelem(), _parameter_store.column(name));
+    }
+
+    for (size_t ic = 0; ic < bin.initial_conditions().size(); ic++)
+    {
+        auto& name = bin.initial_conditions()[ic];
+        LOG_DEBUG << "Applying IC: " << name;
 
+        const double* col = bin.initial_condition(ic);
+        for (size_t i = 0; i < bin.nelem(); i++)
+        {
+            _faces[i]->set_initial_condition(name, col[i]);
+        }
+    }
+    _load_initial_conditions(extra);
+
+    std::vector<size_t> permutation;
+    if(bin.has_global_id())
+    {
+        permutation.assign(bin.global_id(), bin.global_id() + bin.nelem());
+    }
+    else
+    {
+        LOG_DEBUG << "No face permutation.";
+    }
+
+    _finalize_mesh(permutation);
+}
+
+mesh_elem triangulation::_add_face(Vertex_handle vert1, Vertex_handle vert2, Vertex_handle vert3)
+{
+    auto face = this->create_face(vert1,vert2,vert3);
+    face->cell_global_id = _faces.size();
+    face->cell_local_id = face->cell_global_id;
+
+    face->_is_geographic = _is_geographic;
+
+    //all ids will be negative starting at -1. Named ids (for output) will be positive starting at 0
+    face->_debug_ID = -static_cast<int>(_faces.size() + 1);
+    face->_debug_name = std::to_string(face->_debug_ID);
+    face->_domain = this;
+
+    vert1->set_face(face);
+    vert2->set_face(face);
+    vert3->set_face(face);
+
+    _faces.push_back(face);
+
+    return face;
+}
+
+void triangulation::_load_parameters(pt::ptree& mesh)
+{
+    size_t i = 0;
     try
     {
         // build up the entire list of parameters so we can use this to init the per-face parameter
@@ -415,13 +767,7 @@ void triangulation::from_json(pt::ptree &mesh)
         }
 
         // init the storage, which builds the mphf
-#pragma omp parallel for
-        for (size_t i = 0; i < size_faces(); i++)
-        {
-
-		   _faces.at(i)->init_parameters(_parameters);
-
-        }
+        init_parameters(_parameters);
 
 
         for (auto &itr : mesh.get_child("parameters"))
@@ -447,16 +793,15 @@ void triangulation::from_json(pt::ptree &mesh)
         // we don't have this section, no worries
         // but we still need to build up the face storage as we may have parameters from a module
         // init the storage, which builds the mphf
-#pragma omp parallel for
-        for (size_t i = 0; i < size_faces(); i++)
-        {
-
-            _faces.at(i)->init_parameters(_parameters);
-
-        }
+        init_parameters(_parameters);
 
     }
 
+}
+
+void triangulation::_load_initial_conditions(pt::ptree& mesh)
+{
+    size_t i = 0;
     std::set<std::string> ics;
     try
     {
@@ -480,86 +825,6 @@ void triangulation::from_json(pt::ptree &mesh)
     {
         // we don't have this section, no worries
     }
-    _num_faces = this->number_of_faces();
-    _num_vertex = this->number_of_vertices();
-
-    // Permute the faces if they have explicit IDs set in the mesh file
-    try
-    {
-      std::vector<size_t> permutation;
-      for (auto itr : mesh.get_child("mesh.cell_global_id"))
-      {
-	    permutation.push_back(itr.second.get_value<size_t>());
-      }
-      reorder_faces(permutation);
-
-    }catch(pt::ptree_bad_path& e)
-    {
-        // If not, just ignore the exception
-        LOG_DEBUG << "No face permutation.";
-    }
-
-    partition_mesh();
-#ifdef USE_MPI
-    _num_faces = _local_faces.size();
-    determine_local_boundary_faces();
-
-    // should make this parallel
-    for(size_t ii=0; ii < _num_faces; ++ii)
-    {
-        auto face = _local_faces.at(ii);
-        Point_2 pt2(face->center().x(),face->center().y());
-        center_points.push_back(pt2);
-
-    }
-    //make the search tree
-    dD_tree = boost::make_shared<Tree>(boost::make_zip_iterator(boost::make_tuple( center_points.begin(),_local_faces.begin() )),
-                                       boost::make_zip_iterator(boost::make_tuple( center_points.end(),  _local_faces.end() ) )
-    );
-
-#endif // USE_MPI
-
-
-  std::vector<double> temp_slope(_num_faces);
-
-#pragma omp parallel for
-  for (size_t i = 0; i < _num_faces; i++)
-  {
-
-    auto f = face(i);
-    std::vector<boost::tuple<double, double, double> > u;
-    for (size_t j = 0; j < 3; j++)
-    {
-      auto neigh = f->neighbor(j);
-      if (neigh != nullptr && !neigh->_is_ghost)
-        u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(), neigh->slope()));
-    }
-
-    auto query = boost::make_tuple(f->get_x(), f->get_y(), f->get_z());
-
-    interpolation interp(interp_alg::tpspline);
-    double new_slope = f->slope();
-
-    if(u.size() > 0)
-    {
-      new_slope = interp(u, query);
-    }
-
-    temp_slope.at(i) = new_slope;
-  }
-
-#pragma omp parallel for
-  for (size_t i = 0; i < size_faces(); i++)
-  {
-    auto f = face(i);
-    f->_slope = temp_slope.at(i);
-    //init these
-    f->aspect();
-    f->center();
-    f->normal();
-  }
-
-
 }
 
 void triangulation::reorder_faces(std::vector<size_t> permutation)
@@ -575,6 +840,10 @@ void triangulation::reorder_faces(std::vector<size_t> permutation)
 
 
   // Update the IDs on all faces
+  // The local ids follow the global ids so that the variable_store columns remain in face order.
+  // The parameters have already been loaded at the old local ids, so they need to be moved too.
+  std::vector<size_t> new_local_id(_faces.size());
+
   #pragma omp parallel for
   for (size_t ind = 0; ind < permutation.size(); ++ind)
   {
@@ -585,8 +854,13 @@ void triangulation::reorder_faces(std::vector<size_t> permutation)
 	     auto face = _faces.at(old_ID);
 	     face->cell_global_id = new_ID;
 
+	     new_local_id.at(face->cell_local_id) = new_ID;
+	     face->cell_local_id = new_ID;
+
   }
 
+  _parameter_store.permute(new_local_id);
+
   // Sort the faces in the new ordering
   tbb::parallel_sort(_faces.begin(), _faces.end(),
   		     [](triangulation::Face_handle fa, triangulation::Face_handle fb)->bool
@@ -595,6 +869,14 @@ void triangulation::reorder_faces(std::vector<size_t> permutation)
   		     });
 }
 
+void triangulation::set_face_order(const std::string& method)
+{
+    if(method != "none" && method != "hilbert" && method != "morton" && method != "rcb" && method != "graph")
+        BOOST_THROW_EXCEPTION(config_error() << errstr_info("Unknown face_order " + method +
+                                                            ". Use one of none, hilbert, morton, rcb, graph"));
+    _face_order = method;
+}
+
 void triangulation::partition_mesh()
 {
   /*
@@ -628,20 +910,43 @@ void triangulation::partition_mesh()
   }
 
 
+  _partition_start.assign(_comm_world.size() + 1, 0);
+  for (int i=0;i<_comm_world.size();++i) {
+    _partition_start[i+1] = _partition_start[i] + num_faces_in_partition[i];
+  }
+
   // Set size of vector containing locally owned faces
   _local_faces.resize(num_faces_in_partition[_comm_world.rank()]);
 
+  // Local faces are numbered 0..n_local-1 and the ghost faces follow them. This keeps every face's slot in the
+  // variable_store unique and has this process' faces contiguous at the start of each column.
+  std::vector<size_t> new_local_id(_faces.size());
+
 #pragma omp parallel for
   for(int local_ind=0;local_ind<_local_faces.size();++local_ind)
   {
 
 	     size_t global_ind = face_start_idx + local_ind;
 	     _faces.at(global_ind)->_is_ghost = false;
+	     new_local_id.at(_faces.at(global_ind)->cell_local_id) = local_ind;
 	     _faces.at(global_ind)->cell_local_id = local_ind;
 	     _local_faces[local_ind] = _faces.at(global_ind);
 
   }
 
+  size_t ghost_ind = _local_faces.size();
+  for(size_t i = 0; i < total_num_faces; ++i)
+  {
+      if(i >= face_start_idx && i <= face_end_idx)
+          continue;
+
+      new_local_id.at(_faces.at(i)->cell_local_id) = ghost_ind;
+      _faces.at(i)->cell_local_id = ghost_ind;
+      ++ghost_ind;
+  }
+
+  _parameter_store.permute(new_local_id);
+
 
   LOG_DEBUG << "MPI Process " << _comm_world.rank() << ": start " << face_start_idx << ", end " << face_end_idx << ", number " << _local_faces.size();
 
@@ -658,6 +963,27 @@ void triangulation::partition_mesh()
 
 }
 
+void triangulation::init_time_series(std::set<std::string>& variables)
+{
+    // ghost faces are included so that neighbour lookups into them are valid
+    _variable_store.init(variables, _faces.size());
+}
+
+void triangulation::init_parameters(std::set<std::string>& parameters)
+{
+    _parameter_store.init(parameters, _faces.size());
+}
+
+var_handle triangulation::variable_handle(const std::string& variable)
+{
+    return _variable_store.handle(variable);
+}
+
+var_handle triangulation::parameter_handle(const std::string& parameter)
+{
+    return _parameter_store.handle(parameter);
+}
+
 void triangulation::determine_local_boundary_faces()
 {
   /*
@@ -722,6 +1048,104 @@ void triangulation::determine_local_boundary_faces()
 #endif
 }
 
+void triangulation::build_halo()
+{
+  /*
+    Adjacency is symmetric, so the ghost faces we receive from process p are exactly the faces p sends us:
+    p's faces that share an edge with one of ours. Both sides sort by cell_global_id, so no communication is
+    needed to agree on the order.
+  */
+#ifdef USE_MPI
+  _halo.clear();
+
+  std::map<int, std::vector<size_t> > send_ids, recv_ids;
+  for (auto& itr : _boundary_faces)
+  {
+    auto face = itr.first;
+    for (int neigh_index = 0; neigh_index < 3; ++neigh_index)
+    {
+      auto neigh = face->neighbor(neigh_index);
+      if (neigh == nullptr || !neigh->_is_ghost)
+        continue;
+
+      // the partition is contiguous in cell_global_id
+      int owner = std::upper_bound(_partition_start.begin(), _partition_start.end(), neigh->cell_global_id)
+                  - _partition_start.begin() - 1;
+
+      send_ids[owner].push_back(face->cell_global_id);
+      recv_ids[owner].push_back(neigh->cell_global_id);
+    }
+  }
+
+  size_t nghost = 0;
+  for (auto& itr : recv_ids)
+  {
+    halo_partner p;
+    p.rank = itr.first;
+
+    auto& send = send_ids[itr.first];
+    auto& recv = itr.second;
+    std::sort(send.begin(), send.end());
+    send.erase(std::unique(send.begin(), send.end()), send.end());
+    std::sort(recv.begin(), recv.end());
+    recv.erase(std::unique(recv.begin(), recv.end()), recv.end());
+
+    for (auto id : send)
+      p.send_cells.push_back(_faces.at(id)->cell_local_id);
+    for (auto id : recv)
+      p.recv_cells.push_back(_faces.at(id)->cell_local_id);
+
+    nghost += p.recv_cells.size();
+    _halo.push_back(p);
+  }
+
+  LOG_DEBUG << "MPI Process " << _comm_world.rank() << " exchanges a halo of " << nghost << " faces with " << _halo.size() << " processes.";
+#endif
+}
+
+void triangulation::exchange_halo(const std::vector<var_handle>& variables)
+{
+#ifdef USE_MPI
+  if (variables.empty() || _halo.empty())
+    return;
+
+  const int tag = 0; // the exchanges happen in the same order everywhere, and MPI doesn't reorder messages
+  const size_t nvar = variables.size();
+
+  std::vector<boost::mpi::request> requests;
+  requests.reserve(2 * _halo.size());
+
+  // post all the receives first so the sends can complete straight away
+  for (auto& p : _halo)
+  {
+    p.recv_buffer.resize(nvar * p.recv_cells.size());
+    requests.push_back(_comm_world.irecv(p.rank, tag, p.recv_buffer.data(), static_cast<int>(p.recv_buffer.size())));
+  }
+
+  for (auto& p : _halo)
+  {
+    p.send_buffer.resize(nvar * p.send_cells.size());
+
+    size_t k = 0;
+    for (auto& v : variables)
+      for (auto cell : p.send_cells)
+        p.send_buffer[k++] = _variable_store(v, cell);
+
+    requests.push_back(_comm_world.isend(p.rank, tag, p.send_buffer.data(), static_cast<int>(p.send_buffer.size())));
+  }
+
+  boost::mpi::wait_all(requests.begin(), requests.end());
+
+  for (auto& p : _halo)
+  {
+    size_t k = 0;
+    for (auto& v : variables)
+      for (auto cell : p.recv_cells)
+        _variable_store(v, cell) = p.recv_buffer[k++];
+  }
+#endif
+}
+
 Delaunay::Vertex_handle triangulation::vertex(size_t i)
 {
     return _vertexes.at(i);
@@ -920,32 +1344,39 @@ void triangulation::update_vtk_data(std::vector<std::string> output_variables)
     auto ics = this->face(0)->initial_conditions();
     auto vecs = this->face(0)->vectors();
 
-    for (size_t i = 0; i < this->size_faces(); i++)
+    // face(i) has cell_local_id = i, so the store's columns are already in output order and can be copied directly
+    auto copy_column = [this](vtkFloatArray* arr, const double* col)
     {
-        mesh_elem fit = this->face(i);
+        arr->SetNumberOfTuples(this->size_faces());
+        float* out = arr->GetPointer(0);
 
-        for (auto &v: variables)
+#pragma omp parallel for
+        for (size_t i = 0; i < this->size_faces(); i++)
         {
-            double d = (*fit)[v];
-            if(d == -9999.)
-            {
-                d = nan("");
-            }
+            double d = col[i];
+            out[i] = d == -9999. ? nan("") : d;
+        }
+    };
 
-            data[v]->InsertTuple1(i,d);
+    for (auto &v: variables)
+    {
+        copy_column(data[v], _variable_store.column(v));
+    }
+
+    if(_write_parameters_to_vtu)
+    {
+        for (auto &v: params)
+        {
+            copy_column(data["[param] " + v], _parameter_store.column(v));
         }
+    }
+
+    for (size_t i = 0; i < this->size_faces(); i++)
+    {
+        mesh_elem fit = this->face(i);
+
         if(_write_parameters_to_vtu)
         {
-            for (auto &v: params)
-            {
-                double d = fit->parameter(v);
-                if (d == -9999.)
-                {
-                    d = nan("");
-                }
-                data["[param] " + v]->InsertTuple1(i, d);
-            }
-
             for (auto &v: ics)
             {
                 double d = fit->get_initial_condition(v);
@@ -989,17 +1420,54 @@ void triangulation::write_vtu(std::string file_name)
     //this now needs to be called from outside these functions
 //    update_vtk_data();
 
+    write_vtu(_vtk_unstructuredGrid, file_name);
+
+//    write_vtp(file_name);
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> triangulation::vtu_snapshot()
+{
+    // update_vtk_data refills the same cell data arrays every time, so those need to be copied. The points and cells
+    // are only replaced, never modified, so they can be shared.
+    vtkSmartPointer<vtkUnstructuredGrid> snapshot = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    snapshot->ShallowCopy(_vtk_unstructuredGrid);
+    snapshot->GetCellData()->DeepCopy(_vtk_unstructuredGrid->GetCellData());
+    return snapshot;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> triangulation::vtu_snapshot(const std::vector<std::string>& variables,
+                                                                 const std::vector<float>& values)
+{
+    if (values.size() != variables.size() * this->size_faces())
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("vtu snapshot values have the wrong size"));
+
+    auto snapshot = vtu_snapshot();
+    for (size_t v = 0; v < variables.size(); v++)
+    {
+        auto arr = vtkFloatArray::SafeDownCast(snapshot->GetCellData()->GetArray(variables[v].c_str()));
+        if (!arr)
+            BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Variable " + variables[v] + " is not in the vtu output"));
+
+        const float* col = values.data() + v * this->size_faces();
+        float* out = arr->GetPointer(0);
+        for (size_t i = 0; i < this->size_faces(); i++)
+            out[i] = col[i] == -9999.f ? nan("") : col[i];
+    }
+
+    return snapshot;
+}
+
+void triangulation::write_vtu(vtkSmartPointer<vtkUnstructuredGrid> grid, const std::string& file_name)
+{
     vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
     writer->SetFileName(file_name.c_str());
 //    writer->SetCompressorType( vtkXMLUnstructuredGridWriter::CompressorType::ZLIB);
 #if VTK_MAJOR_VERSION <= 5
-    writer->SetInput(_vtk_unstructuredGrid);
+    writer->SetInput(grid);
 #else
-    writer->SetInputData(_vtk_unstructuredGrid);
+    writer->SetInputData(grid);
 #endif
     writer->Write();
-
-//    write_vtp(file_name);
 }
 
 double triangulation::max_z()
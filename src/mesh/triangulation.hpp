@@ -43,6 +43,7 @@ inline int omp_get_max_threads() { return 1;}
 #include <stack>
 #include <fstream>
 #include <utility>
+#include <mutex>
 //#define ARMA_DONT_USE_CXX11 //intel on linux breaks otherwise
 //#define ARMA_64BIT_WORD
 #include <armadillo>
@@ -56,10 +57,15 @@ inline int omp_get_max_threads() { return 1;}
 // hash functions
 #include "utility/BBhash.h"
 #include "utility/wyhash.h"
+#include "variable_store.hpp"
+#include "face_stencil.hpp"
+#include "horizon_table.hpp"
+#include "face_locator.hpp"
 
 
 #include <boost/lexical_cast.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/ptr_container/ptr_map.hpp>
 
@@ -83,15 +89,6 @@ inline int omp_get_max_threads() { return 1;}
 
 namespace pt = boost::property_tree;
 
-//required for the spatial searching
-#include <CGAL/Search_traits_2.h>
-#include <CGAL/Search_traits_adapter.h>
-#include <CGAL/Orthogonal_k_neighbor_search.h>
-
-#include <CGAL/Euclidean_distance.h>
-#include <CGAL/property_map.h>
-#include <boost/iterator/zip_iterator.hpp>
-
 //http://www.paraview.org/Bug/print_bug_page.php?bug_id=14164
 //http://review.source.kitware.com/#/c/11956/
 //until 6.0.1 comes out
@@ -238,6 +235,16 @@ public:
      */
     const Face_handle find_closest_face(double azimuth, double distance);
 
+    /**
+     * The face at step j along azimuth bin k of a stencil from triangulation::directional_stencil. A lookup instead of
+     * the kd-tree query find_closest_face(stencil.azimuth(k), stencil.distances()[j]) makes.
+     * @param stencil
+     * @param k
+     * @param j
+     * @return
+     */
+    const Face_handle stencil_face(const face_stencil& stencil, size_t k, size_t j);
+
     /**
      * Returns the ith edge's length. Refering to the docs here
      * http://doc.cgal.org/latest/Triangulation_2/classCGAL_1_1Triangulation__2.html
@@ -314,6 +321,14 @@ public:
 
     double& operator[](const uint64_t& variable);
     double& operator[](const std::string& variable);
+
+    /**
+     * Variable access via a handle resolved from triangulation::variable_handle or module_base::handle.
+     * No lookup or checks are performed.
+     * @param h
+     * @return
+     */
+    double& operator[](const var_handle& h);
     /**
      * Returns the face vector for a specified variable
      * @param variable
@@ -330,18 +345,6 @@ public:
      */
     void remove_face_data(const std::string &ID);
 
-    /**
-    * Initializes  this faces variable storage
-    * \param variables Names of the variables to add
-    */
-    void init_time_series(std::set<std::string>& variables);
-
-    /**
-        * Initializes  this faces parameter storage
-        * \param variables Names of the variables to add
-        */
-    void init_parameters(std::set<std::string>& parameters);
-
     /**
     * Obtains the timeseries associated with the given variable
     * \param ID variable
@@ -428,6 +431,15 @@ public:
     template<typename T>
     T*make_module_data(const std::string &module);
 
+    /**
+     * Stations used to interpolate the forcing to this face. As stations never move, this is the result of
+     * global::get_stations for this face, computed once by core before the modules are initialized.
+     * Prefer this over calling global::get_stations every timestep.
+     * @return
+     */
+    const std::vector< boost::shared_ptr<station> >& stations() const;
+    void set_stations(std::vector< boost::shared_ptr<station> > stations);
+
     std::string _debug_name; //for debugging to find the elem that we want
     int _debug_ID; //also for debugging. ID == the position in the output order, starting at 0
     size_t cell_global_id;
@@ -441,6 +453,13 @@ public:
      */
     double& parameter(const uint64_t& hash);
     double& parameter(const std::string& variable);
+
+    /**
+     * Parameter access via a handle resolved from triangulation::parameter_handle. No lookup or checks are performed.
+     * @param h
+     * @return
+     */
+    double& parameter(const var_handle& h);
     /**
      * Sets the parameter on the face to the given value. Parameter doesn't have to exist. Do not use to store model output.
      * @param key
@@ -494,14 +513,6 @@ private:
     boost::shared_ptr<Vector_3> _normal;
 
 
-    // Holds the name-value pair in the variable store hashmap
-    // we do this as we hold a hash and not the name
-    struct var
-    {
-        double value;
-        double xxhash; // holds the xxhash value so we can confirm we get the right thing back from BBHash
-        std::string variable;
-    };
 #ifdef USE_SPARSEHASH
     typedef google::dense_hash_map<std::string,face_info*> face_data_hashmap;
     typedef google::dense_hash_map<std::string,double> face_param_hashmap;
@@ -512,30 +523,7 @@ private:
     typedef std::unordered_map<std::string,Vector_3> face_vec_hashmap;
 #endif
 
-
-    template <typename Item> class wyandFunctor
-    {
-    public:
-        uint64_t operator ()  (const Item& key, uint64_t seed=2654435761U) const
-        {
-            return wyhash(&key, sizeof(Item), seed);
-        }
-
-    };
-    typedef wyandFunctor<uint64_t> hasher_t;
-    typedef boomphf::mphf< uint64_t, hasher_t  > boophf_t;
-
-    // Note that we have to explicitly check if what we get back is what we wanted as
-    // mphf do not guarantee what asking for something outside of the map returns a sane answer
-    // https://github.com/rizkg/BBHash/issues/12
-
-    // perfect hashfn + variable storage
-    std::unique_ptr<boophf_t> _variable_bphf;
-    std::vector<var> _variables;
-
-    // perfect hashfn + parameter storage
-    std::unique_ptr<boophf_t> _parameters_bphf;
-    std::vector<var> _parameters;
+    // variable and parameter values live in the triangulation's variable_store, indexed by cell_local_id
 
     face_data_hashmap _module_face_data;
     face_param_hashmap _initial_conditions;
@@ -544,6 +532,9 @@ private:
     boost::shared_ptr<timeseries> _data;
     timeseries::iterator _itr;
 
+    // neighbouring stations used for interpolation
+    std::vector< boost::shared_ptr<station> > _stations;
+
 };
 
 typedef face<Gt> Fb; //custom face class
@@ -552,27 +543,7 @@ typedef CGAL::Triangulation_data_structure_2<Vb, Fb> Delaunay;
 typedef Delaunay::Face_handle mesh_elem;
 typedef boost::shared_ptr<tbb::concurrent_vector<double>  > vector;
 
-//search tree typedefs
-//http://doc.cgal.org/latest/Spatial_searching/index.html
 typedef K::Point_2 Point_2;
-typedef boost::tuple<Point_2, mesh_elem > Point_and_face;
-typedef CGAL::Search_traits_2<K>                       Traits_base;
-typedef CGAL::Search_traits_adapter<Point_and_face,
-            CGAL::Nth_of_tuple_property_map<0, Point_and_face>,
-            Traits_base>                                              Traits;
-
-//Sliding_midpoint spatial search tree. Better stability for searching with the coordinate systems we use
-typedef CGAL::Sliding_midpoint<Traits> Splitter;
-typedef CGAL::Kd_tree<Traits,Splitter> Tree;
-
-// for nearest face search
-typedef CGAL::Orthogonal_k_neighbor_search <
-        Traits,
-        typename CGAL::internal::Spatial_searching_default_distance<Traits>::type,
-        Splitter > K_neighbor_search;
-
-// used for faces in radius
-typedef CGAL::Fuzzy_sphere<Traits> Fuzzy_circle;
 
 
 /**
@@ -605,22 +576,77 @@ public:
     */
 	void from_json(pt::ptree& mesh);
 
+    /**
+    * Loads a mesh from a binary mesh file (see mesh_binary). The file is mmap'd and the triangulation built directly from it.
+    * \param path Fully qualified path to the binary mesh
+    * \param extra Additional parameters and initial conditions, under the "parameters" and "initial_conditions" keys,
+    * as would be given in a json mesh. These override parameters of the same name in the binary file.
+    */
+    void from_binary(const std::string& path, pt::ptree& extra);
+
     /**
     * Sets a new order to the face numbering.
     * \param permutation desired ordering
     */
   void reorder_faces(std::vector<size_t> permutation);
 
+    /**
+    * Selects the locality-aware ordering (see face_order) applied to the faces when the mesh is loaded, before the
+    * partitioning. One of "none", "hilbert", "morton", "rcb" or "graph". "none" keeps the mesh file's order, or its
+    * cell_global_id permutation if it has one. Must be called before from_json/from_binary.
+    * \param method
+    */
+  void set_face_order(const std::string& method);
+
     /**
     * Sets the MPI process ownership of mesh faces and nodes
     */
   void partition_mesh();
 
+    /**
+    * Allocates the mesh-wide variable storage. Every face gets a slot, indexed by cell_local_id, for each variable.
+    * \param variables Names of the variables to add
+    */
+  void init_time_series(std::set<std::string>& variables);
+
+    /**
+    * Allocates the mesh-wide parameter storage. Every face gets a slot, indexed by cell_local_id, for each parameter.
+    * \param parameters Names of the parameters to add
+    */
+  void init_parameters(std::set<std::string>& parameters);
+
+    /**
+    * Resolves a variable name to a handle that can be used with face::operator[]. Throws if the variable does not exist.
+    * Only valid after init_time_series.
+    * \param variable
+    */
+  var_handle variable_handle(const std::string& variable);
+
+    /**
+    * Resolves a parameter name to a handle that can be used with face::parameter. Throws if the parameter does not exist.
+    * \param parameter
+    */
+  var_handle parameter_handle(const std::string& parameter);
+
     /**
     * Figures out which faces lie on the boundary of an MPI process' domain
     */
   void determine_local_boundary_faces();
 
+    /**
+    * Builds, from the boundary faces, the per-process lists of owned faces to send and ghost faces to receive
+    * in exchange_halo. The halo is the one ring of ghost faces that share an edge with this process' faces.
+    */
+  void build_halo();
+
+    /**
+    * Sends this process' boundary face values of the given variables to the neighbouring processes and receives
+    * theirs into the ghost faces, using non-blocking MPI. Every process must call this with the same variables,
+    * in the same order. Does nothing without MPI.
+    * \param variables
+    */
+  void exchange_halo(const std::vector<var_handle>& variables);
+
 
 	/**
 	 * Serializes a mesh attribute to file so it can be read into the model.
@@ -667,6 +693,28 @@ public:
      */
 	mesh_elem find_closest_face(Point_2 query) const;
 
+    /**
+     * find_closest_face of the points distances[j] from every face's center along n evenly spaced azimuths, computed
+     * once. It is shared with every other caller asking for the same azimuths and distances, and freed once nobody
+     * holds it. Only the planar geometry is used, so it stays valid if the terrain is deformed.
+     * @param azimuths Number of azimuth bins, bin k is k * 360/azimuths degrees
+     * @param distances Distances along each azimuth
+     * @return
+     */
+    boost::shared_ptr<const face_stencil> directional_stencil(size_t azimuths, const std::vector<double>& distances);
+
+    /**
+     * Horizon angle of every face over n azimuth sectors, searched at the given distances along the matching
+     * directional_stencil. Unlike the stencil it depends on the elevation, so it isn't shared; callers hold on to it.
+     * @param sectors Number of azimuth sectors, sector k is centred on k * 360/sectors degrees
+     * @param distances Distances along each azimuth
+     * @param file If not empty, the table is loaded from this file if it matches the mesh, otherwise it is computed
+     * and written there. Under MPI each rank appends its rank to the file name.
+     * @return
+     */
+    boost::shared_ptr<const horizon_table> horizon_angles(size_t sectors, const std::vector<double>& distances,
+                                                          std::string file = "");
+
     /**
      * Locates the triangles (based on centers) within a given radius. Example:
      * @code
@@ -703,6 +751,21 @@ public:
     mesh_elem locate_face(double x, double y);
     mesh_elem locate_face(Point_2 query);
 
+    /**
+     * locate_face for many points at once. Each search walks the mesh from the previous hit, so points that are near
+     * one another in the vector are found in a few steps.
+     * @param points
+     * @return triangle containing each point, nullptr for those that aren't in any
+     */
+    std::vector<mesh_elem> locate_faces(const std::vector<Point_2>& points);
+
+    /**
+     * find_closest_face for many points at once
+     * @param points
+     * @return
+     */
+    std::vector<mesh_elem> find_closest_faces(const std::vector<Point_2>& points) const;
+
     /**
     * Returns the finite face at index i. A given index will always return the same face.
     * \param i Index
@@ -768,6 +831,27 @@ public:
     */
 	void write_vtu(std::string fname);
 
+    /**
+    * A copy of the vtu data as of the last update_vtk_data, that can be written with write_vtu(grid, fname)
+    * while the model carries on. The geometry is shared, the cell data is copied.
+    */
+    vtkSmartPointer<vtkUnstructuredGrid> vtu_snapshot();
+
+    /**
+    * As vtu_snapshot(), but with the named arrays replaced by values, e.g., from mesh_aggregate::result()
+    * \param variables Names of the arrays, which must have been output by update_vtk_data
+    * \param values [variable][face]
+    */
+    vtkSmartPointer<vtkUnstructuredGrid> vtu_snapshot(const std::vector<std::string>& variables,
+                                                      const std::vector<float>& values);
+
+    /**
+    * Writes a grid, e.g., from vtu_snapshot. Doesn't touch the mesh, so it may be called from another thread.
+    * \param grid
+    * \param fname
+    */
+    static void write_vtu(vtkSmartPointer<vtkUnstructuredGrid> grid, const std::string& fname);
+
 
 	/**
 	 * Returns true if this is a geogrphic mesh
@@ -781,10 +865,6 @@ public:
      */
 	std::string proj4();
 
-	//holds the spatial search tree
-	//http://doc.cgal.org/latest/Spatial_searching/index.html
-	boost::shared_ptr<Tree> dD_tree;
-
     void write_param_to_vtu(bool write_param);
 
     /**
@@ -814,7 +894,22 @@ public:
     //however, core might have found some parameters from modules
     // it will have to insert them into this list so that the static hashmaps can be properly init
     std::set<std::string> _parameters;
+
+    // Columnar storage of the face variables and parameters.
+    // Accessed via face::operator[] and face::parameter. A face's values are at cell_local_id in each column.
+    variable_store _variable_store;
+    variable_store _parameter_store;
 private:
+    // creates a face from the given vertexes and sets up its ids, appending it to _faces
+    mesh_elem _add_face(Vertex_handle vert1, Vertex_handle vert2, Vertex_handle vert3);
+
+    // applies the "parameters" and "initial_conditions" sections of a json mesh. _load_parameters also allocates the parameter storage
+    void _load_parameters(pt::ptree& mesh);
+    void _load_initial_conditions(pt::ptree& mesh);
+
+    // common tail of from_json and from_binary. Applies the permutation (if not empty), partitions the mesh and builds the search tree
+    void _finalize_mesh(const std::vector<size_t>& permutation);
+
     size_t _num_faces; //number of faces
     size_t _num_vertex; //number of rows in the original data matrix. useful for exporting to matlab, etc
     K::Iso_rectangle_2 _bbox;
@@ -852,6 +947,40 @@ private:
     std::vector< mesh_elem > _local_faces;
     std::vector< std::pair<mesh_elem,bool> > _boundary_faces;
 
+    // built-in face reordering, see set_face_order
+    std::string _face_order;
+
+    //bucket grid of the face centers, for find_closest_face, find_faces_in_radius and locate_face
+    face_locator _locator;
+
+    // i-th finite face, as face(i) but usable from const members
+    mesh_elem _face(size_t i) const
+    {
+#ifdef USE_MPI
+        return _local_faces[i];
+#else
+        return _faces[i];
+#endif
+    }
+
+    // see directional_stencil
+    std::mutex _stencil_mutex;
+    std::vector< boost::weak_ptr<const face_stencil> > _stencils;
+
+    // first global face index owned by each process, plus the total number of faces
+    std::vector<size_t> _partition_start;
+
+    // faces exchanged with one neighbouring process, as cell_local_ids sorted by cell_global_id so both sides agree
+    struct halo_partner
+    {
+        int rank;
+        std::vector<size_t> send_cells; // owned faces the neighbour ghosts
+        std::vector<size_t> recv_cells; // ghost faces the neighbour owns
+        std::vector<double> send_buffer;
+        std::vector<double> recv_buffer;
+    };
+    std::vector<halo_partner> _halo;
+
 
 #ifdef NOMATLAB
     //ptr to the matlab engine
@@ -974,56 +1103,31 @@ private:
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has_parameter(const std::string& variable)
 {
-    uint64_t hash = xxh64::hash (variable.c_str(), variable.length(), 2654435761U);
-    return has_parameter(hash);
+    return _domain->_parameter_store.has(variable);
 }
 
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has_parameter(const uint64_t& hash)
 {
-    auto idx = _parameters_bphf->lookup(hash);
-
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if( idx >=  _parameters.size() ||
-            _parameters[idx].xxhash != hash)
-        return false;
-
-    return true;
-
+    return _domain->_parameter_store.has(hash);
 }
 
 template < class Gt, class Fb >
 double& face<Gt, Fb>::parameter(const std::string& variable)
 {
-    uint64_t hash = xxh64::hash (variable.c_str(), variable.length(), 2654435761U);
-    uint64_t  idx = _parameters_bphf->lookup(hash);
-
-    //duplicate the code of the other paramter here for speed so we don't lookup 2x
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if( idx >=  _parameters.size() ||
-            _parameters[idx].xxhash != hash)
-        BOOST_THROW_EXCEPTION(module_error() << errstr_info("Parameter " + variable + " does not exist."));
-
-    return _parameters[idx].value;
+    return _domain->_parameter_store(variable, cell_local_id);
 };
 
 template < class Gt, class Fb >
 double& face<Gt, Fb>::parameter(const uint64_t& hash)
 {
-    uint64_t  idx = _parameters_bphf->lookup(hash);
-
-    //duplicate the code of the other paramter here for speed so we don't lookup 2x
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if( idx >= _parameters.size() ||
-            _parameters[idx].xxhash != hash)
-        BOOST_THROW_EXCEPTION(module_error() << errstr_info("Parameter " + std::to_string(hash)+ " does not exist."));
-
-    return _parameters[idx].value;
-
+    return _domain->_parameter_store(hash, cell_local_id);
+};
 
+template < class Gt, class Fb >
+double& face<Gt, Fb>::parameter(const var_handle& h)
+{
+    return _domain->_parameter_store(h, cell_local_id);
 };
 
 template < class Gt, class Fb >
@@ -1047,12 +1151,7 @@ double face<Gt, Fb>::get_initial_condition(std::string key)
 template < class Gt, class Fb >
 std::vector<std::string>  face<Gt, Fb>::parameters()
 {
-    std::vector<std::string> params;
-    for(auto& itr : _parameters)
-    {
-        params.push_back(itr.variable);
-    }
-    return params;
+    return _domain->_parameter_store.variables();
 };
 
 template < class Gt, class Fb >
@@ -1099,7 +1198,6 @@ face<Gt, Fb>::face()
 
 #ifdef USE_SPARSEHASH
     _module_face_data.set_empty_key("");
-    _parameters.set_empty_key("");
     _initial_conditions.set_empty_key("");
     _module_face_vectors.set_empty_key("");
 
@@ -1307,6 +1405,12 @@ const typename face<Gt, Fb>::Face_handle face<Gt, Fb>::find_closest_face(double
     return _domain->find_closest_face(math::gis::point_from_bearing(center(), azimuth, distance));
 };
 
+template < class Gt, class Fb>
+const typename face<Gt, Fb>::Face_handle face<Gt, Fb>::stencil_face(const face_stencil& stencil, size_t k, size_t j)
+{
+    return _domain->face(stencil.ray(cell_local_id, k)[j]);
+}
+
 template < class Gt, class Fb>
 Vector_3 face<Gt, Fb>::normal()
 {
@@ -1394,64 +1498,38 @@ bool face<Gt, Fb>::contains(double x, double y)
 template < class Gt, class Fb>
 std::vector<std::string> face<Gt, Fb>::variables()
 {
-    std::vector<std::string> vars;
-    for(auto itr:_variables)
-    {
-        vars.push_back(itr.variable);
-    }
-    return vars;
-
+    return _domain->_variable_store.variables();
 }
 
 
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has(const std::string& variable)
 {
-    uint64_t hash = xxh64::hash (variable.c_str(), variable.length(), 2654435761U);
-    return has(hash);
-
+    return _domain->_variable_store.has(variable);
 };
 
 template < class Gt, class Fb>
 bool face<Gt, Fb>::has(const uint64_t& hash)
 {
-    uint64_t  idx = _variable_bphf->lookup(hash);
-
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if(_variables[idx].xxhash != hash)
-        return false;
-
-    return true;
+    return _domain->_variable_store.has(hash);
 }
 
 template < class Gt, class Fb>
 double& face<Gt, Fb>::operator[](const uint64_t& hash)
 {
-    uint64_t  idx = _variable_bphf->lookup(hash);
-
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if (_variables[idx].xxhash != hash)
-        BOOST_THROW_EXCEPTION(module_error() << errstr_info("Variable " + std::to_string(hash) + " does not exist."));
-
-
-    return _variables[idx].value;
+    return _domain->_variable_store(hash, cell_local_id);
 }
 
 template < class Gt, class Fb>
 double& face<Gt, Fb>::operator[](const std::string& variable)
 {
-    uint64_t hash = xxh64::hash (variable.c_str(), variable.length(), 2654435761U);
-    uint64_t  idx = _variable_bphf->lookup(hash);
-
-    // did the table return garabage?
-    //mphf might return an index, but it isn't actually what we want. double check the hash
-    if( idx >=  _variables.size() ||
-            _variables[idx].xxhash != hash)
-        BOOST_THROW_EXCEPTION(module_error() << errstr_info("Variable " + variable + " does not exist."));
+    return _domain->_variable_store(variable, cell_local_id);
+}
 
-    return _variables[idx].value;
+template < class Gt, class Fb>
+double& face<Gt, Fb>::operator[](const var_handle& h)
+{
+    return _domain->_variable_store(h, cell_local_id);
 }
 
 template < class Gt, class Fb >
@@ -1503,55 +1581,6 @@ Vector_3 face<Gt, Fb>::face_vector(const std::string& variable)
     return _module_face_vectors[variable];
 };
 
-template < class Gt, class Fb>
-void face<Gt, Fb>::init_time_series(std::set<std::string>& variables)
-{
-
-    std::vector<u_int64_t> hash_vec;
-    for(auto& v : variables)
-    {
-        uint64_t hash = xxh64::hash (v.c_str(), v.length(), 2654435761U);
-        hash_vec.push_back(hash);
-    }
-
-    _variable_bphf = std::unique_ptr<boomphf::mphf<u_int64_t,hasher_t>>(
-            new boomphf::mphf<u_int64_t,hasher_t>(hash_vec.size(),hash_vec,1,2,false,false));
-
-    _variables.resize(variables.size());
-    for(auto v : variables)
-    {
-        uint64_t hash = xxh64::hash (v.c_str(), v.length(), 2654435761U);
-        uint64_t  idx = _variable_bphf->lookup(hash);
-        _variables[idx].value = -9999.0;
-        _variables[idx].variable = v;
-        _variables[idx].xxhash = hash;
-    }
-}
-
-template < class Gt, class Fb>
-void face<Gt, Fb>::init_parameters(std::set<std::string>& parameters)
-{
-    std::vector<u_int64_t> hash_vec;
-    for(auto& v : parameters)
-    {
-        uint64_t hash = xxh64::hash (v.c_str(), v.length(), 2654435761U);
-        hash_vec.push_back(hash);
-    }
-
-    _parameters_bphf = std::unique_ptr<boomphf::mphf<u_int64_t,hasher_t>>(
-            new boomphf::mphf<u_int64_t,hasher_t>(hash_vec.size(),hash_vec,1,2,false,false));
-
-    _parameters.resize(parameters.size());
-    for(auto& v : parameters)
-    {
-        uint64_t hash = xxh64::hash (v.c_str(), v.length(), 2654435761U);
-        uint64_t  idx = _parameters_bphf->lookup(hash);
-        _parameters[idx].value = -9999.0;
-        _parameters[idx].variable = v;
-        _parameters[idx].xxhash = hash;
-    }
-}
-
 template < class Gt, class Fb>
 timeseries::variable_vec face<Gt, Fb>::face_time_series(std::string ID)
 {
@@ -1677,6 +1706,18 @@ void face<Gt, Fb>::set_module_data(const std::string &module, face_info *fi)
 {
     _module_face_data[module] = fi;
 }
+
+template < class Gt, class Fb>
+const std::vector< boost::shared_ptr<station> >& face<Gt, Fb>::stations() const
+{
+    return _stations;
+}
+
+template < class Gt, class Fb>
+void face<Gt, Fb>::set_stations(std::vector< boost::shared_ptr<station> > stations)
+{
+    _stations = std::move(stations);
+}
 template < class Gt, class Fb>
 double face<Gt, Fb>::get_area()
 {
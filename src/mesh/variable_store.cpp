@@ -0,0 +1,116 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "variable_store.hpp"
+
+variable_store::variable_store(std::string kind)
+    : _kind(kind), _ncells(0)
+{
+
+}
+
+void variable_store::init(const std::set<std::string>& variables, size_t ncells, double fill)
+{
+    std::vector<uint64_t> hash_vec;
+    for(auto& v : variables)
+    {
+        hash_vec.push_back(hash(v));
+    }
+
+    _bphf = std::unique_ptr<boophf_t>(new boophf_t(hash_vec.size(), hash_vec, 1, 2, false, false));
+
+    _ncells = ncells;
+    _hashes.assign(variables.size(), 0);
+    _names.assign(variables.size(), "");
+    _columns.clear();
+    _columns.resize(variables.size());
+
+    for(auto& v : variables)
+    {
+        uint64_t h = hash(v);
+        uint64_t idx = _bphf->lookup(h);
+
+        _hashes[idx] = h;
+        _names[idx] = v;
+        _columns[idx].assign(ncells, fill);
+    }
+}
+
+var_handle variable_store::handle(const std::string& variable) const
+{
+    size_t idx = _lookup(hash(variable));
+    if( idx == _hashes.size())
+        BOOST_THROW_EXCEPTION(module_error() << errstr_info(_kind + " " + variable + " does not exist."));
+
+    return var_handle(idx);
+}
+
+double* variable_store::column(const uint64_t& hash)
+{
+    size_t idx = _lookup(hash);
+    if( idx == _hashes.size())
+        BOOST_THROW_EXCEPTION(module_error() << errstr_info(_kind + " " + std::to_string(hash) + " does not exist."));
+
+    return _columns[idx].data();
+}
+
+double* variable_store::column(const std::string& variable)
+{
+    size_t idx = _lookup(hash(variable));
+    if( idx == _hashes.size())
+        BOOST_THROW_EXCEPTION(module_error() << errstr_info(_kind + " " + variable + " does not exist."));
+
+    return _columns[idx].data();
+}
+
+void variable_store::permute(const std::vector<size_t>& new_index)
+{
+    if(new_index.size() != _ncells)
+        BOOST_THROW_EXCEPTION(mesh_error() << errstr_info("Permutation has " + std::to_string(new_index.size()) +
+                                                          " entries, expected " + std::to_string(_ncells)));
+
+    std::vector<double> tmp(_ncells);
+    for(auto& col : _columns)
+    {
+        for(size_t i = 0; i < _ncells; i++)
+        {
+            tmp[new_index[i]] = col[i];
+        }
+        col.swap(tmp);
+    }
+}
+
+const std::vector<std::string>& variable_store::variables() const
+{
+    return _names;
+}
+
+size_t variable_store::size() const
+{
+    return _names.size();
+}
+
+size_t variable_store::ncells() const
+{
+    return _ncells;
+}
@@ -0,0 +1,230 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// hash functions
+#include "utility/BBhash.h"
+#include "utility/wyhash.h"
+#include "utility/xxh64.hpp"
+
+#include "exception.hpp"
+
+/**
+ * \class var_handle
+ * \brief Dense column index into a variable_store
+ *
+ * Resolved once from a variable name (e.g., in a module's init) so that the per-timestep accesses skip the
+ * hash + mphf lookup + verification and become a plain indexed load.
+ */
+class var_handle
+{
+public:
+    var_handle() : column(std::numeric_limits<size_t>::max()) {}
+    explicit var_handle(size_t col) : column(col) {}
+
+    /**
+     * True if this handle was resolved to a column
+     */
+    bool valid() const
+    {
+        return column != std::numeric_limits<size_t>::max();
+    }
+
+    size_t column;
+};
+
+/**
+ * \class variable_store
+ * \brief Mesh-wide columnar (structure of arrays) storage for per-face values
+ *
+ * Rather than every face owning its own perfect hash + value vector, the triangulation holds one of these for the
+ * model variables and one for the parameters. Each variable is a contiguous column of doubles indexed by the face's
+ * cell_local_id, and the name -> column map is built once and shared by every face.
+ */
+class variable_store
+{
+public:
+    /**
+     * @param kind What is being stored, e.g., "Variable" or "Parameter". Only used for error messages.
+     */
+    variable_store(std::string kind = "Variable");
+
+    /**
+     * Builds the name->column map and allocates one column of size ncells per variable.
+     * Any previous contents are discarded.
+     * @param variables Names of the variables to store
+     * @param ncells Number of cells (faces) each column holds
+     * @param fill Initial value of every cell
+     */
+    void init(const std::set<std::string>& variables, size_t ncells, double fill = -9999.0);
+
+    /**
+     * Returns true if the variable has a column in this store
+     */
+    bool has(const uint64_t& hash) const;
+    bool has(const std::string& variable) const;
+
+    /**
+     * Value of the variable for the given cell. Throws if the variable does not exist.
+     * @param hash xxhash of the variable name
+     * @param cell cell_local_id of the face
+     * @return
+     */
+    double& operator()(const uint64_t& hash, size_t cell);
+    double& operator()(const std::string& variable, size_t cell);
+
+    /**
+     * Value of the variable for the given cell using a previously resolved handle. No checks are done.
+     * @param h handle from handle()
+     * @param cell cell_local_id of the face
+     * @return
+     */
+    double& operator()(const var_handle& h, size_t cell)
+    {
+        return _columns[h.column][cell];
+    }
+
+    /**
+     * Resolves the variable to its column. Throws if the variable does not exist.
+     * Handles remain valid until the next init()
+     * @param variable
+     * @return
+     */
+    var_handle handle(const std::string& variable) const;
+
+    /**
+     * Returns a pointer to the start of the variable's column. Throws if the variable does not exist.
+     * @param variable
+     * @return
+     */
+    double* column(const uint64_t& hash);
+    double* column(const std::string& variable);
+
+    /**
+     * Reorders every column such that the value at cell i moves to cell new_index[i].
+     * Used when the cell_local_ids are renumbered after the store has been filled.
+     * @param new_index
+     */
+    void permute(const std::vector<size_t>& new_index);
+
+    /**
+     * Names of all the variables in this store, in column order
+     */
+    const std::vector<std::string>& variables() const;
+
+    /**
+     * Number of variables (columns)
+     */
+    size_t size() const;
+
+    /**
+     * Number of cells in each column
+     */
+    size_t ncells() const;
+
+    /**
+     * Hash used for all variable and parameter names
+     */
+    static uint64_t hash(const std::string& variable)
+    {
+        return xxh64::hash(variable.c_str(), variable.length(), 2654435761U);
+    }
+
+private:
+
+    // returns the column for the hash, or size() if not present
+    size_t _lookup(const uint64_t& hash) const
+    {
+        if(!_bphf)
+            return _hashes.size();
+
+        uint64_t idx = _bphf->lookup(hash);
+
+        // Note that we have to explicitly check if what we get back is what we wanted as
+        // mphf do not guarantee what asking for something outside of the map returns a sane answer
+        // https://github.com/rizkg/BBHash/issues/12
+        if( idx >= _hashes.size() || _hashes[idx] != hash)
+            return _hashes.size();
+
+        return idx;
+    }
+
+    template <typename Item> class wyandFunctor
+    {
+    public:
+        uint64_t operator ()  (const Item& key, uint64_t seed=2654435761U) const
+        {
+            return wyhash(&key, sizeof(Item), seed);
+        }
+
+    };
+    typedef wyandFunctor<uint64_t> hasher_t;
+    typedef boomphf::mphf< uint64_t, hasher_t  > boophf_t;
+
+    std::string _kind;
+    size_t _ncells;
+
+    // a single perfect hashfn shared by all faces
+    std::unique_ptr<boophf_t> _bphf;
+
+    // indexed by the mphf
+    std::vector<uint64_t> _hashes;
+    std::vector<std::string> _names;
+    std::vector< std::vector<double> > _columns;
+};
+
+inline bool variable_store::has(const uint64_t& hash) const
+{
+    return _lookup(hash) != _hashes.size();
+}
+
+inline bool variable_store::has(const std::string& variable) const
+{
+    return has(hash(variable));
+}
+
+inline double& variable_store::operator()(const uint64_t& hash, size_t cell)
+{
+    size_t idx = _lookup(hash);
+    if( idx == _hashes.size())
+        BOOST_THROW_EXCEPTION(module_error() << errstr_info(_kind + " " + std::to_string(hash) + " does not exist."));
+
+    return _columns[idx][cell];
+}
+
+inline double& variable_store::operator()(const std::string& variable, size_t cell)
+{
+    size_t idx = _lookup(hash(variable));
+    if( idx == _hashes.size())
+        BOOST_THROW_EXCEPTION(module_error() << errstr_info(_kind + " " + variable + " does not exist."));
+
+    return _columns[idx][cell];
+}
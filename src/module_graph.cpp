@@ -0,0 +1,191 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "module_graph.hpp"
+
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+
+module_graph::module_graph()
+{
+
+}
+
+bool module_graph::_reaches(size_t from, size_t to) const
+{
+    // walk back from 'to' through the deps
+    std::vector<size_t> stack(1, to);
+    std::vector<bool> seen(_nodes.size(), false);
+    while (!stack.empty())
+    {
+        size_t n = stack.back();
+        stack.pop_back();
+
+        if (n == from)
+            return true;
+
+        for (auto d : _nodes[n].deps)
+        {
+            if (!seen[d])
+            {
+                seen[d] = true;
+                stack.push_back(d);
+            }
+        }
+    }
+    return false;
+}
+
+void module_graph::build(const std::vector<bool>& data_parallel,
+                         const std::vector<std::vector<size_t>>& given_deps,
+                         std::function<void(size_t)> body,
+                         const std::vector<bool>& keep_order)
+{
+    // the tasks hold on to the graph, so they go first
+    _tasks.clear();
+    _start.reset();
+    _graph = boost::make_shared<tbb::flow::graph>();
+    _start = boost::make_shared<tbb::flow::broadcast_node<tbb::flow::continue_msg>>(*_graph);
+
+    _nodes.clear();
+    _body = body;
+
+    // pin the keep_order items between everything before and after them
+    std::vector<std::vector<size_t>> deps(given_deps);
+    for (size_t j = 0; j < keep_order.size() && j < deps.size(); j++)
+    {
+        for (size_t i = 0; i < j; i++)
+        {
+            if ((keep_order[j] || keep_order[i]) && std::find(deps[j].begin(), deps[j].end(), i) == deps[j].end())
+                deps[j].push_back(i);
+        }
+    }
+
+    std::vector<size_t> node_of(data_parallel.size());
+
+    for (size_t i = 0; i < data_parallel.size(); i++)
+    {
+        size_t target = _nodes.size();
+
+        if (data_parallel[i])
+        {
+            // try the most recent sweeps first
+            for (size_t n = _nodes.size(); n-- > 0;)
+            {
+                if (!_nodes[n].data_parallel)
+                    continue;
+
+                // joining n is fine unless one of our deps runs after n, as we'd then have to run both before and
+                // after it
+                bool ok = true;
+                for (auto d : deps[i])
+                {
+                    if (node_of[d] != n && _reaches(n, node_of[d]))
+                    {
+                        ok = false;
+                        break;
+                    }
+                }
+
+                if (ok)
+                {
+                    target = n;
+                    break;
+                }
+            }
+        }
+
+        if (target == _nodes.size())
+        {
+            node nd;
+            nd.data_parallel = data_parallel[i];
+            _nodes.push_back(nd);
+        }
+
+        node_of[i] = target;
+        _nodes[target].items.push_back(i);
+
+        for (auto d : deps[i])
+        {
+            size_t dn = node_of[d];
+            if (dn != target &&
+                std::find(_nodes[target].deps.begin(), _nodes[target].deps.end(), dn) == _nodes[target].deps.end())
+            {
+                _nodes[target].deps.push_back(dn);
+            }
+        }
+    }
+
+    // joining an earlier sweep can give it deps on later nodes, so build the tasks once all the nodes are known
+    for (size_t n = 0; n < _nodes.size(); n++)
+    {
+        _tasks.push_back(boost::shared_ptr<tbb::flow::continue_node<tbb::flow::continue_msg>>(
+                new tbb::flow::continue_node<tbb::flow::continue_msg>(
+                        *_graph,
+                        [this, n](const tbb::flow::continue_msg&)
+                        {
+                            // skip the rest of the graph once something has failed
+                            {
+                                std::lock_guard<std::mutex> lock(_error_mutex);
+                                if (_error)
+                                    return;
+                            }
+
+                            try
+                            {
+                                _body(n);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard<std::mutex> lock(_error_mutex);
+                                if (!_error)
+                                    _error = std::current_exception();
+                            }
+                        })));
+    }
+
+    for (size_t n = 0; n < _nodes.size(); n++)
+    {
+        if (_nodes[n].deps.empty())
+            tbb::flow::make_edge(*_start, *_tasks[n]);
+
+        for (auto d : _nodes[n].deps)
+            tbb::flow::make_edge(*_tasks[d], *_tasks[n]);
+    }
+}
+
+void module_graph::run()
+{
+    if (!_graph)
+        return;
+
+    _error = nullptr;
+
+    _start->try_put(tbb::flow::continue_msg());
+    _graph->wait_for_all();
+
+    if (_error)
+        std::rethrow_exception(_error);
+}
@@ -0,0 +1,102 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <tbb/flow_graph.h>
+
+/**
+ * \class module_graph
+ * \brief Runs the module dependency DAG as a TBB flow graph
+ *
+ * The modules are grouped into nodes:
+ *  - a domain parallel module is always its own node
+ *  - data parallel modules are fused into as few face sweeps as the dependencies allow. A data module joins an
+ *    existing sweep if none of its dependencies is reached through another node that itself runs after that sweep.
+ *
+ * A node starts as soon as all the nodes it depends on are done, so independent domain modules run concurrently and
+ * may overlap with the face sweeps.
+ *
+ * This class only knows about indexes. Item i is the ith module in topological order and may only depend on
+ * items < i.
+ *
+ * The edges are only as good as the deps given. Two modules that share a variable neither one declares can run at the
+ * same time, which the linear chunked order never allowed, so items that declare no inputs at all can be flagged
+ * keep_order to be kept in the linear order relative to every other item.
+ */
+class module_graph
+{
+public:
+    struct node
+    {
+        bool data_parallel;
+        std::vector<size_t> items; // in topological order
+        std::vector<size_t> deps;  // nodes that must finish first
+    };
+
+    module_graph();
+
+    /**
+     * Builds the nodes and the flow graph, replacing any previous one. Must not be called while run() is.
+     * @param data_parallel data_parallel[i] is true if item i is data parallel
+     * @param deps deps[i] are the items item i depends on
+     * @param body called with a node index to run that node. Called concurrently for independent nodes.
+     * @param keep_order if keep_order[i], item i runs after every item < i and before every item > i. Empty = none.
+     */
+    void build(const std::vector<bool>& data_parallel,
+               const std::vector<std::vector<size_t>>& deps,
+               std::function<void(size_t)> body,
+               const std::vector<bool>& keep_order = std::vector<bool>());
+
+    /**
+     * Runs every node once and waits for them to complete. If a node throws, the nodes that depend on it are
+     * skipped and the first exception is rethrown once the graph has finished.
+     */
+    void run();
+
+    const std::vector<node>& nodes() const { return _nodes; }
+
+private:
+    // true if node 'to' is reachable from node 'from' through the node deps
+    bool _reaches(size_t from, size_t to) const;
+
+    std::vector<node> _nodes;
+    std::function<void(size_t)> _body;
+
+    // rebuilt from scratch by build()
+    boost::shared_ptr<tbb::flow::graph> _graph;
+    boost::shared_ptr<tbb::flow::broadcast_node<tbb::flow::continue_msg>> _start;
+    std::vector<boost::shared_ptr<tbb::flow::continue_node<tbb::flow::continue_msg>>> _tasks;
+
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+};
@@ -26,35 +26,18 @@
 #include "logger.hpp"
 #include "triangulation.hpp"
 #include "module_base.hpp"
+#include "math/sun_zbuffer.hpp"
 
 #include <cstdlib>
 #include <string>
 #include <utility> //for pair
 #include <vector>
 #include <cmath>
-#include <armadillo>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #define _USE_MATH_DEFINES
 #include <math.h>
-#include "tbb/parallel_sort.h"
-#include "tbb/task_scheduler_init.h"
-struct module_shadow_face_info :  face_info
-{
-    module_shadow_face_info()
-    {
-        shadow = 0;
-        z_prime = 0;
-    }
-
-    int shadow;
-    double z_prime;
-};
-
-struct vertex_data : vertex_info
-{
-
-    Point_3 prj_vertex;
-    Point_3 org_vertex;
-};
 
 /**
 * \addtogroup modules
@@ -62,10 +45,16 @@ struct vertex_data : vertex_info
 * \class Marsh_shading_iswr
 * \brief Computes self and horizon shading
 *
-* Computes the self- and horizon-shadows for a basin. Numerically intensive.
+* Computes the self- and horizon-shadows for a basin with a z-buffer in the sun's frame, see sun_zbuffer.
+*
+* Config:
+* - "raster_size" Cell size of the grid in the sun's frame [m]. Default 0 = half the mean projected face size.
+* - "bias" How far behind, in cell sizes, a face must be to be shadowed. Scaled up for faces near edge on to the sun.
+*   Hides artifacts between neighbouring faces. Default 1.
 *
 * Depends:
-* - None
+* - Solar azimuth "solar_az" [degrees]
+* - Solar elevation "solar_el" [degrees]
 *
 * Provides:
 * - Value that provides a metric for triangle 'nearness' to the sun "z_prime" [-]
@@ -82,9 +71,20 @@ REGISTER_MODULE_HPP(Marsh_shading_iswr);
         Marsh_shading_iswr(config_file cfg);
         ~Marsh_shading_iswr();
         virtual void run(mesh& domain);
+        virtual void init(mesh& domain);
+
+private:
+    // reused across timesteps
+    sun_zbuffer _zbuffer;
+    std::vector<uint32_t> _faces;                      // vertexes of each face, [face][3]
+    std::vector<double> _xyz;                          // [vertex][x y z]
+    std::vector<double> _sun;                          // sun seen from each vertex, [vertex][azimuth elevation]
+    std::vector<double> _el;                           // solar elevation per face
 
-    int x_AABB;
-    int y_AABB;
+    var_handle solar_az_h;
+    var_handle solar_el_h;
+    var_handle shadow_h;
+    var_handle z_prime_h;
 };
 
 /**
@@ -39,6 +39,43 @@ inline unsigned int offset(const unsigned int &row_start,
   return -1; // wrap it and index garbage
 }
 
+// Solves A x = b starting from x0 by solving A y = b - A x0 for the correction y. The solvers' tolerance is relative
+// to their rhs, so it is rescaled such that they stop at the same residual as a solve from zero would.
+// x0 is then updated to the solution, or zeroed if it has nans so those don't carry on into the next timestep.
+// solve(rhs, tol) runs the actual solver.
+template<typename SolveT>
+viennacl::vector<vcl_scalar_type> warm_solve(const viennacl::compressed_matrix<vcl_scalar_type>& A,
+                                             const viennacl::vector<vcl_scalar_type>& b,
+                                             viennacl::vector<vcl_scalar_type>& x0,
+                                             double tol, bool warm, SolveT solve)
+{
+  if (!warm)
+    return solve(b, tol);
+
+  double b_norm = viennacl::linalg::norm_2(b);
+  viennacl::vector<vcl_scalar_type> x = x0;
+  if (b_norm == 0)
+  {
+    x.clear();
+    x0.clear();
+    return x;
+  }
+
+  viennacl::vector<vcl_scalar_type> r = viennacl::linalg::prod(A, x0);
+  r = b - r;
+  double r_norm = viennacl::linalg::norm_2(r);
+
+  if (r_norm > tol * b_norm)
+    x += solve(r, tol * b_norm / r_norm);
+
+  if (std::isfinite(static_cast<double>(viennacl::linalg::norm_2(x))))
+    x0 = x;
+  else
+    x0.clear();
+
+  return x;
+}
+
 PBSM3D::PBSM3D(config_file cfg) : module_base("PBSM3D", parallel::domain, cfg)
 {
   depends("U_2m_above_srf");
@@ -139,6 +176,62 @@ void PBSM3D::init(mesh &domain)
 {
   nLayer = cfg.get("nLayer", 5);
 
+  U_2m_above_srf_h = handle("U_2m_above_srf");
+  vw_dir_h = handle("vw_dir");
+  swe_h = handle("swe");
+  t_h = handle("t");
+  rh_h = handle("rh");
+  U_R_h = handle("U_R");
+  drift_mass_h = handle("drift_mass");
+  Qsusp_h = handle("Qsusp");
+  Qsalt_h = handle("Qsalt");
+  sum_drift_h = handle("sum_drift");
+  blowingsnow_probability_h = handle("blowingsnow_probability");
+
+  if (use_exp_fetch || use_tanh_fetch)
+    fetch_h = handle("fetch");
+  if (use_PomLi_probability)
+    p_snow_hours_h = domain->variable_handle("p_snow_hours");
+
+  // not a declared depends, but used to scale the reference wind
+  snowdepthavg_h = domain->variable_handle("snowdepthavg");
+
+  if (debug_output)
+  {
+    is_drifting_h = handle("is_drifting");
+    Km_coeff_h = handle("Km_coeff");
+    Qsusp_pbsm_h = handle("Qsusp_pbsm");
+    height_diff_h = handle("height_diff");
+    w_h = handle("w");
+    hs_h = handle("hs");
+    ustar_h = handle("ustar");
+    l_h = handle("l");
+    z0_h = handle("z0");
+    lambda_h = handle("lambda");
+    U_10m_h = handle("U_10m");
+    csalt_h = handle("csalt");
+    csalt_orig_h = handle("csalt_orig");
+    mass_qsalt_h = handle("mass_qsalt");
+    c_salt_fetch_big_h = handle("c_salt_fetch_big");
+    u_star_th_h = handle("u*_th");
+    tau_n_ratio_h = handle("tau_n_ratio");
+    dm_dt_h = handle("dm/dt");
+    mm_h = handle("mm");
+    Qsubl_h = handle("Qsubl");
+    Qsubl_mass_h = handle("Qsubl_mass");
+    sum_subl_h = handle("sum_subl");
+
+    for (int z = 0; z < nLayer; ++z)
+    {
+      K_z_h.push_back(handle("K" + std::to_string(z)));
+      c_z_h.push_back(handle("c" + std::to_string(z)));
+      rm_z_h.push_back(handle("rm" + std::to_string(z)));
+      csubl_z_h.push_back(handle("csubl" + std::to_string(z)));
+      settling_velocity_z_h.push_back(handle("settling_velocity" + std::to_string(z)));
+      u_z_z_h.push_back(handle("u_z" + std::to_string(z)));
+    }
+  }
+
   susp_depth = 5;                      // 5m as per pomeroy
   v_edge_height = susp_depth / nLayer; // height of each vertical prism
   l__max = 40; // mixing length for diffusivity calculations
@@ -176,6 +269,12 @@ void PBSM3D::init(mesh &domain)
 
   iterative_subl = cfg.get("iterative_subl", false);
 
+  // <= 0 rebuilds the preconditioners every timestep
+  double precond_refresh_ratio = cfg.get("precond_refresh_ratio", 2.0);
+  C_refresh = precond_refresh(precond_refresh_ratio);
+  A_refresh = precond_refresh(precond_refresh_ratio);
+  warm_start = cfg.get("warm_start", true);
+
   if (rouault_diffusion_coeff)
   {
     LOG_WARNING << "rouault_diffusion_coef overrides const "
@@ -335,11 +434,146 @@ void PBSM3D::init(mesh &domain)
   bb.resize(ntri);
   nnz = vl_C.nnz();
   nnz_drift = vl_A.nnz();
+
+  x_prev.resize(ntri * nLayer);
+  x_prev.clear();
+  dSdt_prev.resize(ntri);
+  dSdt_prev.clear();
+
+  C_precond.reset();
+  A_precond.reset();
+  C_refresh.reset();
+  A_refresh.reset();
+}
+
+PBSM3D::solver_metrics::solver_metrics()
+{
+  suspension_iters = 0;
+  deposition_iters = 0;
+  suspension_total_iters = 0;
+  deposition_total_iters = 0;
+  suspension_precond_builds = 0;
+  deposition_precond_builds = 0;
+  timesteps = 0;
+  skipped_timesteps = 0;
+}
+
+const PBSM3D::solver_metrics& PBSM3D::metrics() const
+{
+  return _metrics;
+}
+
+void PBSM3D::checkpoint(mesh& domain, netcdf& chkpt)
+{
+  std::vector<double> sum_drift(domain->size_faces());
+  std::vector<double> sum_subl(domain->size_faces());
+  std::vector<double> Qsubl_mass(domain->size_faces());
+
+#pragma omp parallel for
+  for (size_t i = 0; i < domain->size_faces(); i++)
+  {
+    auto face = domain->face(i);
+    sum_drift[i] = face->get_module_data<data>(ID)->sum_drift;
+
+    // the sublimation totals are only accumulated with debug_output
+    if (debug_output)
+    {
+      sum_subl[i] = (*face)[sum_subl_h];
+      Qsubl_mass[i] = (*face)[Qsubl_mass_h];
+    }
+  }
+
+  chkpt.create_variable1D("PBSM3D:sum_drift", sum_drift.size());
+  chkpt.put_var1D("PBSM3D:sum_drift", sum_drift.data(), sum_drift.size());
+
+  if (debug_output)
+  {
+    chkpt.create_variable1D("PBSM3D:sum_subl", sum_subl.size());
+    chkpt.create_variable1D("PBSM3D:Qsubl_mass", Qsubl_mass.size());
+    chkpt.put_var1D("PBSM3D:sum_subl", sum_subl.data(), sum_subl.size());
+    chkpt.put_var1D("PBSM3D:Qsubl_mass", Qsubl_mass.data(), Qsubl_mass.size());
+  }
+}
+
+void PBSM3D::load_checkpoint(mesh& domain, netcdf& chkpt)
+{
+  std::vector<double> sum_drift(domain->size_faces());
+  std::vector<double> sum_subl(domain->size_faces());
+  std::vector<double> Qsubl_mass(domain->size_faces());
+
+  chkpt.get_var1D("PBSM3D:sum_drift", sum_drift.data(), sum_drift.size());
+  if (debug_output)
+  {
+    chkpt.get_var1D("PBSM3D:sum_subl", sum_subl.data(), sum_subl.size());
+    chkpt.get_var1D("PBSM3D:Qsubl_mass", Qsubl_mass.data(), Qsubl_mass.size());
+  }
+
+#pragma omp parallel for
+  for (size_t i = 0; i < domain->size_faces(); i++)
+  {
+    auto face = domain->face(i);
+    face->get_module_data<data>(ID)->sum_drift = sum_drift[i];
+    (*face)[sum_drift_h] = sum_drift[i];
+
+    if (debug_output)
+    {
+      (*face)[sum_subl_h] = sum_subl[i];
+      (*face)[Qsubl_mass_h] = Qsubl_mass[i];
+    }
+  }
 }
 
 void PBSM3D::run(mesh &domain)
 {
+  // The same tests as the saltation check in the face loop below, but without the u* solve if z0_ustar_coupling is
+  // used. So this is a superset of the faces that will saltate.
+  saltation_mask.update(domain, [&](mesh_elem face) -> bool
+  {
+    auto d = face->get_module_data<data>(ID);
+
+    double snow_depth = (*face)[snowdepthavg_h];
+    snow_depth = is_nan(snow_depth) ? 0 : snow_depth;
+    double swe = (*face)[swe_h];
+    swe = is_nan(swe) ? 0 : swe;
+    double height_diff = enable_veg ? std::max(0.0, d->CanopyHeight - snow_depth) : 0;
+
+    if (height_diff > cutoff || swe < min_mass_for_trans || is_water(face))
+      return false;
+
+    if (z0_ustar_coupling)
+      return true;
+
+    double T = (*face)[t_h];
+    double u_star_saltation_threshold = 0.35 + (1.0 / 150.0) * T + (1.0 / 8200.0) * T * T;
+    double ustar = (*face)[U_2m_above_srf_h] * PhysConst::kappa / log(2.0 / Snow::Z0_SNOW);
+    return ustar >= u_star_saltation_threshold;
+  });
+
+  // Without saltation the suspension rhs is zero, so are the concentrations, the transport fluxes and the drift.
+  // Only the per-face diagnostics would differ, so this isn't done with debug_output.
+  if (saltation_mask.none() && !debug_output)
+  {
+#pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+      auto face = domain->face(i);
+      auto d = face->get_module_data<data>(ID);
+      d->saltation = false;
+
+      (*face)[Qsalt_h] = 0;
+      (*face)[Qsusp_h] = 0;
+      (*face)[drift_mass_h] = 0;
+      (*face)[sum_drift_h] = d->sum_drift;
+    }
 
+    x_prev.clear();
+    dSdt_prev.clear();
+
+    _metrics.suspension_iters = 0;
+    _metrics.deposition_iters = 0;
+    _metrics.skipped_timesteps++;
+    return;
+  }
 
   // needed for linear system offsets
   size_t ntri = domain->size_faces();
@@ -355,6 +589,8 @@ void PBSM3D::run(mesh &domain)
 
   b.switch_memory_context(host_ctx);
   bb.switch_memory_context(host_ctx);
+  x_prev.switch_memory_context(host_ctx);
+  dSdt_prev.switch_memory_context(host_ctx);
 #endif
 
   // zero CSR vector in vl_C
@@ -403,22 +639,22 @@ void PBSM3D::run(mesh &domain)
 
         double fetch = 1000;
         if (use_exp_fetch || use_tanh_fetch)
-          fetch = (*face)["fetch"_s];
+          fetch = (*face)[fetch_h];
 
         // get wind from the face
-        double uref = (*face)["U_R"_s];
-        double snow_depth = (*face)["snowdepthavg"_s];
+        double uref = (*face)[U_R_h];
+        double snow_depth = (*face)[snowdepthavg_h];
         snow_depth = is_nan(snow_depth) ? 0 : snow_depth;
 
-        double u2 = (*face)["U_2m_above_srf"_s];
+        double u2 = (*face)[U_2m_above_srf_h];
         double u10 = Atmosphere::log_scale_wind(
             uref, Atmosphere::Z_U_R, 10,
             snow_depth); // used by the pom probability forumuation, so don't
                          // hide behide debug output
         if (debug_output)
-          (*face)["U_10m"_s] = u10;
+          (*face)[U_10m_h] = u10;
 
-        double swe = (*face)["swe"_s]; // mm   -->    kg/m^2
+        double swe = (*face)[swe_h]; // mm   -->    kg/m^2
         swe = is_nan(swe)
                   ? 0
                   : swe; // handle the first timestep where swe won't have been
@@ -429,7 +665,7 @@ void PBSM3D::run(mesh &domain)
         if (!enable_veg)
           height_diff = 0;
         if (debug_output)
-          (*face)["height_diff"_s] = height_diff;
+          (*face)[height_diff_h] = height_diff;
 
         double ustar = 1.3; // placeholder
 
@@ -454,12 +690,12 @@ void PBSM3D::run(mesh &domain)
         // threshold friction velocity. Compute here as it's used below as well
         // Pomeroy and Li, 2000
         // Eqn 7
-        double T = (*face)["t"_s];
+        double T = (*face)[t_h];
         double u_star_saltation_threshold =
             0.35 + (1.0 / 150.0) * T +
             (1.0 / 8200.0) * T * T; // saltation threshold m/s
         if (debug_output)
-          (*face)["u*_th"_s] = u_star_saltation_threshold;
+          (*face)[u_star_th_h] = u_star_saltation_threshold;
 
         // we don't have too high of veg. Check for blowing snow
         if (height_diff <= cutoff && swe >= min_mass_for_trans &&
@@ -475,7 +711,7 @@ void PBSM3D::run(mesh &domain)
             lambda = N * dv * height_diff; // Pomeroy formulation
 
           if (debug_output)
-            (*face)["lambda"_s] = lambda;
+            (*face)[lambda_h] = lambda;
 
           if(z0_ustar_coupling)
           {
@@ -535,9 +771,9 @@ void PBSM3D::run(mesh &domain)
         d->z0 = std::max(Snow::Z0_SNOW, d->z0);
         ustar = std::max(0.01, ustar);
         if (debug_output)
-          (*face)["ustar"_s] = ustar;
+          (*face)[ustar_h] = ustar;
         if (debug_output)
-          (*face)["z0"_s] = d->z0;
+          (*face)[z0_h] = d->z0;
 
         // depth of saltation layer
         double hs = 0;
@@ -546,15 +782,15 @@ void PBSM3D::run(mesh &domain)
 
         d->hs = hs;
         if (debug_output)
-          (*face)["hs"_s] = hs;
+          (*face)[hs_h] = hs;
         if (debug_output)
-          (*face)["is_drifting"_s] = 0;
+          (*face)[is_drifting_h] = 0;
         if (debug_output)
-          (*face)["Qsusp_pbsm"_s] = 0; // for santiy checks against pbsm
+          (*face)[Qsusp_pbsm_h] = 0; // for santiy checks against pbsm
 
         double Qsalt = 0;
         double c_salt = 0;
-        double t = (*face)["t"_s] + 273.15;
+        double t = (*face)[t_h] + 273.15;
 
         // Check if we can blow snow in this triagnle
         // Are we above saltation threshold?
@@ -568,16 +804,16 @@ void PBSM3D::run(mesh &domain)
               t); // air density kg/m^3, comment in mio is wrong.1.225;
 
           if (debug_output)
-            (*face)["blowingsnow_probability"_s] = 0; // default to 0%
+            (*face)[blowingsnow_probability_h] = 0; // default to 0%
 
           if (debug_output)
           {
             double pbsm_qsusp = pow(u10, 4.13) / 674100.0;
-            (*face)["Qsusp_pbsm"_s] = pbsm_qsusp;
+            (*face)[Qsusp_pbsm_h] = pbsm_qsusp;
           }
 
           if (debug_output)
-            (*face)["is_drifting"_s] = 1;
+            (*face)[is_drifting_h] = 1;
 
           // Pomeroy and Li 2000, eqn 8
           double Beta = 202.0; // 170.0;
@@ -589,7 +825,7 @@ void PBSM3D::run(mesh &domain)
           double tau_n_ratio = (m * Beta * lambda) / (1.0 + m * Beta * lambda);
 
           if (debug_output)
-            (*face)["tau_n_ratio"_s] = tau_n_ratio;
+            (*face)[tau_n_ratio_h] = tau_n_ratio;
 
           // Pomeroy 1992, eqn 12, see note above for ustar_n calc, but ustar_n
           // is correctly squared already
@@ -607,7 +843,7 @@ void PBSM3D::run(mesh &domain)
           }
 
           if (debug_output)
-            (*face)["c_salt_fetch_big"_s] = c_salt;
+            (*face)[c_salt_fetch_big_h] = c_salt;
 
           // exp decay of Liston, eq 10
           // 95% of max saltation occurs at fetch = 500m
@@ -634,14 +870,14 @@ void PBSM3D::run(mesh &domain)
           {
             // Essery, Li, and Pomeroy 1999
             // Probability of blowing snow
-            double A = (*face)["p_snow_hours"_s]; // hours since last snowfall
+            double A = (*face)[p_snow_hours_h]; // hours since last snowfall
             double u_mean = 11.2 + 0.365 * T + 0.00706 * T * T +
                             0.9 * log(A); // eqn 10  T -> air temp, degC
             double delta = 0.145 * T + 0.00196 * T * T + 4.3; // eqn 11
             double Pu10 =
                 1.0 /
                 (1.0 + exp((sqrt(M_PI) * (u_mean - u10)) / delta)); // eqn 12
-            (*face)["blowingsnow_probability"_s] = Pu10;
+            (*face)[blowingsnow_probability_h] = Pu10;
 
             // decrease the saltation by the probability amount
             c_salt *= Pu10;
@@ -656,7 +892,7 @@ void PBSM3D::run(mesh &domain)
               hs; // integrate over the depth of the saltation layer, kg/(m*s)
 
           double mass = 0;
-          double phi = (*face)["vw_dir"_s];
+          double phi = (*face)[vw_dir_h];
           Vector_2 v = -math::gis::bearing_to_cartesian(phi);
 
             // setup wind vector
@@ -677,8 +913,8 @@ void PBSM3D::run(mesh &domain)
           mass /= V * global_param->dt();
 
             if (debug_output) {
-                (*face)["csalt_orig"_s] = c_salt;
-                (*face)["mass_qsalt"_s] = mass;
+                (*face)[csalt_orig_h] = c_salt;
+                (*face)[mass_qsalt_h] = mass;
             }
 
 
@@ -697,11 +933,11 @@ void PBSM3D::run(mesh &domain)
         }
 
         if (debug_output)
-          (*face)["csalt"_s] = c_salt;
+          (*face)[csalt_h] = c_salt;
 
-        (*face)["Qsalt"_s] = Qsalt;
+        (*face)[Qsalt_h] = Qsalt;
 
-        double rh = (*face)["rh"_s] / 100.;
+        double rh = (*face)[rh_h] / 100.;
         double es = mio::Atmosphere::saturatedVapourPressure(t);
         double ea = rh * es / 1000.; // ea needs to be in kpa
 
@@ -771,7 +1007,7 @@ void PBSM3D::run(mesh &domain)
           // This is 'r_r' in Pomeroy and Gray 1995, eqn 50
           double rm = 4.6e-5 * pow(cz, -0.258);
           if (debug_output)
-            (*face)["rm" + std::to_string(z)] = rm;
+            (*face)[rm_z_h.at(z)] = rm;
 
           // calculate mean mass, eqn 23, 24 in Pomeroy 1993 (PBSM)
           // 52, 53 P&G 1995
@@ -784,7 +1020,7 @@ void PBSM3D::run(mesh &domain)
           double r_z =
               pow((3.0 * mm) / (4 * M_PI * rho_p), 0.33); // 50 in p&g 1995
           if (debug_output)
-            (*face)["mm"_s] = mm;
+            (*face)[mm_h] = mm;
 
           double xrz = 0.005 * pow(u_z, 1.36); // eqn 16
 
@@ -796,7 +1032,7 @@ void PBSM3D::run(mesh &domain)
           }
 
           if (debug_output)
-            (*face)["settling_velocity" + std::to_string(z)] = omega;
+            (*face)[settling_velocity_z_h.at(z)] = omega;
           double Vr = omega + 3.0 * xrz * cos(M_PI / 4.0); // eqn 14
 
           double v = 1.88e-5; // kinematic viscosity of air, below eqn 13 in
@@ -903,14 +1139,14 @@ void PBSM3D::run(mesh &domain)
                      lambda_t * t * t * Nu * R);
           }
           if (debug_output)
-            (*face)["dm/dt"_s] = dmdtz;
+            (*face)[dm_dt_h] = dmdtz;
 
           if (debug_output)
-            (*face)["mm"_s] = mm;
+            (*face)[mm_h] = mm;
           double csubl = dmdtz / mm; // EQN 21 POMEROY 1993 (PBSM)
 
           if (debug_output)
-            (*face)["csubl" + std::to_string(z)] = dmdtz;
+            (*face)[csubl_z_h.at(z)] = dmdtz;
 
           // eddy diffusivity (m^2/s)
           // 0,1,2 will all be K = 0, as no horizontal diffusion process
@@ -939,11 +1175,11 @@ void PBSM3D::run(mesh &domain)
           double l = PhysConst::kappa * (cz + d->z0) * l__max /
                      (PhysConst::kappa * (cz + d->z0) + l__max);
           if (debug_output)
-            (*face)["l"_s] = l;
+            (*face)[l_h] = l;
 
           double w = omega; // settling_velocity;
           if (debug_output)
-            (*face)["w"_s] = w;
+            (*face)[w_h] = w;
 
           double diffusion_coeff =
               snow_diffusion_const; // snow_diffusion_const is a shared param so
@@ -957,7 +1193,7 @@ void PBSM3D::run(mesh &domain)
                 dc; // nope, snow_diffusion_const is shared, use a new
           }
           if (debug_output)
-            (*face)["Km_coeff"_s] = diffusion_coeff;
+            (*face)[Km_coeff_h] = diffusion_coeff;
 
           // snow_diffusion_const is pretty much a calibration constant. At 1 it
           // seems to over predict transports.
@@ -966,13 +1202,13 @@ void PBSM3D::run(mesh &domain)
           K[3] = K[4] = diffusion_coeff * ustar * l;
 
           if (debug_output)
-            (*face)["K" + std::to_string(z)] = K[3];
+            (*face)[K_z_h.at(z)] = K[3];
           // top
           alpha[3] = d->A[3] * K[3] / v_edge_height;
           // bottom
           alpha[4] = d->A[4] * K[4] / v_edge_height;
 
-          double phi = (*face)["vw_dir"_s]; // wind direction
+          double phi = (*face)[vw_dir_h]; // wind direction
           Vector_2 vwind = -math::gis::bearing_to_cartesian(phi);
 
           // setup wind vector
@@ -989,7 +1225,7 @@ void PBSM3D::run(mesh &domain)
           uvw(2) = -w;
 
           if (debug_output)
-            (*face)["u_z" + std::to_string(z)] = u_z;
+            (*face)[u_z_z_h.at(z)] = u_z;
 
           // negate as direction it's blowing instead of where it is from!!
           Vector_3 v3(-uvw(0), -uvw(1), uvw(2));
@@ -1017,7 +1253,7 @@ void PBSM3D::run(mesh &domain)
           csubl /= 5.0;
           V /= 5.0;
           if (debug_output)
-            (*face)["csubl" + std::to_string(z)] = csubl;
+            (*face)[csubl_z_h.at(z)] = csubl;
           if (!do_sublimation)
           {
             csubl = 0.0;
@@ -1190,6 +1426,7 @@ void PBSM3D::run(mesh &domain)
   viennacl::context gpu_ctx(viennacl::OPENCL_MEMORY);
   vl_C.switch_memory_context(gpu_ctx);
   b.switch_memory_context(gpu_ctx);
+  x_prev.switch_memory_context(gpu_ctx);
 #endif
 
   // This solves the steady-state suspension layer concentration
@@ -1199,9 +1436,14 @@ void PBSM3D::run(mesh &domain)
   chow_patel_ilu_config.sweeps(3); //  nonlinear sweeps
   chow_patel_ilu_config.jacobi_iters(
       2); //  Jacobi iterations per triangular 'solve' Rx=r
-  viennacl::linalg::chow_patel_ilu_precond<
-      viennacl::compressed_matrix<vcl_scalar_type>>
-      chow_patel_ilu(vl_C, chow_patel_ilu_config);
+
+  // only the values of vl_C have changed since the last build, so it is still a usable, if less accurate, preconditioner
+  if (!C_precond || C_refresh.stale())
+  {
+    C_precond.reset(new C_precond_type(vl_C, chow_patel_ilu_config));
+    C_refresh.rebuilt();
+    _metrics.suspension_precond_builds++;
+  }
 
   // Set up convergence tolerance to have an average value for each unknown
   double suspension_gmres_tol_per_unknown = 1e-8;
@@ -1213,19 +1455,33 @@ void PBSM3D::run(mesh &domain)
 
   // compute result and copy back to CPU device (if an accelerator was used),
   // otherwise access is slow
-  viennacl::linalg::gmres_tag suspension_custom_gmres(
-      suspension_gmres_tol, suspension_gmres_max_iterations,
-      suspension_gmres_krylov_dimension);
-  viennacl::vector<vcl_scalar_type> vl_x =
-      viennacl::linalg::solve(vl_C, b, suspension_custom_gmres, chow_patel_ilu);
+  size_t suspension_iters = 0;
+  double suspension_error = 0;
+  viennacl::vector<vcl_scalar_type> vl_x = warm_solve(vl_C, b, x_prev, suspension_gmres_tol, warm_start,
+      [&](const viennacl::vector<vcl_scalar_type>& rhs, double tol) -> viennacl::vector<vcl_scalar_type>
+      {
+        viennacl::linalg::gmres_tag suspension_custom_gmres(
+            tol, suspension_gmres_max_iterations,
+            suspension_gmres_krylov_dimension);
+        viennacl::vector<vcl_scalar_type> y =
+            viennacl::linalg::solve(vl_C, rhs, suspension_custom_gmres, *C_precond);
+        suspension_iters = suspension_custom_gmres.iters();
+        suspension_error = suspension_custom_gmres.error();
+        return y;
+      });
   std::vector<vcl_scalar_type> x(vl_x.size());
   viennacl::copy(vl_x, x);
 
   // Log final state of the linear solve
   LOG_DEBUG << "Suspension_GMRES # of iterations: "
-            << suspension_custom_gmres.iters();
+            << suspension_iters;
   LOG_DEBUG << "Suspension_GMRES final residual : "
-            << suspension_custom_gmres.error();
+            << suspension_error;
+
+  C_refresh.solved(suspension_iters, suspension_gmres_max_iterations);
+
+  _metrics.suspension_iters = suspension_iters;
+  _metrics.suspension_total_iters += suspension_iters;
 
   /*
     Dump matrix to ASCII file
@@ -1270,20 +1526,20 @@ void PBSM3D::run(mesh &domain)
 
         if (debug_output)
         {
-            (*face)["c" + std::to_string(z)] = c;
+            (*face)[c_z_h.at(z)] = c;
 
             // This is an approximation as it uses after transport concentrations.
             // However this will have already taken into account sublimation during the coupled transport phase
             // Eqn 20 Pomeroy 1993
-            Qsubl += (*face)["csubl" + std::to_string(z)] * c * v_edge_height; // kg/(m^2 *s) => per unit area of snowcover
+            Qsubl += (*face)[csubl_z_h.at(z)] * c * v_edge_height; // kg/(m^2 *s) => per unit area of snowcover
         }
       }
-      (*face)["Qsusp"_s] = Qsusp;
+      (*face)[Qsusp_h] = Qsusp;
       if (debug_output)
       {
-          (*face)["Qsubl"_s] = Qsubl;
-          (*face)["Qsubl_mass"_s] += Qsubl * global_param->dt();             // kg/m^2 or mm
-          (*face)["sum_subl"_s] += (*face)["Qsubl_mass"_s];
+          (*face)[Qsubl_h] = Qsubl;
+          (*face)[Qsubl_mass_h] += Qsubl * global_param->dt();             // kg/m^2 or mm
+          (*face)[sum_subl_h] += (*face)[Qsubl_mass_h];
       }
 
   }
@@ -1323,7 +1579,7 @@ void PBSM3D::run(mesh &domain)
       auto d = face->get_module_data<data>(ID);
       auto &m = d->m;
 
-      double phi = (*face)["vw_dir"_s];
+      double phi = (*face)[vw_dir_h];
       Vector_2 v = -math::gis::bearing_to_cartesian(phi);
 
       // setup wind vector
@@ -1359,8 +1615,8 @@ void PBSM3D::run(mesh &domain)
         if (d->face_neigh[j])
         {
           auto neigh = face->neighbor(j);
-          auto Qtj = (*neigh)["Qsusp"_s] + (*face)["Qsusp"_s];
-          auto Qsj = (*neigh)["Qsalt"_s] + (*face)["Qsalt"_s];
+          auto Qtj = (*neigh)[Qsusp_h] + (*face)[Qsusp_h];
+          auto Qsj = (*neigh)[Qsalt_h] + (*face)[Qsalt_h];
           double Qt = Qtj / 2.0 + Qsj / 2.0;
 
           dx[j] = math::gis::distance(face->center(), neigh->center());
@@ -1376,8 +1632,8 @@ void PBSM3D::run(mesh &domain)
         else
         {
           auto Qtj =
-              2. * (*face)["Qsusp"_s]; // const flux across, 0 -> drifts!!!
-          auto Qsj = 2. * (*face)["Qsalt"_s];
+              2. * (*face)[Qsusp_h]; // const flux across, 0 -> drifts!!!
+          auto Qsj = 2. * (*face)[Qsalt_h];
           double Qt = Qtj / 2.0 + Qsj / 2.0;
           A_elements[i_i_off] += V;
           bb[i] += -E[j] * Qt * udotm[j];
@@ -1393,6 +1649,7 @@ void PBSM3D::run(mesh &domain)
   //    defined above
   vl_A.switch_memory_context(gpu_ctx);
   bb.switch_memory_context(gpu_ctx);
+  dSdt_prev.switch_memory_context(gpu_ctx);
 #endif
 
   // Solve the deposition flux --> how much drifting there is.
@@ -1402,9 +1659,13 @@ void PBSM3D::run(mesh &domain)
   deposition_flux_chow_patel_config.sweeps(3); //  nonlinear sweeps
   deposition_flux_chow_patel_config.jacobi_iters(
       2); //  Jacobi iterations per triangular 'solve' Rx=r
-  viennacl::linalg::chow_patel_icc_precond<
-      viennacl::compressed_matrix<vcl_scalar_type>>
-      deposition_flux_chow_patel_icc(vl_A, deposition_flux_chow_patel_config);
+
+  if (!A_precond || A_refresh.stale())
+  {
+    A_precond.reset(new A_precond_type(vl_A, deposition_flux_chow_patel_config));
+    A_refresh.rebuilt();
+    _metrics.deposition_precond_builds++;
+  }
 
   // Set up convergence tolerance to have an average value for each unknown
   double deposition_flux_cg_tol_per_unknown = 1e-7;
@@ -1414,23 +1675,33 @@ void PBSM3D::run(mesh &domain)
 
   // compute result and copy back to CPU device (if an accelerator was used),
   // otherwise access is slow
-  viennacl::linalg::cg_tag deposition_flux_custom_cg(
-      deposition_flux_cg_tol, deposition_flux_cg_max_iterations);
-
-  // compute result and copy back to CPU device (if an accelerator was used),
-  // otherwise access is slow
-  viennacl::vector<vcl_scalar_type> vl_dSdt = viennacl::linalg::solve(
-      vl_A, bb, deposition_flux_custom_cg, deposition_flux_chow_patel_icc);
-  // viennacl::vector<vcl_scalar_type> vl_dSdt = viennacl::linalg::solve(vl_A,
-  // bb, deposition_flux_custom_cg);
+  size_t deposition_iters = 0;
+  double deposition_error = 0;
+  viennacl::vector<vcl_scalar_type> vl_dSdt = warm_solve(vl_A, bb, dSdt_prev, deposition_flux_cg_tol, warm_start,
+      [&](const viennacl::vector<vcl_scalar_type>& rhs, double tol) -> viennacl::vector<vcl_scalar_type>
+      {
+        viennacl::linalg::cg_tag deposition_flux_custom_cg(
+            tol, deposition_flux_cg_max_iterations);
+        viennacl::vector<vcl_scalar_type> y =
+            viennacl::linalg::solve(vl_A, rhs, deposition_flux_custom_cg, *A_precond);
+        deposition_iters = deposition_flux_custom_cg.iters();
+        deposition_error = deposition_flux_custom_cg.error();
+        return y;
+      });
   std::vector<vcl_scalar_type> dSdt(vl_dSdt.size());
   viennacl::copy(vl_dSdt, dSdt);
 
   // Log final state of the linear solve
   LOG_DEBUG << "deposition_flux_CG # of iterations: "
-            << deposition_flux_custom_cg.iters();
+            << deposition_iters;
   LOG_DEBUG << "deposition_flux_CG final residual : "
-            << deposition_flux_custom_cg.error();
+            << deposition_error;
+
+  A_refresh.solved(deposition_iters, deposition_flux_cg_max_iterations);
+
+  _metrics.deposition_iters = deposition_iters;
+  _metrics.deposition_total_iters += deposition_iters;
+  _metrics.timesteps++;
 
   // take one FE integration step to get the total mass (SWE) that is eroded or
   // deposited
@@ -1448,13 +1719,24 @@ void PBSM3D::run(mesh &domain)
 
       mass = qdep * global_param->dt(); // kg/m^2*s *dt -> kg/m^2
 
-      (*face)["drift_mass"_s] = mass;
+      (*face)[drift_mass_h] = mass;
       d->sum_drift += mass;
 
-      (*face)["sum_drift"_s] = d->sum_drift;
+      (*face)[sum_drift_h] = d->sum_drift;
 
   }
 
 }
 
-PBSM3D::~PBSM3D() {}
+PBSM3D::~PBSM3D()
+{
+  if (_metrics.timesteps + _metrics.skipped_timesteps > 0)
+  {
+    double n = std::max<size_t>(1, _metrics.timesteps);
+    LOG_DEBUG << "PBSM3D mean solver iterations per timestep: suspension "
+              << _metrics.suspension_total_iters / n << ", deposition "
+              << _metrics.deposition_total_iters / n << ". Preconditioner builds: suspension "
+              << _metrics.suspension_precond_builds << ", deposition " << _metrics.deposition_precond_builds
+              << ". " << _metrics.skipped_timesteps << " timesteps without blowing snow were skipped";
+  }
+}
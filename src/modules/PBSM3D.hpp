@@ -25,10 +25,12 @@
 //#define BOOST_MATH_INSTRUMENT
 #include "logger.hpp"
 #include "triangulation.hpp"
+#include "activity_mask.hpp"
 #include "module_base.hpp"
 #include "interpolation.hpp"
 
 #include "math/coordinates.hpp"
+#include "math/precond_refresh.hpp"
 
 #include <constants/PhysConst.h>
 #include "constants/Atmosphere.h"
@@ -36,6 +38,7 @@
 #include <meteoio/MeteoIO.h>
 
 #include <cmath>
+#include <memory>
 #include <vector>
 #include <gsl/gsl_sf_lambert.h>
 
@@ -44,6 +47,8 @@
 #include <viennacl/compressed_matrix.hpp>
 #include <viennacl/linalg/ilu.hpp>
 #include <viennacl/linalg/cg.hpp>
+#include <viennacl/linalg/norm_2.hpp>
+#include <viennacl/linalg/prod.hpp>
 
 
 
@@ -88,6 +93,26 @@ public:
     void run(mesh& domain);
     void init(mesh& domain);
 
+    // saves the accumulated drift and sublimation; everything else is rebuilt by init() or each timestep
+    void checkpoint(mesh& domain, netcdf& chkpt);
+    void load_checkpoint(mesh& domain, netcdf& chkpt);
+
+    // iteration counts of the linear solves, for monitoring the solver cost
+    struct solver_metrics
+    {
+        solver_metrics();
+
+        size_t suspension_iters; // last timestep
+        size_t deposition_iters; // last timestep
+        size_t suspension_total_iters;
+        size_t deposition_total_iters;
+        size_t suspension_precond_builds;
+        size_t deposition_precond_builds;
+        size_t timesteps;
+        size_t skipped_timesteps; // no face could saltate, see saltation_mask
+    };
+    const solver_metrics& metrics() const;
+
     double nLayer;
     double susp_depth;
     double v_edge_height;
@@ -131,6 +156,25 @@ public:
     viennacl::compressed_matrix<vcl_scalar_type>  vl_A;
     viennacl::vector<vcl_scalar_type> bb;
 
+    // The sparsity pattern is fixed in init and consecutive timesteps are similar. So the preconditioners are kept
+    // until a solve needs precond_refresh_ratio times the iterations it took right after the last rebuild (or doesn't
+    // converge), and with warm_start the solves start from the previous timestep's solution.
+    typedef viennacl::linalg::chow_patel_ilu_precond< viennacl::compressed_matrix<vcl_scalar_type> > C_precond_type;
+    typedef viennacl::linalg::chow_patel_icc_precond< viennacl::compressed_matrix<vcl_scalar_type> > A_precond_type;
+    std::unique_ptr<C_precond_type> C_precond;
+    std::unique_ptr<A_precond_type> A_precond;
+    precond_refresh C_refresh;
+    precond_refresh A_refresh;
+
+    bool warm_start;
+    viennacl::vector<vcl_scalar_type> x_prev; // last suspension concentrations
+    viennacl::vector<vcl_scalar_type> dSdt_prev; // last deposition flux
+
+    solver_metrics _metrics;
+
+    // faces that may saltate this timestep. If there are none the whole timestep is skipped
+    activity_mask saltation_mask;
+
     double debug_output;
     double cutoff; // cutoff veg-snow diff (m) that we inhibit saltation entirely
     // don't allow transport if below this threshold.
@@ -175,6 +219,52 @@ public:
         double sum_subl;
     };
 
+    // resolved in init so the per-face loops don't hash the names
+    var_handle U_2m_above_srf_h;
+    var_handle vw_dir_h;
+    var_handle swe_h;
+    var_handle t_h;
+    var_handle rh_h;
+    var_handle U_R_h;
+    var_handle drift_mass_h;
+    var_handle Qsusp_h;
+    var_handle Qsalt_h;
+    var_handle sum_drift_h;
+    var_handle blowingsnow_probability_h;
+    var_handle fetch_h;
+    var_handle p_snow_hours_h;
+    var_handle snowdepthavg_h;
+    var_handle is_drifting_h;
+    var_handle Km_coeff_h;
+    var_handle Qsusp_pbsm_h;
+    var_handle height_diff_h;
+    var_handle w_h;
+    var_handle hs_h;
+    var_handle ustar_h;
+    var_handle l_h;
+    var_handle z0_h;
+    var_handle lambda_h;
+    var_handle U_10m_h;
+    var_handle csalt_h;
+    var_handle csalt_orig_h;
+    var_handle mass_qsalt_h;
+    var_handle c_salt_fetch_big_h;
+    var_handle u_star_th_h;
+    var_handle tau_n_ratio_h;
+    var_handle dm_dt_h;
+    var_handle mm_h;
+    var_handle Qsubl_h;
+    var_handle Qsubl_mass_h;
+    var_handle sum_subl_h;
+
+    // per suspension layer debug outputs, indexed by layer
+    std::vector<var_handle> K_z_h;
+    std::vector<var_handle> c_z_h;
+    std::vector<var_handle> rm_z_h;
+    std::vector<var_handle> csubl_z_h;
+    std::vector<var_handle> settling_velocity_z_h;
+    std::vector<var_handle> u_z_z_h;
+
 
 };
 
@@ -46,19 +46,24 @@ void Richard_albedo::checkpoint(mesh& domain,  netcdf& chkpt)
 
     chkpt.create_variable1D("Richard_albedo:albedo", domain->size_faces());
 
+    std::vector<double> albedo(domain->size_faces());
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
-        chkpt.put_var1D("Richard_albedo:albedo",i,face->get_module_data<Richard_albedo::data>(ID)->albedo);
+        albedo[i] = face->get_module_data<Richard_albedo::data>(ID)->albedo;
     }
+    chkpt.put_var1D("Richard_albedo:albedo", albedo.data(), albedo.size());
 }
 
 void Richard_albedo::load_checkpoint(mesh& domain,  netcdf& chkpt)
 {
+    std::vector<double> albedo(domain->size_faces());
+    chkpt.get_var1D("Richard_albedo:albedo", albedo.data(), albedo.size());
+
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
-        face->get_module_data<Richard_albedo::data>(ID)->albedo = chkpt.get_var1D("Richard_albedo:albedo",i);
+        face->get_module_data<Richard_albedo::data>(ID)->albedo = albedo[i];
     }
 }
 
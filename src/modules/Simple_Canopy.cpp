@@ -70,16 +70,16 @@ void Simple_Canopy::run(mesh_elem &face)
     auto data = face->get_module_data<Simple_Canopy::data>(ID);
 
     // Get meteorological data for current face
-    double ta           = (*face)["t"_s];
-    double rh           = (*face)["rh"_s];
-    double U_R          = (*face)["U_R"_s];
-    double iswr         = (*face)["iswr"_s]; // SW in above canopy
-    double Qdfo         = (*face)["iswr_diffuse"_s]; // "clear-sky diffuse", "(W/m^2)"
-    double ilwr         = (*face)["ilwr"_s]; // LW in above canopy
-    double p_rain       = (*face)["p_rain"_s]; // rain (mm/timestep) above canopy
-    double p_snow       = (*face)["p_snow"_s]; // snow (mm/timestep) above canopy
-    double snowdepthavg = (*face)["snowdepthavg"_s];
-    double Albedo       = (*face)["snow_albedo"_s]; // Broad band snow albedo
+    double ta           = (*face)[t_h];
+    double rh           = (*face)[rh_h];
+    double U_R          = (*face)[U_R_h];
+    double iswr         = (*face)[iswr_h]; // SW in above canopy
+    double Qdfo         = (*face)[iswr_diffuse_h]; // "clear-sky diffuse", "(W/m^2)"
+    double ilwr         = (*face)[ilwr_h]; // LW in above canopy
+    double p_rain       = (*face)[p_rain_h]; // rain (mm/timestep) above canopy
+    double p_snow       = (*face)[p_snow_h]; // snow (mm/timestep) above canopy
+    double snowdepthavg = (*face)[snowdepthavg_h];
+    double Albedo       = (*face)[snow_albedo_h]; // Broad band snow albedo
     double air_pressure = 915; //(*face)["air_pressure"_s]; //"Average surface pressure", "(kPa)" TODO: Get from face_data
 
     // Checks on boundary conditions
@@ -151,8 +151,8 @@ void Simple_Canopy::run(mesh_elem &face)
     double Zvent            = 0.75; //", "0.0", "1.0", "ventilation wind speed height (z/Ht)", "()", &Zvent);
     double unload_t         = 1.0; //", "-10.0", "20.0", "if ice-bulb temp >= t : canopy snow is unloaded as snow", "(°C)", &unload_t);
     double unload_t_water   = 4.0; //", "-10.0", "20.0", "if ice-bulb temp >= t: canopy snow is unloaded as water", "(°C)", &unload_t_water);
-    double SolAng           = (*face)["solar_el"_s] * mio::Cst::to_rad; // degrees to radians (assumed horizontal)
-    double cosxs            = (*face)["solar_angle"_s]; // "cosine of the angle of incidence on the slope", "()"
+    double SolAng           = (*face)[solar_el_h] * mio::Cst::to_rad; // degrees to radians (assumed horizontal)
+    double cosxs            = (*face)[solar_angle_h]; // "cosine of the angle of incidence on the slope", "()"
     double cosxsflat        = cos(SolAng); // "cosine of the angle of incidence on the horizontal"
     double Surrounding_Ht   = data->CanopyHeight; //""[0.1, 0.25, 1.0]", "0.001", "100.0", "surrounding canopy height", "()", &Surrounding_Ht);
     double Gap_diameter     = 100; // "[100]", "10", "1000", "representative gap diameter", "(m)", &Gap_diameter); TODO: hardcod gap diamter, need to get from lidar if available
@@ -559,23 +559,49 @@ void Simple_Canopy::run(mesh_elem &face)
 
 
     // Output computed canopy states and fluxes downward to snowpack and upward to atmosphere
-    (*face)["snow_load"_s]=data->Snow_load;
-    (*face)["rain_load"_s]=data->rain_load;
-    (*face)["ts_canopy"_s]=Ts;
-    (*face)["ta_subcanopy"_s]=ta;
-    (*face)["rh_subcanopy"_s]=rh;
-    (*face)["iswr_subcanopy"_s]=Qsisn; // (W/m^2)
-    (*face)["ilwr_subcanopy"_s]=Qlisn; // (W/m^2)
-    (*face)["p_rain_subcanopy"_s]=net_rain; // (mm/int)
-    (*face)["p_snow_subcanopy"_s]=net_snow; // (mm/int)
-    (*face)["p_subcanopy"_s]=net_p; // Total precip (mm/int)
-    (*face)["frac_precip_rain_subcanopy"_s]=net_rain/net_p; // Fraction rain (-)
-    (*face)["frac_precip_snow_subcanopy"_s]=net_snow/net_p; // Fraction snow (-)
+    (*face)[snow_load_h]=data->Snow_load;
+    (*face)[rain_load_h]=data->rain_load;
+    (*face)[ts_canopy_h]=Ts;
+    (*face)[ta_subcanopy_h]=ta;
+    (*face)[rh_subcanopy_h]=rh;
+    (*face)[iswr_subcanopy_h]=Qsisn; // (W/m^2)
+    (*face)[ilwr_subcanopy_h]=Qlisn; // (W/m^2)
+    (*face)[p_rain_subcanopy_h]=net_rain; // (mm/int)
+    (*face)[p_snow_subcanopy_h]=net_snow; // (mm/int)
+    (*face)[p_subcanopy_h]=net_p; // Total precip (mm/int)
+    (*face)[frac_precip_rain_subcanopy_h]=net_rain/net_p; // Fraction rain (-)
+    (*face)[frac_precip_snow_subcanopy_h]=net_snow/net_p; // Fraction snow (-)
 
 }
 
 void Simple_Canopy::init(mesh& domain)
 {
+    t_h = handle("t");
+    rh_h = handle("rh");
+    U_R_h = handle("U_R");
+    iswr_h = handle("iswr");
+    iswr_diffuse_h = handle("iswr_diffuse");
+    ilwr_h = handle("ilwr");
+    p_rain_h = handle("p_rain");
+    p_snow_h = handle("p_snow");
+    snowdepthavg_h = handle("snowdepthavg");
+    snow_albedo_h = handle("snow_albedo");
+    snow_load_h = handle("snow_load");
+    rain_load_h = handle("rain_load");
+    ts_canopy_h = handle("ts_canopy");
+    ta_subcanopy_h = handle("ta_subcanopy");
+    rh_subcanopy_h = handle("rh_subcanopy");
+    iswr_subcanopy_h = handle("iswr_subcanopy");
+    ilwr_subcanopy_h = handle("ilwr_subcanopy");
+    p_rain_subcanopy_h = handle("p_rain_subcanopy");
+    p_snow_subcanopy_h = handle("p_snow_subcanopy");
+    p_subcanopy_h = handle("p_subcanopy");
+    frac_precip_rain_subcanopy_h = handle("frac_precip_rain_subcanopy");
+    frac_precip_snow_subcanopy_h = handle("frac_precip_snow_subcanopy");
+
+    // not declared as depends, these come from the solar module
+    solar_el_h = domain->variable_handle("solar_el");
+    solar_angle_h = domain->variable_handle("solar_angle");
 
     #pragma omp parallel for
     // For each face
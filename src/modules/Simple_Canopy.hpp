@@ -77,6 +77,32 @@ public:
         double cum_SUnload_H2O;
     };
 
+    // resolved in init so run() doesn't hash the names
+    var_handle t_h;
+    var_handle rh_h;
+    var_handle U_R_h;
+    var_handle iswr_h;
+    var_handle iswr_diffuse_h;
+    var_handle ilwr_h;
+    var_handle p_rain_h;
+    var_handle p_snow_h;
+    var_handle snowdepthavg_h;
+    var_handle snow_albedo_h;
+    var_handle snow_load_h;
+    var_handle rain_load_h;
+    var_handle ts_canopy_h;
+    var_handle ta_subcanopy_h;
+    var_handle rh_subcanopy_h;
+    var_handle iswr_subcanopy_h;
+    var_handle ilwr_subcanopy_h;
+    var_handle p_rain_subcanopy_h;
+    var_handle p_snow_subcanopy_h;
+    var_handle p_subcanopy_h;
+    var_handle frac_precip_rain_subcanopy_h;
+    var_handle frac_precip_snow_subcanopy_h;
+    var_handle solar_el_h;
+    var_handle solar_angle_h;
+
 
 
 };
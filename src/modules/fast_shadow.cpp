@@ -39,6 +39,29 @@ fast_shadow::fast_shadow(config_file cfg)
 
     //size of the step to take
     size_of_step = max_distance / steps;
+
+    azimuth_bins = cfg.get("azimuth_bins",0);
+
+    horizon_sectors = cfg.get("horizon_sectors",0);
+    horizon_file = cfg.get("horizon_file","");
+
+    // the horizon table is only built at init, so it would keep shadowing the undeformed terrain
+    if (horizon_sectors > 0)
+        conflicts("deform_mesh");
+}
+
+void fast_shadow::init(mesh& domain)
+{
+    auto distances = face_stencil::uniform_steps(steps, size_of_step);
+
+    if (horizon_sectors > 0)
+    {
+        horizon = domain->horizon_angles(horizon_sectors, distances, horizon_file);
+    }
+    else if (azimuth_bins > 0)
+    {
+        stencil = domain->directional_stencil(azimuth_bins, distances);
+    }
 }
 
 fast_shadow::~fast_shadow()
@@ -59,7 +82,15 @@ void fast_shadow::run(mesh_elem& face)
 
     double solar_az = (*face)["solar_az"_s] ;
 
+    if (horizon)
+    {
+        if (horizon->horizon(face->cell_local_id, solar_az) > solar_el)
+            (*face)["shadow"_s]= 1;
+        return;
+    }
+
     Point_3 me = face->center();
+    size_t k = stencil ? stencil->bin(solar_az) : 0;
 
     double phi = 0.;
     // search along each azimuth in j step increments to find horizon angle
@@ -67,7 +98,7 @@ void fast_shadow::run(mesh_elem& face)
     {
         double distance = j * size_of_step;
 
-        auto f = face->find_closest_face(solar_az, distance);
+        auto f = stencil ? face->stencil_face(*stencil, k, j - 1) : face->find_closest_face(solar_az, distance);
 
         double z_diff = f->center().z() - me.z() ;
         if (z_diff > 0)
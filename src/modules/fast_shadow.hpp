@@ -28,10 +28,33 @@
 #include "module_base.hpp"
 #include "TPSpline.hpp"
 
-// Calculates horizon shadows using an adaptation of Dozier and Frew 1990 to an unstructured mesh
-//Dozier, J., & Frew, J. (1990).
-// Rapid calculation of terrain parameters for radiation modeling from digital elevation data.
-// IEEE Transactions on Geoscience and Remote, 28(5), 963–969.
+/**
+* \addtogroup modules
+* @{
+* \class fast_shadow
+* \brief Calculates horizon shadows using an adaptation of Dozier and Frew 1990 to an unstructured mesh
+*
+* Config:
+* - "steps" Number of steps along the search vector to check for a higher point. Default 10.
+* - "max_distance" Distance to search [m]. Default 1000.
+* - "azimuth_bins" If > 0, the search walks a directional stencil of this many azimuths, with the solar azimuth rounded
+*   to the nearest one, instead of making a kd-tree query per step. Costs 4 bytes per face, bin and step. Default 0.
+* - "horizon_sectors" If > 0, the horizon angle is computed once at init for this many sectors (e.g., 72) and the
+*   shadow is an interpolated lookup against solar_el. Costs 4 bytes per face and sector. Can't be used with
+*   deform_mesh. Default 0.
+* - "horizon_file" Optional file to cache the horizon_sectors table in.
+*
+* Depends:
+* - Solar azimuth "solar_az" [degrees]
+* - Solar elevation "solar_el" [degrees]
+*
+* Provides:
+* - Binary shadow value "shadow" [1 (shadowed) / 0]
+*
+* Reference:
+* > Dozier, J., & Frew, J. (1990). Rapid calculation of terrain parameters for radiation modeling from digital
+* elevation data. IEEE Transactions on Geoscience and Remote, 28(5), 963–969.
+*/
 class fast_shadow : public module_base
 {
 REGISTER_MODULE_HPP(fast_shadow);
@@ -42,6 +65,8 @@ public:
 
     virtual void run(mesh_elem& face);
 
+    virtual void init(mesh& domain);
+
 //number of steps along the search vector to check for a higher point
     int steps;
     //max distance to search
@@ -50,4 +75,15 @@ public:
     //size of the step to take
     double size_of_step;
 
+    size_t azimuth_bins;
+    boost::shared_ptr<const face_stencil> stencil;
+
+    size_t horizon_sectors;
+    std::string horizon_file;
+    boost::shared_ptr<const horizon_table> horizon;
+
 };
+
+/**
+@}
+*/
@@ -46,6 +46,15 @@ fetchr::fetchr(config_file cfg)
 
     h_IBL = 5;
 
+    azimuth_bins = cfg.get("azimuth_bins",0);
+}
+
+void fetchr::init(mesh& domain)
+{
+    if (azimuth_bins > 0)
+    {
+        stencil = domain->directional_stencil(azimuth_bins, face_stencil::uniform_steps(steps, size_of_step));
+    }
 }
 
 fetchr::~fetchr()
@@ -76,12 +85,14 @@ void fetchr::run(mesh_elem& face)
 
     }
 
+    size_t k = stencil ? stencil->bin(wind_dir) : 0;
+
     // search along wind_dir azimuth in j step increments
     for (int j = 1; j <= steps; ++j)
     {
         double distance = j * size_of_step;
 
-        auto f = face->find_closest_face(wind_dir, distance);
+        auto f = stencil ? face->stencil_face(*stencil, k, j - 1) : face->find_closest_face(wind_dir, distance);
 
         double Z_CanTop = 0;
         if (incl_veg && f->has_vegetation())
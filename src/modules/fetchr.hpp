@@ -31,6 +31,14 @@
 /**
  * Impliments the fetch algorithm of
  * Lapen, D. R., and L. W. Martz (1993), The measurement of two simple topographic indices of wind sheltering-exposure from raster digital elevation models, Comput. Geosci., 19(6), 769–779, doi:10.1016/0098-3004(93)90049-B.
+ *
+ * Config:
+ * - "steps" Number of steps along the upwind search vector. Default 10.
+ * - "max_distance" Distance to search [m]. Default 1000.
+ * - "I" Obstacle height increment [m/m]. Default 0.06, prairie shelter belts.
+ * - "incl_veg" Include the vegetation height in the obstacle height. Default true.
+ * - "azimuth_bins" Number of upwind azimuths whose faces are found once at init (a face_stencil); the wind direction
+ *   snaps to the nearest. Default 0 looks up the face at every step instead.
  */
 class fetchr : public module_base
 {
@@ -42,6 +50,8 @@ public:
 
     virtual void run(mesh_elem& face);
 
+    virtual void init(mesh& domain);
+
 //number of steps along the search vector to check for a higher point
     int steps;
     //max distance to search
@@ -56,4 +66,7 @@ public:
     //0.06 m/m corresponds to prarie shelter belts
     double I;
 
+    size_t azimuth_bins;
+    boost::shared_ptr<const face_stencil> stencil;
+
 };
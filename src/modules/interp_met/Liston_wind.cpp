@@ -57,7 +57,7 @@ void Liston_wind::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<lwinddata>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 	       d->interp_smoothing.init(interp_alg::tpspline,3,{ {"reuse_LU","true"}});
 
 	       face->coloured = false;
@@ -67,13 +67,15 @@ void Liston_wind::init(mesh& domain)
 
     double curmax = -9999.0;
 
+    // the 8 compass directions, N, NE, E, ... NW
+    auto stencil = domain->directional_stencil(8, std::vector<double>(1, distance));
+
     #pragma omp parallel for
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
 
 	       auto face = domain->face(i);
 
-	       Point_3 me = face->center();
 	       mesh_elem north;
 	       mesh_elem south;
 	       mesh_elem east;
@@ -84,10 +86,10 @@ void Liston_wind::init(mesh& domain)
 	       mesh_elem southeast;
 	       mesh_elem southwest;
 
-	       north = domain->find_closest_face( math::gis::point_from_bearing(me,0,distance) ) ; // me.x(), me.y() + distance
-	       south = domain->find_closest_face( math::gis::point_from_bearing(me,180,distance) ); //me.x(), me.y() - distance
-	       west = domain->find_closest_face(  math::gis::point_from_bearing(me,270,distance) ); //me.x() - distance, me.y()
-	       east = domain->find_closest_face(  math::gis::point_from_bearing(me,90,distance)  ); //me.x() + distance, me.y()
+	       north = face->stencil_face(*stencil, 0, 0); // me.x(), me.y() + distance
+	       south = face->stencil_face(*stencil, 4, 0); //me.x(), me.y() - distance
+	       west = face->stencil_face(*stencil, 6, 0); //me.x() - distance, me.y()
+	       east = face->stencil_face(*stencil, 2, 0); //me.x() + distance, me.y()
 
 	       double z = face->get_z();
 	       double zw = west->get_z();
@@ -100,16 +102,16 @@ void Liston_wind::init(mesh& domain)
 	       double zse = 0.;
 	       double zsw = 0.;
 
-	       northeast = domain->find_closest_face(math::gis::point_from_bearing(me,45,distance)); //me.x() + distance, me.y() + distance
+	       northeast = face->stencil_face(*stencil, 1, 0); //me.x() + distance, me.y() + distance
 	       zne = northeast->get_z();
 
-	       northwest = domain->find_closest_face(math::gis::point_from_bearing(me,315,distance)); //me.x() - distance, me.y() + distance
+	       northwest = face->stencil_face(*stencil, 7, 0); //me.x() - distance, me.y() + distance
 	       znw = northwest->get_z();
 
-	       southeast = domain->find_closest_face(math::gis::point_from_bearing(me,135,distance)); //me.x() + distance, me.y() - distance
+	       southeast = face->stencil_face(*stencil, 3, 0); //me.x() + distance, me.y() - distance
 	       zse = southeast->get_z();
 
-	       southwest = domain->find_closest_face(math::gis::point_from_bearing(me,225,distance)); //me.x() - distance, me.y() - distance
+	       southwest = face->stencil_face(*stencil, 5, 0); //me.x() - distance, me.y() - distance
 	       zsw = southwest->get_z();
 
 	       double curve = .25 * ((z - .5 * (zw + ze)) / (2.0 * distance) + (z - .5 * (zs + zn)) / (2.0 * distance) +
@@ -172,7 +174,7 @@ void Liston_wind::run(mesh& domain)
 
 	       std::vector<boost::tuple<double, double, double> > u;
 	       std::vector<boost::tuple<double, double, double> > v;
-	       for (auto &s : global_param->get_stations(face->get_x(), face->get_y()))
+	       for (auto &s : face->stations())
 	       {
 		   if (is_nan(s->get("U_R")) || is_nan(s->get("vw_dir")))
 		     continue;
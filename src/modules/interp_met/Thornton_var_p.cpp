@@ -53,7 +53,7 @@ void Thornton_var_p::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<data>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 
     }
 
@@ -74,7 +74,7 @@ void Thornton_var_p::run(mesh_elem& face)
     //otherwise, just used the stored lapse rate
     if(last_update != global_param->posix_time() )
     {
-        for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+        for (auto& s : face->stations())
         {
             if( is_nan(s->get("p")))
                 continue;
@@ -125,7 +125,7 @@ void Thornton_var_p::run(mesh_elem& face)
     //now do the full interpolation
     std::vector< boost::tuple<double, double, double> > ppt;
     std::vector< boost::tuple<double, double, double> > station_z;
-    for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+    for (auto& s : face->stations())
     {
         if( is_nan(s->get("t")))
             continue;
@@ -78,7 +78,7 @@ void WindNinja::init(mesh& domain)
     {
         auto face = domain->face(i);
         auto d = face->make_module_data<data>(ID);
-        d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+        d->interp.init(global_param->interp_algorithm,face->stations().size());
         d->interp_smoothing.init(interp_alg::tpspline,3,{ {"reuse_LU","true"}});
     }
 
@@ -87,6 +87,31 @@ void WindNinja::init(mesh& domain)
     Min_spdup = cfg.get("Min_spdup",0.1);
     ninja_recirc = cfg.get("ninja_recirc",false);
     N_windfield = cfg.get("N_windfield",24);
+
+    // the windfield library is stored as parameters Ninja<d>, Ninja<d>_U, Ninja<d>_V for d = 1..N_windfield
+    ninja_W.resize(N_windfield + 1);
+    ninja_U.resize(N_windfield + 1);
+    ninja_V.resize(N_windfield + 1);
+    for (int d = 1; d <= N_windfield; d++)
+    {
+        ninja_W[d] = domain->parameter_handle("Ninja" + std::to_string(d));
+        ninja_U[d] = domain->parameter_handle("Ninja" + std::to_string(d) + "_U");
+        ninja_V[d] = domain->parameter_handle("Ninja" + std::to_string(d) + "_V");
+    }
+
+    U_R_h = handle("U_R");
+    Ninja_speed_h = handle("Ninja_speed");
+    Ninja_speed_nodown_h = handle("Ninja_speed_nodown");
+    vw_dir_h = handle("vw_dir");
+    vw_dir_orig_h = handle("vw_dir_orig");
+    Ninja_u_h = handle("Ninja_u");
+    Ninja_v_h = handle("Ninja_v");
+    W_transf_h = handle("W_transf");
+    interp_zonal_u_h = handle("interp_zonal_u");
+    interp_zonal_v_h = handle("interp_zonal_v");
+    lookup_d_h = handle("lookup_d");
+    if(compute_Sx)
+        Sx_h = handle("Sx");
 }
 
 
@@ -104,7 +129,7 @@ void WindNinja::run(mesh& domain)
 
             std::vector<boost::tuple<double, double, double> > u;
             std::vector<boost::tuple<double, double, double> > v;
-            for (auto &s : global_param->get_stations(face->get_x(), face->get_y()))
+            for (auto &s : face->stations())
             {
                 if (is_nan(s->get("U_R")) || is_nan(s->get("vw_dir")))
                     continue;
@@ -137,11 +162,12 @@ void WindNinja::run(mesh& domain)
 
             // get an interpolated zonal U,V at our face
             auto query = boost::make_tuple(face->get_x(), face->get_y(), face->get_z());
-            double zonal_u = face->get_module_data<data>(ID)->interp(u, query);
-            double zonal_v = face->get_module_data<data>(ID)->interp(v, query);
+            auto* fd = face->get_module_data<data>(ID);
+            double zonal_u = fd->interp(u, query);
+            double zonal_v = fd->interp(v, query);
 
-            (*face)["interp_zonal_u"_s]= zonal_u;
-            (*face)["interp_zonal_v"_s]= zonal_v;
+            (*face)[interp_zonal_u_h]= zonal_u;
+            (*face)[interp_zonal_v_h]= zonal_v;
 
             //Get back the interpolated wind direction
             // -- not sure if there is a better way to do this, but at least a first order to getting the right direction
@@ -153,7 +179,7 @@ void WindNinja::run(mesh& domain)
             Vector_2 v_orig = math::gis::bearing_to_cartesian(theta_orig* 180.0 / M_PI);
             Vector_3 v3_orig(-v_orig.x(),-v_orig.y(), 0); //negate as direction it's blowing instead of where it is from!!
             face->set_face_vector("wind_direction_original",v3_orig);
-            (*face)["vw_dir_orig"_s]= theta_orig * 180.0 / M_PI;
+            (*face)[vw_dir_orig_h]= theta_orig * 180.0 / M_PI;
 
             double U = 0.;
             double V = 0.;
@@ -166,12 +192,12 @@ void WindNinja::run(mesh& domain)
                 // Wind field are available each delta_angle deg.
                 int d = int(theta * 180.0 / M_PI / delta_angle);
                 if (d == 0) d = N_windfield;
-                (*face)["lookup_d"_s]= d;
+                (*face)[lookup_d_h]= d;
 
                 // get the transfert function and associated wind component for the interpolated wind direction
-                 W_transf = face->parameter("Ninja" + std::to_string(d));   // transfert function
-                 U = face->parameter("Ninja" + std::to_string(d) + "_U");  // zonal component
-                 V = face->parameter("Ninja" + std::to_string(d) + "_V");  // meridional component
+                 W_transf = face->parameter(ninja_W[d]);   // transfert function
+                 U = face->parameter(ninja_U[d]);  // zonal component
+                 V = face->parameter(ninja_V[d]);  // meridional component
 
            }else // Linear interpolation between the closest 2 wind fields from the library
            {
@@ -187,16 +213,16 @@ void WindNinja::run(mesh& domain)
                 if (d2 == 0) d2 = N_windfield;
 
                 double d = d1*(theta2-theta)/(theta2-theta1)+d2*(theta-theta1)/(theta2-theta1);
-                (*face)["lookup_d"_s]= d;
+                (*face)[lookup_d_h]= d;
 
                 // get the transfert function and associated wind component for the interpolated wind direction
-                double W_transf1 = face->parameter("Ninja" + std::to_string(d1));   // transfert function
-                double U_lib1 = face->parameter("Ninja" + std::to_string(d1) + "_U");  // zonal component
-                double V_lib1 = face->parameter("Ninja" + std::to_string(d1) + "_V");  // meridional component
+                double W_transf1 = face->parameter(ninja_W[d1]);   // transfert function
+                double U_lib1 = face->parameter(ninja_U[d1]);  // zonal component
+                double V_lib1 = face->parameter(ninja_V[d1]);  // meridional component
 
-                double W_transf2 = face->parameter("Ninja" + std::to_string(d2));   // transfert function
-                double U_lib2 = face->parameter("Ninja" + std::to_string(d2) + "_U");  // zonal component
-                double V_lib2 = face->parameter("Ninja" + std::to_string(d2) + "_V");  // meridional component
+                double W_transf2 = face->parameter(ninja_W[d2]);   // transfert function
+                double U_lib2 = face->parameter(ninja_U[d2]);  // zonal component
+                double V_lib2 = face->parameter(ninja_V[d2]);  // meridional component
 
                 // Determine wind component from the wind field library using a weighted mean
                 U = U_lib1*(theta2-theta)/(theta2-theta1)+U_lib2*(theta-theta1)/(theta2-theta1);
@@ -218,9 +244,9 @@ void WindNinja::run(mesh& domain)
 
             double W = sqrt(zonal_u * zonal_u + zonal_v * zonal_v);
 
-            face->get_module_data<data>(ID)->corrected_theta = theta;
-            face->get_module_data<data>(ID)->W = W;
-            face->get_module_data<data>(ID)->W_transf = W_transf;
+            fd->corrected_theta = theta;
+            fd->W = W;
+            fd->W_transf = W_transf;
 
            }
 
@@ -230,14 +256,15 @@ void WindNinja::run(mesh& domain)
 
            auto face = domain->face(i);
 
-           double theta= face->get_module_data<data>(ID)->corrected_theta;
-           double W= face->get_module_data<data>(ID)->W;
-           double W_transf= face->get_module_data<data>(ID)->W_transf;
+           auto* fd = face->get_module_data<data>(ID);
+           double theta= fd->corrected_theta;
+           double W= fd->W;
+           double W_transf= fd->W_transf;
 
-            (*face)["Ninja_speed_nodown"_s]= W;   // Wind speed without downscaling
+            (*face)[Ninja_speed_nodown_h]= W;   // Wind speed without downscaling
 
 
-           (*face)["vw_dir"_s]= theta * 180.0 / M_PI;
+           (*face)[vw_dir_h]= theta * 180.0 / M_PI;
            // Limit speed up value to Max_spdup
            // Can be used to avoid unrelistic values at crest top
            if(W_transf>1. and transf_max>Max_spdup)
@@ -256,18 +283,18 @@ void WindNinja::run(mesh& domain)
           //         W_transf = std::max(0.5,0.5+(omega_s+0.5)/(0.15)*0.5);   // Reduction 0f 50% for omega_s larger than 30 deg
 
                   double sx_loc = Sx->Sx(domain,face);
-                  (*face)["Sx"_s] =sx_loc;
+                  (*face)[Sx_h] =sx_loc;
                   if( sx_loc>30. )  //Reduce wind speed on the lee side of mountain crest identified by Sx> 30 deg
                        W_transf = 0.25;
                 }
             }
 
-            (*face)["W_transf"_s]= W_transf;
+            (*face)[W_transf_h]= W_transf;
 
             // NEW wind intensity from the wind field library
             W = W * W_transf;
             W = std::max(W, 0.1);
-            (*face)["Ninja_speed"_s]= W;    // Wind speed with downscaling
+            (*face)[Ninja_speed_h]= W;    // Wind speed with downscaling
 
             // Update U and V wind components
             double U = -W  * sin(theta);
@@ -279,11 +306,11 @@ void WindNinja::run(mesh& domain)
                                            Atmosphere::Z_U_R,  // UR is at our reference height
                                            0); // no canopy, no snow, but uses a snow roughness
 
-            (*face)["U_R"_s]= W;
+            (*face)[U_R_h]= W;
 
 
-            (*face)["Ninja_u"_s]= U; // these are still H_forc
-            (*face)["Ninja_v"_s]= V;
+            (*face)[Ninja_u_h]= U; // these are still H_forc
+            (*face)[Ninja_v_h]= V;
 
             Vector_2 v_corr = math::gis::bearing_to_cartesian(theta * 180.0 / M_PI);
             Vector_3 v3(-v_corr.x(), -v_corr.y(), 0); //negate as direction it's blowing instead of where it is from!!
@@ -303,18 +330,19 @@ void WindNinja::run(mesh& domain)
             {
                 auto neigh = face->neighbor(j);
                 if (neigh != nullptr && !neigh->_is_ghost)
-                    u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(),(*neigh)["U_R"_s]));
+                    u.push_back(boost::make_tuple(neigh->get_x(), neigh->get_y(),(*neigh)[U_R_h]));
             }
 
             auto query = boost::make_tuple(face->get_x(), face->get_y(), face->get_z());
+            auto* fd = face->get_module_data<data>(ID);
             if(u.size() > 0)
             {
-                double new_u = face->get_module_data<data>(ID)->interp_smoothing(u, query);
-                face->get_module_data<data>(ID)->temp_u = new_u;
+                double new_u = fd->interp_smoothing(u, query);
+                fd->temp_u = new_u;
             }
             else
             {
-                face->get_module_data<data>(ID)->temp_u = (*face)["U_R"_s];
+                fd->temp_u = (*face)[U_R_h];
             }
 
         }
@@ -322,7 +350,7 @@ void WindNinja::run(mesh& domain)
         for (size_t i = 0; i < domain->size_faces(); i++)
         {
             auto face = domain->face(i);
-            (*face)["U_R"_s]= std::max(0.1, face->get_module_data<data>(ID)->temp_u);
+            (*face)[U_R_h]= std::max(0.1, face->get_module_data<data>(ID)->temp_u);
         }
    }
 
@@ -89,6 +89,24 @@ public:
 
     bool compute_Sx; // uses the Sx module to influence the windspeeds so Sx needs to be computed during the windspeed evaluation, instead of a seperate module
     boost::shared_ptr<Winstral_parameters> Sx;
+
+    // resolved in init so the per-face loops don't hash the names
+    std::vector<var_handle> ninja_W; // transfer function, indexed by windfield 1..N_windfield
+    std::vector<var_handle> ninja_U;
+    std::vector<var_handle> ninja_V;
+
+    var_handle U_R_h;
+    var_handle Ninja_speed_h;
+    var_handle Ninja_speed_nodown_h;
+    var_handle vw_dir_h;
+    var_handle vw_dir_orig_h;
+    var_handle Ninja_u_h;
+    var_handle Ninja_v_h;
+    var_handle W_transf_h;
+    var_handle interp_zonal_u_h;
+    var_handle interp_zonal_v_h;
+    var_handle lookup_d_h;
+    var_handle Sx_h;
 };
 
 /**
@@ -64,10 +64,20 @@ Winstral_parameters::Winstral_parameters(config_file cfg)
     // Option to compute the elevation of the point considered to compute Sx
     use_subgridz = cfg.get("use_subgridz",true);
 
+    azimuth_bins = cfg.get("azimuth_bins",0);
+
 
     LOG_DEBUG << "Successfully instantiated module " << this->ID;
 }
 
+void Winstral_parameters::init(mesh& domain)
+{
+    if (azimuth_bins > 0)
+    {
+        stencil = domain->directional_stencil(azimuth_bins, face_stencil::uniform_steps(steps, size_of_step));
+    }
+}
+
 void Winstral_parameters::run(mesh& domain)
 {
 
@@ -109,6 +119,14 @@ double Winstral_parameters::Sx(const mesh &domain, mesh_elem& face) const
     // Extract Wind direction
     double wind_dir = (*face)["vw_dir"_s] ;
 
+    // the stencil's rays are along the bin's azimuth, so the subgrid points need to be too
+    size_t k = 0;
+    if (stencil)
+    {
+        k = stencil->bin(wind_dir);
+        wind_dir = stencil->azimuth(k);
+    }
+
     for (int i = 1; i <= this->nangle; ++i)
     {
 
@@ -126,7 +144,7 @@ double Winstral_parameters::Sx(const mesh &domain, mesh_elem& face) const
            // Select point along the line
            Point_2 pref =  math::gis::point_from_bearing(face_centre,wind_dir,distance);
            // Find corresponding triangle
-           auto f = domain->find_closest_face (pref );
+           auto f = stencil ? face->stencil_face(*stencil, k, j - 1) : domain->find_closest_face (pref );
 
            double Z_dist = 0.;
            if(this->use_subgridz)
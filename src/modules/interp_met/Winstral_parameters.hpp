@@ -48,6 +48,12 @@
 *     wind and precipitation in complex terrain to improve simulation of snow 
 *     cover variability. 
 *
+* Config:
+* - "dmax" Distance to search [m]. Default 300.
+* - "size_of_step" Step along the search vector [m]. Default 10.
+* - "azimuth_bins" If > 0, the faces along this many azimuths are precomputed (see face_stencil) and each direction of
+*   the upwind window uses the closest. Trades memory for the per step lookups. Default 0.
+*
 * Depends:
 * - Direction at reference height 'vw_dir' [degrees]
 * - Snow depth [m] (optional)
@@ -65,6 +71,8 @@ public:
 
     virtual void run(mesh& domain);
 
+    virtual void init(mesh& domain);
+
     //number of steps along the search vector to check for a higher point
     int steps;
     //max distance to search [m]
@@ -100,6 +108,9 @@ public:
     // Improve estimation of Sx when snow is accumulating during the snow season
     bool incl_snw;
 
+    size_t azimuth_bins;
+    boost::shared_ptr<const face_stencil> stencil;
+
     // Calculates the Sx parameter
     double Sx(const mesh &domain, mesh_elem& face) const;
 };
@@ -47,7 +47,7 @@ void kunkel_rh::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<data>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 
     }
 
@@ -72,7 +72,7 @@ void kunkel_rh::run(mesh_elem &face)
 
     double lapse = lapse_rates[global_param->month() - 1] / 1000.0; // -> 1/m
     std::vector<boost::tuple<double, double, double> > lowered_values;
-    for (auto &s : global_param->get_stations( face->get_x(), face->get_y()))
+    for (auto &s : face->stations())
     {
         if( is_nan(s->get("rh")))
             continue;
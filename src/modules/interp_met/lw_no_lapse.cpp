@@ -50,7 +50,7 @@ void lw_no_lapse::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<lw_no_lapse::data>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 
     }
 
@@ -61,7 +61,7 @@ void lw_no_lapse::run(mesh_elem& face)
 
     //lower all the station values to sea level prior to the interpolation
     std::vector< boost::tuple<double, double, double> > lowered_values;
-    for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+    for (auto& s : face->stations())
     {
         if( is_nan(s->get("Qli")))
             continue;
@@ -46,7 +46,7 @@ void p_no_lapse::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<p_no_lapse::data>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 
     }
 
@@ -56,7 +56,7 @@ void p_no_lapse::run(mesh_elem& face)
 
     std::vector< boost::tuple<double, double, double> > ppt;
     std::vector< boost::tuple<double, double, double> > staion_z;
-    for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+    for (auto& s : face->stations())
     {
         if( is_nan(s->get("p")))
             continue;
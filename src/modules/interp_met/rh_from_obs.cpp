@@ -46,7 +46,7 @@ void rh_from_obs::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<data>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 
     }
 
@@ -66,7 +66,7 @@ void rh_from_obs::run(mesh_elem& face)
     //otherwise, just used the stored lapse rate
     if(last_update != global_param->posix_time() )
     {
-        for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+        for (auto& s : face->stations())
         {
             if( is_nan(s->get("t")) || is_nan(s->get("rh")))
                 continue;
@@ -90,7 +90,7 @@ void rh_from_obs::run(mesh_elem& face)
     }
 
     std::vector< boost::tuple<double, double, double> > lowered_values;
-    for (auto& s : global_param->get_stations( face->get_x(), face->get_y()))
+    for (auto& s : face->stations())
     {
         if( is_nan(s->get("t")) || is_nan(s->get("rh")))
             continue;
@@ -48,7 +48,7 @@ void uniform_wind::init(mesh& domain)
 
 	       auto face = domain->face(i);
 	       auto d = face->make_module_data<lwinddata>(ID);
-	       d->interp.init(global_param->interp_algorithm,global_param->get_stations( face->get_x(), face->get_y()).size());
+	       d->interp.init(global_param->interp_algorithm,face->stations().size());
 	       face->coloured = false;
 
     }
@@ -71,7 +71,7 @@ void uniform_wind::run(mesh& domain)
 
 	       std::vector<boost::tuple<double, double, double> > u;
 	       std::vector<boost::tuple<double, double, double> > v;
-	       for (auto &s : global_param->get_stations(face->get_x(), face->get_y()))
+	       for (auto &s : face->stations())
 	       {
 		   if (is_nan(s->get("U_R")) || is_nan(s->get("vw_dir")))
 		     continue;
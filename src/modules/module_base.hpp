@@ -311,6 +311,61 @@ public:
             (*face)[itr]=-9999.;
         }
     }
+    /**
+     * Resolves the names in provides(), depends() and any found optionals into dense handles into the mesh's
+     * variable storage. Called by core after the face variable storage has been allocated and before init().
+     * @param domain
+     */
+    void resolve_handles(mesh& domain)
+    {
+        _handles.clear();
+
+        for(auto& itr: *_provides)
+            _handles[itr] = domain->variable_handle(itr);
+
+        _halo_handles.clear();
+
+        for(auto& itr: *_depends)
+        {
+            _handles[itr] = domain->variable_handle(itr);
+            _halo_handles.push_back(_handles[itr]);
+        }
+
+        for(auto& itr: _optional_found)
+        {
+            if(itr.second)
+            {
+                _handles[itr.first] = domain->variable_handle(itr.first);
+                _halo_handles.push_back(_handles[itr.first]);
+            }
+        }
+    }
+
+    /**
+     * Handles of the depends and found optionals, i.e., what a domain parallel module may read from a neighbour.
+     * These are exchanged with the neighbouring MPI processes before the module runs.
+     * @return
+     */
+    const std::vector<var_handle>& halo_handles() const
+    {
+        return _halo_handles;
+    }
+
+    /**
+     * Handle for a variable this module provides or depends upon. Use with (*face)[handle] in place of the
+     * "name"_s lookups in tight loops. Only valid from init() onwards.
+     * @param variable
+     * @return
+     */
+    var_handle handle(const std::string& variable)
+    {
+        auto it = _handles.find(variable);
+        if(it == _handles.end())
+            BOOST_THROW_EXCEPTION(module_error() << errstr_info ("Module " + ID + " has no handle for " + variable + ". It must be in provides, depends, or a found optional."));
+
+        return it->second;
+    }
+
     /**
      * Set that an optional variable was found
      */
@@ -367,6 +422,10 @@ protected:
     //lists the options that were found
     std::map<std::string,bool> _optional_found;
 
+    //dense handles for provides/depends, see resolve_handles
+    std::map<std::string,var_handle> _handles;
+    std::vector<var_handle> _halo_handles;
+
 
 };
 
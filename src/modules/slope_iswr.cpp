@@ -54,34 +54,22 @@ void slope_iswr::run(mesh_elem& face)
 
     //radiation data
     //solar vector
-    //xyz cartesian
-    arma::vec S;
-    S << cos(E) * sin(A) << arma::endr
-      << cos(E) * cos(A) << arma::endr
-      << sin(E) << arma::endr;
-
-    arma::vec N;
-    if (assume_no_slope)
-    {
+    //xyz cartesian. Plain doubles, this runs for every face every timestep and the arma::vec allocations dominated it
+    double S[3] = {cos(E) * sin(A),
+                   cos(E) * cos(A),
+                   sin(E)};
 
-        N << 0 << arma::endr
-        << 0 << arma::endr
-        << 1 << arma::endr;
-    }
-    else
+    double N[3] = {0, 0, 1};
+    if (!assume_no_slope)
     {
         Vector_3 n = face->normal();
-
-
-        N << n[0] << arma::endr
-        << n[1] << arma::endr
-        << n[2] << arma::endr;
+        N[0] = n[0];
+        N[1] = n[1];
+        N[2] = n[2];
     }
 
-
-    double angle = acos(arma::dot(S,N));
-    angle = cos(angle);
-
+    // cos of the angle between the sun and the face's normal
+    double angle = S[0] * N[0] + S[1] * N[1] + S[2] * N[2];
     if(angle < 0.0 || E < 0.0523598776) //3deg -> rad
         angle = 0.0;
 
@@ -488,55 +488,98 @@ void snobal::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("snobal:ro_pred_sum",domain->size_faces());
     chkpt.create_variable1D("snobal:h2o_total",domain->size_faces());
 
-//netcdf puts are not threadsafe.
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    //gather each variable into a column so it can be written in one call
+    size_t n = domain->size_faces();
+    std::vector<double> m_s(n), rho(n), T_s(n), T_s_0(n), T_s_l(n), z_s(n), h2o_sat(n), max_h2o_vol(n),
+                        sum_runoff(n), sum_melt(n), E_s_sum(n), melt_sum(n), ro_pred_sum(n), h2o_total(n);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < n; i++)
     {
         auto face = domain->face(i);
         snodata *g = face->get_module_data<snodata>(ID);
         auto *sbal = &(g->data);
 
-        chkpt.put_var1D("snobal:m_s",i,sbal->m_s);
-        chkpt.put_var1D("snobal:rho",i,sbal->rho);
-        chkpt.put_var1D("snobal:T_s",i,sbal->T_s);
-        chkpt.put_var1D("snobal:T_s_0",i,sbal->T_s_0);
-        chkpt.put_var1D("snobal:T_s_l",i,sbal->T_s_l);
-        chkpt.put_var1D("snobal:z_s",i, sbal->z_s);
-        chkpt.put_var1D("snobal:h2o_sat",i,sbal->h2o_sat);
-        chkpt.put_var1D("snobal:max_h2o_vol",i,sbal->max_h2o_vol);
-
-        chkpt.put_var1D("snobal:sum_runoff",i,g->sum_runoff);
-        chkpt.put_var1D("snobal:sum_melt",i,g->sum_melt);
-        chkpt.put_var1D("snobal:E_s_sum",i,sbal->E_s_sum);
-        chkpt.put_var1D("snobal:melt_sum",i,sbal->melt_sum);
-        chkpt.put_var1D("snobal:ro_pred_sum",i,sbal->ro_pred_sum);
-        chkpt.put_var1D("snobal:h2o_total",i,sbal->h2o_total);
+        m_s[i] = sbal->m_s;
+        rho[i] = sbal->rho;
+        T_s[i] = sbal->T_s;
+        T_s_0[i] = sbal->T_s_0;
+        T_s_l[i] = sbal->T_s_l;
+        z_s[i] = sbal->z_s;
+        h2o_sat[i] = sbal->h2o_sat;
+        max_h2o_vol[i] = sbal->max_h2o_vol;
+
+        sum_runoff[i] = g->sum_runoff;
+        sum_melt[i] = g->sum_melt;
+        E_s_sum[i] = sbal->E_s_sum;
+        melt_sum[i] = sbal->melt_sum;
+        ro_pred_sum[i] = sbal->ro_pred_sum;
+        h2o_total[i] = sbal->h2o_total;
     }
 
+    //netcdf puts are not threadsafe.
+    chkpt.put_var1D("snobal:m_s", m_s.data(), n);
+    chkpt.put_var1D("snobal:rho", rho.data(), n);
+    chkpt.put_var1D("snobal:T_s", T_s.data(), n);
+    chkpt.put_var1D("snobal:T_s_0", T_s_0.data(), n);
+    chkpt.put_var1D("snobal:T_s_l", T_s_l.data(), n);
+    chkpt.put_var1D("snobal:z_s", z_s.data(), n);
+    chkpt.put_var1D("snobal:h2o_sat", h2o_sat.data(), n);
+    chkpt.put_var1D("snobal:max_h2o_vol", max_h2o_vol.data(), n);
+
+    chkpt.put_var1D("snobal:sum_runoff", sum_runoff.data(), n);
+    chkpt.put_var1D("snobal:sum_melt", sum_melt.data(), n);
+    chkpt.put_var1D("snobal:E_s_sum", E_s_sum.data(), n);
+    chkpt.put_var1D("snobal:melt_sum", melt_sum.data(), n);
+    chkpt.put_var1D("snobal:ro_pred_sum", ro_pred_sum.data(), n);
+    chkpt.put_var1D("snobal:h2o_total", h2o_total.data(), n);
+
 }
 
 void snobal::load_checkpoint(mesh& domain, netcdf& chkpt)
 {
-    for (size_t i = 0; i < domain->size_faces(); i++)
+    size_t n = domain->size_faces();
+    std::vector<double> m_s(n), rho(n), T_s(n), T_s_0(n), T_s_l(n), z_s(n), h2o_sat(n), max_h2o_vol(n),
+                        sum_runoff(n), sum_melt(n), E_s_sum(n), melt_sum(n), ro_pred_sum(n), h2o_total(n);
+
+    chkpt.get_var1D("snobal:m_s", m_s.data(), n);
+    chkpt.get_var1D("snobal:rho", rho.data(), n);
+    chkpt.get_var1D("snobal:T_s", T_s.data(), n);
+    chkpt.get_var1D("snobal:T_s_0", T_s_0.data(), n);
+    chkpt.get_var1D("snobal:T_s_l", T_s_l.data(), n);
+    chkpt.get_var1D("snobal:z_s", z_s.data(), n);
+    chkpt.get_var1D("snobal:h2o_sat", h2o_sat.data(), n);
+    chkpt.get_var1D("snobal:max_h2o_vol", max_h2o_vol.data(), n);
+
+    chkpt.get_var1D("snobal:sum_runoff", sum_runoff.data(), n);
+    chkpt.get_var1D("snobal:sum_melt", sum_melt.data(), n);
+    chkpt.get_var1D("snobal:E_s_sum", E_s_sum.data(), n);
+    chkpt.get_var1D("snobal:melt_sum", melt_sum.data(), n);
+    chkpt.get_var1D("snobal:ro_pred_sum", ro_pred_sum.data(), n);
+    chkpt.get_var1D("snobal:h2o_total", h2o_total.data(), n);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < n; i++)
     {
         auto face = domain->face(i);
         snodata *g = face->get_module_data<snodata>(ID);
         auto *sbal = &(g->data);
 
-        sbal->m_s = chkpt.get_var1D("snobal:m_s",i);
-        sbal->rho = chkpt.get_var1D("snobal:rho",i);
-        sbal->T_s = chkpt.get_var1D("snobal:T_s",i);
-        sbal->T_s_0 = chkpt.get_var1D("snobal:T_s_0",i);
-        sbal->T_s_l = chkpt.get_var1D("snobal:T_s_l",i);
-        sbal->z_s =  chkpt.get_var1D("snobal:z_s",i);
-        sbal->h2o_sat =  chkpt.get_var1D("snobal:h2o_sat",i);
-        sbal->max_h2o_vol = chkpt.get_var1D("snobal:max_h2o_vol",i);
-
-        g->sum_runoff = chkpt.get_var1D("snobal:sum_runoff",i);
-        g->sum_melt = chkpt.get_var1D("snobal:sum_melt",i);
-        sbal->E_s_sum = chkpt.get_var1D("snobal:E_s_sum",i);
-        sbal->melt_sum = chkpt.get_var1D("snobal:melt_sum",i);
-        sbal->ro_pred_sum = chkpt.get_var1D("snobal:ro_pred_sum",i);
-        sbal->h2o_total = chkpt.get_var1D("snobal:h2o_total",i);
+        sbal->m_s = m_s[i];
+        sbal->rho = rho[i];
+        sbal->T_s = T_s[i];
+        sbal->T_s_0 = T_s_0[i];
+        sbal->T_s_l = T_s_l[i];
+        sbal->z_s =  z_s[i];
+        sbal->h2o_sat =  h2o_sat[i];
+        sbal->max_h2o_vol = max_h2o_vol[i];
+
+        g->sum_runoff = sum_runoff[i];
+        g->sum_melt = sum_melt[i];
+        sbal->E_s_sum = E_s_sum[i];
+        sbal->melt_sum = melt_sum[i];
+        sbal->ro_pred_sum = ro_pred_sum[i];
+        sbal->h2o_total = h2o_total[i];
 
         sbal->init_snow();
     }
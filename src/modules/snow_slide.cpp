@@ -49,32 +49,36 @@ void snow_slide::checkpoint(mesh& domain,  netcdf& chkpt)
     chkpt.create_variable1D("snow_slide:delta_avalanche_snowdepth", domain->size_faces());
     chkpt.create_variable1D("snow_slide:delta_avalanche_mass", domain->size_faces());
 
+    std::vector<double> snowdepth(domain->size_faces());
+    std::vector<double> mass(domain->size_faces());
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
-        chkpt.put_var1D("snow_slide:delta_avalanche_snowdepth",i,face->get_module_data<data>(ID)->delta_avalanche_snowdepth);
-        chkpt.put_var1D("snow_slide:delta_avalanche_mass",i,face->get_module_data<data>(ID)->delta_avalanche_mass);
+        snowdepth[i] = face->get_module_data<data>(ID)->delta_avalanche_snowdepth;
+        mass[i] = face->get_module_data<data>(ID)->delta_avalanche_mass;
     }
+    chkpt.put_var1D("snow_slide:delta_avalanche_snowdepth", snowdepth.data(), snowdepth.size());
+    chkpt.put_var1D("snow_slide:delta_avalanche_mass", mass.data(), mass.size());
 }
 
 void snow_slide::load_checkpoint(mesh& domain,  netcdf& chkpt)
 {
+    std::vector<double> snowdepth(domain->size_faces());
+    std::vector<double> mass(domain->size_faces());
+    chkpt.get_var1D("snow_slide:delta_avalanche_snowdepth", snowdepth.data(), snowdepth.size());
+    chkpt.get_var1D("snow_slide:delta_avalanche_mass", mass.data(), mass.size());
+
     for (size_t i = 0; i < domain->size_faces(); i++)
     {
         auto face = domain->face(i);
-        face->get_module_data<data>(ID)->delta_avalanche_snowdepth = chkpt.get_var1D("snow_slide:delta_avalanche_snowdepth",i);
-        face->get_module_data<data>(ID)->delta_avalanche_mass = chkpt.get_var1D("snow_slide:delta_avalanche_mass",i);
+        face->get_module_data<data>(ID)->delta_avalanche_snowdepth = snowdepth[i];
+        face->get_module_data<data>(ID)->delta_avalanche_mass = mass[i];
     }
 }
 
 void snow_slide::run(mesh& domain)
 {
 
-
-
-    // Make a vector of pairs (elevation + snowdepth, pointer to face)
-    tbb::concurrent_vector< std::pair<double, mesh_elem> > sorted_z(domain->size_faces());
-
 #pragma omp parallel for
     for(size_t i = 0; i  < domain->size_faces(); i++)
     {
@@ -90,21 +94,36 @@ void snow_slide::run(mesh& domain)
 	       // Initalize snow transport to zero
 	       data->delta_avalanche_snowdepth = 0.0;
 	       data->delta_avalanche_mass = 0.0; // m
-	       sorted_z.at(i) = std::make_pair( face->center().z() + (*face)["snowdepthavg"_s]/std::max(0.001,cos(face->slope())), face) ;
+	       data->z_sort = face->center().z() + (*face)["snowdepthavg"_s]/std::max(0.001,cos(face->slope()));
 
+	       // faces that no avalanche reaches aren't visited below
+	       (*face)["delta_avalanche_snowdepth"_s] = 0.0;
+	       (*face)["delta_avalanche_mass"_s] = 0.0;
     }
 
-
-    // Sort faces by elevation + snowdepth
-//    std::sort(sorted_z.begin(), sorted_z.end(), [](const std::pair<double, mesh_elem> &a,const std::pair<double, mesh_elem> &b) {
-//        return b.first < a.first;
-//    });
-    tbb::parallel_sort(sorted_z.begin(), sorted_z.end(), [](const std::pair<double, mesh_elem> &a,const std::pair<double, mesh_elem> &b) {
-        return b.first < a.first;
+    // Only faces deeper than their holding depth start an avalanche, any other face only takes part once it receives
+    // snow from a higher one. So rather than sorting the whole mesh by elevation + snowdepth, the faces are taken
+    // highest first from a queue that starts with the over-deep faces, and that the faces receiving snow are added to
+    // (see downhill_queue). Nothing at all is done for a timestep without any.
+    over_depth.update(domain, [this](mesh_elem face) -> bool
+    {
+        auto data = face->get_module_data<snow_slide::data>(ID);
+        double maxDepth = use_vertical_snow ? data->maxDepth_vert : data->maxDepth_norm;
+        return data->snowdepthavg_copy > maxDepth;
     });
+
+    if (over_depth.none())
+        return;
+
     // Loop through each face, from highest to lowest triangle surface
-    for (size_t i = 0; i < sorted_z.size(); i++) {
-        auto face = sorted_z[i].second; // Get pointer to face
+    downhill.run(domain->size_faces(), over_depth.faces(),
+                 [&](size_t face_id) -> double
+                 {
+                     return domain->face(face_id)->get_module_data<snow_slide::data>(ID)->z_sort;
+                 },
+                 [&](size_t face_id, std::vector<size_t>& receivers)
+    {
+        auto face = domain->face(face_id); // Get pointer to face
         double cen_area = face->get_area(); // Area of center triangle
         auto data = face->get_module_data<snow_slide::data>(ID); // Get stored data for face
 
@@ -173,7 +192,7 @@ void snow_slide::run(mesh& domain)
 
             // Case 2) Non-Edge cell, but w_dem=0, "sink" cell. Don't route snow.
             if(w_dem==0) {
-                continue; // Restart to next loop.
+                return; // On to the next face.
             }
 
             // Must be Case 3), Divide by sum height differences to create weights that sum to unity
@@ -207,6 +226,9 @@ void snow_slide::run(mesh& domain)
                     // center triangle area (m^2) = volune of snow depth (m^3)
                     n_data->delta_avalanche_mass +=  del_swe * cen_area * w[j]; // (m) * (m^2) = (m^3) of swe
                     out_mass += del_swe * cen_area * w[j];
+
+                    // visited next if it is still ahead of us in elevation order
+                    receivers.push_back(n->cell_local_id);
                 }
             }
             // Remove snow from initial face
@@ -232,7 +254,7 @@ void snow_slide::run(mesh& domain)
         (*face)["delta_avalanche_snowdepth"_s]= data->delta_avalanche_snowdepth;
         (*face)["delta_avalanche_mass"_s]= data->delta_avalanche_mass;
 
-    } // End of each face
+    }); // End of each face
 
 
 }
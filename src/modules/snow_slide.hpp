@@ -24,10 +24,10 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
-#include <tbb/concurrent_vector.h>
-#include <tbb/parallel_sort.h>
 #include "logger.hpp"
 #include "triangulation.hpp"
+#include "activity_mask.hpp"
+#include "downhill_queue.hpp"
 #include "module_base.hpp"
 
 #include <string>
@@ -56,7 +56,10 @@ public:
         double swe_copy; // m (Note: swe units outside of snowslide are still mm)
         double delta_avalanche_snowdepth; // m^3
         double delta_avalanche_mass; // m^3
+        double z_sort; // m, elevation + vertical snow depth at the start of the timestep, the order faces are visited in
     };
+    activity_mask over_depth; // faces deeper than their holding depth at the start of the timestep
+    downhill_queue downhill;
     bool use_vertical_snow; 
 // True: apply the maximal snow holding capacity to snow depth (measured vertically)
 // False: apply the maximal snow holding capacity to snow thickness (perpendicular to the surface)
@@ -295,6 +295,66 @@ void Lehning_snowpack::run(mesh_elem &face)
     (*face)["MS_SOIL_RUNOFF"_s]=surface_fluxes.mass[SurfaceFluxes::MS_SOIL_RUNOFF];
 }
 
+SN_SNOWSOIL_DATA Lehning_snowpack::initial_snowcover(mesh_elem& face)
+{
+    //addSpecial keys goes here to deal with Antarctica, canopy, and detect grass
+
+    SN_SNOWSOIL_DATA SSdata;
+    SSdata.SoilAlb = cfg.get<double>("sno.SoilAlbedo",0.09);
+    SSdata.Albedo = SSdata.SoilAlb; // following snowpacks' no snow default.
+    SSdata.BareSoil_z0 = cfg.get<double>("sno.BareSoil_z0",0.2);
+    if (SSdata.BareSoil_z0 == 0.)
+    {
+        LOG_WARNING << "[snowpack] BareSoil_z0 == 0, set to 0.2";
+        SSdata.BareSoil_z0 = 0.2;
+    }
+
+    SSdata.WindScalingFactor= cfg.get<double>("sno.WindScalingFactor",1);
+    SSdata.TimeCountDeltaHS = cfg.get<double>("sno.TimeCountDeltaHS",0.0);
+
+
+    SSdata.meta.stationName = cfg.get<std::string>("sno.station_name","chm");
+    SSdata.meta.position.setAltitude(face->get_z());
+
+    SSdata.meta.position.setXY(face->get_x(),face->get_y(),face->get_z());
+    SSdata.meta.setSlope(mio::IOUtils::nodata,mio::IOUtils::nodata);
+//        SSdata.meta.setSlope(face->slope() * ,face->aspect());
+//        SSdata.meta.setSlope(0,0);
+
+    SSdata.HS_last = 0.; //cfg.get<double>("sno.HS_Last");
+
+    //meta data in *sno files that we don't use
+//        cfg.get<std::string>("sno.station_id");
+
+//        cfg.get<double>("sno.latitude");
+//        cfg.get<double>("sno.longitude");
+//        cfg.get<double>("sno.altitude");
+//        cfg.get<double>("sno.nodata");
+//        cfg.get<double>("sno.tz");
+//        cfg.get<std::string>("sno.source");
+//        cfg.get<std::string>("sno.ProfileDate");
+
+
+
+    //assumes no starting layers
+    SSdata.nN = 1;
+    SSdata.Height = 0.;
+
+    SSdata.nLayers = 0;// cfg.get("sno.nSoilLayerData",0);
+//        SSdata.nLayers += cfg.get("sno.nSnowLayerData",0);
+//        SSdata.Ldata
+
+
+
+    SSdata.Canopy_Height = cfg.get<double>("sno.CanopyHeight",0);
+    SSdata.Canopy_LAI = cfg.get<double>("sno.CanopyLeafAreaIndex",0);
+    SSdata.Canopy_Direct_Throughfall = cfg.get<double>("sno.CanopyDirectThroughfall",1);
+
+    SSdata.ErosionLevel = cfg.get<double>("sno.ErosionLevel",0);
+
+    return SSdata;
+}
+
 void Lehning_snowpack::init(mesh& domain)
 {
     const_T_g = cfg.get("const_T_g",-4.0);
@@ -368,75 +428,252 @@ void Lehning_snowpack::init(mesh& domain)
 
         d->cum_precip=0.;
 
-        //addSpecial keys goes here to deal with Antarctica, canopy, and detect grass
+        SN_SNOWSOIL_DATA SSdata = initial_snowcover(face);
 
-        SN_SNOWSOIL_DATA SSdata;
-        SSdata.SoilAlb = cfg.get<double>("sno.SoilAlbedo",0.09);
-        SSdata.Albedo = SSdata.SoilAlb; // following snowpacks' no snow default.
-        SSdata.BareSoil_z0 = cfg.get<double>("sno.BareSoil_z0",0.2);
-        if (SSdata.BareSoil_z0 == 0.)
-        {
-            LOG_WARNING << "[snowpack] BareSoil_z0 == 0, set to 0.2";
-            SSdata.BareSoil_z0 = 0.2;
-        }
+        d->Xdata = boost::make_shared<SnowStation>(false,false);
+        d->Xdata->initialize(SSdata,0);
+//        d->Xdata->cos_sl = 1;
+//        d->Xdata->windward = false;
+//        d->Xdata->rho_hn = 0;
+//        d->Xdata->hn = 0;
+//        d->Xdata->mH = 0;
 
-        SSdata.WindScalingFactor= cfg.get<double>("sno.WindScalingFactor",1);
-        SSdata.TimeCountDeltaHS = cfg.get<double>("sno.TimeCountDeltaHS",0.0);
+        d->sp = boost::make_shared<Snowpack>(*(d->Spackconfig));
+        d->meteo = boost::make_shared<Meteo>( (d->config));
+        d->stability = boost::make_shared<Stability> ( (d->config), false);
 
+        d->sum_subl = 0;
 
-        SSdata.meta.stationName = cfg.get<std::string>("sno.station_name","chm");
-        SSdata.meta.position.setAltitude(face->get_z());
 
-        SSdata.meta.position.setXY(face->get_x(),face->get_y(),face->get_z());
-        SSdata.meta.setSlope(mio::IOUtils::nodata,mio::IOUtils::nodata);
-//        SSdata.meta.setSlope(face->slope() * ,face->aspect());
-//        SSdata.meta.setSlope(0,0);
+    }
+}
 
-        SSdata.HS_last = 0.; //cfg.get<double>("sno.HS_Last");
+namespace
+{
+    // per element fields, in the order of a *.sno file's columns
+    enum layer_field
+    {
+        L_DEPOSITION_DATE, L_HL, L_TL, L_PHI_ICE, L_PHI_WATER, L_PHI_VOIDS, L_PHI_SOIL,
+        L_SOIL_RHO, L_SOIL_K, L_SOIL_C, L_RG, L_RB, L_DD, L_SP, L_MK, L_HR, L_CDOT, L_METAMO,
+        N_LAYER_FIELDS
+    };
+    const char* layer_names[N_LAYER_FIELDS] = {
+        "depositionDate", "hl", "tl", "phiIce", "phiWater", "phiVoids", "phiSoil",
+        "SoilRho", "SoilK", "SoilC", "rg", "rb", "dd", "sp", "mk", "hr", "CDot", "metamo"
+    };
+
+    // per face fields, as in a *.sno file's header, plus the module's accumulators
+    enum face_field
+    {
+        F_HS_LAST, F_ALBEDO, F_SOIL_ALB, F_BARESOIL_Z0, F_WIND_SCALING, F_TIME_COUNT_DELTA_HS, F_EROSION_LEVEL,
+        F_CUM_PRECIP, F_SUM_SUBL,
+        N_FACE_FIELDS
+    };
+    const char* face_names[N_FACE_FIELDS] = {
+        "HS_last", "Albedo", "SoilAlb", "BareSoil_z0", "WindScalingFactor", "TimeCountDeltaHS", "ErosionLevel",
+        "cum_precip", "sum_subl"
+    };
 
-        //meta data in *sno files that we don't use
-//        cfg.get<std::string>("sno.station_id");
+    const char* solute_phases[] = {"cIce", "cWater", "cVoids", "cSoil"};
 
-//        cfg.get<double>("sno.latitude");
-//        cfg.get<double>("sno.longitude");
-//        cfg.get<double>("sno.altitude");
-//        cfg.get<double>("sno.nodata");
-//        cfg.get<double>("sno.tz");
-//        cfg.get<std::string>("sno.source");
-//        cfg.get<std::string>("sno.ProfileDate");
+    const std::string layer_dim = "snowpack_layer";
 
+    std::string layer_var(const std::string& name)
+    {
+        return "snowpack:layer_" + name;
+    }
+    std::string solute_var(size_t phase, size_t solute)
+    {
+        return layer_var(std::string(solute_phases[phase]) + "_" + std::to_string(solute));
+    }
+}
 
+void Lehning_snowpack::checkpoint(mesh& domain, netcdf& chkpt)
+{
+    const size_t nfaces = domain->size_faces();
+    const size_t nsolutes = SnowStation::number_of_solutes;
 
-        //assumes no starting layers
-        SSdata.nN = 1;
-        SSdata.Height = 0.;
+    // offsets[i] is where face i's elements start in the concatenated layer arrays
+    std::vector<double> n_layers(nfaces);
+    std::vector<size_t> offsets(nfaces + 1, 0);
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        auto d = domain->face(i)->get_module_data<data>(ID);
+        n_layers[i] = d->Xdata->getNumberOfElements();
+        offsets[i + 1] = offsets[i] + d->Xdata->getNumberOfElements();
+    }
+    const size_t total = offsets.back();
 
-        SSdata.nLayers = 0;// cfg.get("sno.nSoilLayerData",0);
-//        SSdata.nLayers += cfg.get("sno.nSnowLayerData",0);
-//        SSdata.Ldata
+    std::vector< std::vector<double> > faces(N_FACE_FIELDS, std::vector<double>(nfaces));
+    std::vector< std::vector<double> > layers(N_LAYER_FIELDS, std::vector<double>(total));
+    std::vector< std::vector<double> > solutes(4 * nsolutes, std::vector<double>(total));
 
+#pragma omp parallel for
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        auto d = domain->face(i)->get_module_data<data>(ID);
+        const SnowStation& X = *(d->Xdata);
+
+        faces[F_HS_LAST][i] = X.cH - X.Ground;
+        faces[F_ALBEDO][i] = X.Albedo;
+        faces[F_SOIL_ALB][i] = X.SoilAlb;
+        faces[F_BARESOIL_Z0][i] = X.BareSoil_z0;
+        faces[F_WIND_SCALING][i] = X.WindScalingFactor;
+        faces[F_TIME_COUNT_DELTA_HS][i] = X.TimeCountDeltaHS;
+        faces[F_EROSION_LEVEL][i] = static_cast<double>(X.ErosionLevel);
+        faces[F_CUM_PRECIP][i] = d->cum_precip;
+        faces[F_SUM_SUBL][i] = d->sum_subl;
+
+        // same mapping as the *.sno writer: tl and hr are taken from each element's top node
+        for (size_t e = 0; e < X.getNumberOfElements(); e++)
+        {
+            const size_t k = offsets[i] + e;
+            const ElementData& E = X.Edata[e];
+
+            layers[L_DEPOSITION_DATE][k] = E.depositionDate.isUndef() ? mio::IOUtils::nodata : E.depositionDate.getJulian(true);
+            layers[L_HL][k] = E.L;
+            layers[L_TL][k] = X.Ndata[e + 1].T;
+            layers[L_PHI_ICE][k] = E.theta[ICE];
+            layers[L_PHI_WATER][k] = E.theta[WATER];
+            layers[L_PHI_VOIDS][k] = E.theta[AIR];
+            layers[L_PHI_SOIL][k] = E.theta[SOIL];
+            layers[L_SOIL_RHO][k] = E.soil[SOIL_RHO];
+            layers[L_SOIL_K][k] = E.soil[SOIL_K];
+            layers[L_SOIL_C][k] = E.soil[SOIL_C];
+            layers[L_RG][k] = E.rg;
+            layers[L_RB][k] = E.rb;
+            layers[L_DD][k] = E.dd;
+            layers[L_SP][k] = E.sp;
+            layers[L_MK][k] = static_cast<double>(E.mk);
+            layers[L_HR][k] = X.Ndata[e + 1].hoar;
+            layers[L_CDOT][k] = E.CDot;
+            layers[L_METAMO][k] = E.metamo;
+
+            for (size_t ii = 0; ii < nsolutes; ii++)
+            {
+                solutes[0 * nsolutes + ii][k] = E.conc(ICE, ii);
+                solutes[1 * nsolutes + ii][k] = E.conc(WATER, ii);
+                solutes[2 * nsolutes + ii][k] = E.conc(AIR, ii);
+                solutes[3 * nsolutes + ii][k] = E.conc(SOIL, ii);
+            }
+        }
+    }
 
+    chkpt.create_variable1D("snowpack:n_layers", nfaces);
+    chkpt.put_var1D("snowpack:n_layers", n_layers.data(), nfaces);
 
-        SSdata.Canopy_Height = cfg.get<double>("sno.CanopyHeight",0);
-        SSdata.Canopy_LAI = cfg.get<double>("sno.CanopyLeafAreaIndex",0);
-        SSdata.Canopy_Direct_Throughfall = cfg.get<double>("sno.CanopyDirectThroughfall",1);
+    for (size_t f = 0; f < N_FACE_FIELDS; f++)
+    {
+        auto name = std::string("snowpack:") + face_names[f];
+        chkpt.create_variable1D(name, nfaces);
+        chkpt.put_var1D(name, faces[f].data(), nfaces);
+    }
 
-        SSdata.ErosionLevel = cfg.get<double>("sno.ErosionLevel",0);
+    for (size_t l = 0; l < N_LAYER_FIELDS; l++)
+    {
+        auto name = layer_var(layer_names[l]);
+        chkpt.create_ragged1D(name, layer_dim, total);
+        chkpt.put_var1D(name, layers[l].data(), total);
+    }
 
-        d->Xdata = boost::make_shared<SnowStation>(false,false);
-        d->Xdata->initialize(SSdata,0);
-//        d->Xdata->cos_sl = 1;
-//        d->Xdata->windward = false;
-//        d->Xdata->rho_hn = 0;
-//        d->Xdata->hn = 0;
-//        d->Xdata->mH = 0;
+    for (size_t p = 0; p < 4; p++)
+    {
+        for (size_t ii = 0; ii < nsolutes; ii++)
+        {
+            auto name = solute_var(p, ii);
+            chkpt.create_ragged1D(name, layer_dim, total);
+            chkpt.put_var1D(name, solutes[p * nsolutes + ii].data(), total);
+        }
+    }
+}
 
-        d->sp = boost::make_shared<Snowpack>(*(d->Spackconfig));
-        d->meteo = boost::make_shared<Meteo>( (d->config));
-        d->stability = boost::make_shared<Stability> ( (d->config), false);
+void Lehning_snowpack::load_checkpoint(mesh& domain, netcdf& chkpt)
+{
+    const size_t nfaces = domain->size_faces();
+    const size_t nsolutes = SnowStation::number_of_solutes;
 
-        d->sum_subl = 0;
+    std::vector<double> n_layers(nfaces);
+    chkpt.get_var1D("snowpack:n_layers", n_layers.data(), nfaces);
+
+    std::vector<size_t> offsets(nfaces + 1, 0);
+    for (size_t i = 0; i < nfaces; i++)
+        offsets[i + 1] = offsets[i] + static_cast<size_t>(n_layers[i]);
+    const size_t total = offsets.back();
+
+    std::vector< std::vector<double> > faces(N_FACE_FIELDS, std::vector<double>(nfaces));
+    for (size_t f = 0; f < N_FACE_FIELDS; f++)
+        chkpt.get_var1D(std::string("snowpack:") + face_names[f], faces[f].data(), nfaces);
 
+    std::vector< std::vector<double> > layers(N_LAYER_FIELDS, std::vector<double>(total));
+    for (size_t l = 0; l < N_LAYER_FIELDS; l++)
+        chkpt.get_var1D(layer_var(layer_names[l]), layers[l].data(), total);
+
+    std::vector< std::vector<double> > solutes(4 * nsolutes, std::vector<double>(total));
+    for (size_t p = 0; p < 4; p++)
+        for (size_t ii = 0; ii < nsolutes; ii++)
+            chkpt.get_var1D(solute_var(p, ii), solutes[p * nsolutes + ii].data(), total);
+
+    for (size_t i = 0; i < nfaces; i++)
+    {
+        auto face = domain->face(i);
+        auto d = face->get_module_data<data>(ID);
+
+        SN_SNOWSOIL_DATA SSdata = initial_snowcover(face);
+        SSdata.HS_last = faces[F_HS_LAST][i];
+        SSdata.Albedo = faces[F_ALBEDO][i];
+        SSdata.SoilAlb = faces[F_SOIL_ALB][i];
+        SSdata.BareSoil_z0 = faces[F_BARESOIL_Z0][i];
+        SSdata.WindScalingFactor = faces[F_WIND_SCALING][i];
+        SSdata.TimeCountDeltaHS = faces[F_TIME_COUNT_DELTA_HS][i];
+        SSdata.ErosionLevel = static_cast<int>(faces[F_EROSION_LEVEL][i]);
+
+        // one element per layer, so the elements come back exactly as they were
+        SSdata.nLayers = offsets[i + 1] - offsets[i];
+        SSdata.Ldata.resize(SSdata.nLayers, LayerData());
+        SSdata.nN = 1;
+        SSdata.Height = 0.;
+        for (size_t ll = 0; ll < SSdata.nLayers; ll++)
+        {
+            const size_t k = offsets[i] + ll;
+            LayerData& L = SSdata.Ldata[ll];
+
+            if (layers[L_DEPOSITION_DATE][k] != mio::IOUtils::nodata)
+                L.depositionDate = mio::Date(layers[L_DEPOSITION_DATE][k], 0.);
+            L.hl = layers[L_HL][k];
+            L.ne = 1;
+            L.tl = layers[L_TL][k];
+            L.phiIce = layers[L_PHI_ICE][k];
+            L.phiWater = layers[L_PHI_WATER][k];
+            L.phiVoids = layers[L_PHI_VOIDS][k];
+            L.phiSoil = layers[L_PHI_SOIL][k];
+            L.SoilRho = layers[L_SOIL_RHO][k];
+            L.SoilK = layers[L_SOIL_K][k];
+            L.SoilC = layers[L_SOIL_C][k];
+            L.rg = layers[L_RG][k];
+            L.rb = layers[L_RB][k];
+            L.dd = layers[L_DD][k];
+            L.sp = layers[L_SP][k];
+            L.mk = static_cast<unsigned short int>(layers[L_MK][k] + .5);
+            L.hr = layers[L_HR][k];
+            L.CDot = layers[L_CDOT][k];
+            L.metamo = layers[L_METAMO][k];
+
+            for (size_t ii = 0; ii < nsolutes; ii++)
+            {
+                L.cIce[ii] = solutes[0 * nsolutes + ii][k];
+                L.cWater[ii] = solutes[1 * nsolutes + ii][k];
+                L.cVoids[ii] = solutes[2 * nsolutes + ii][k];
+                L.cSoil[ii] = solutes[3 * nsolutes + ii][k];
+            }
+
+            SSdata.nN += L.ne;
+            SSdata.Height += L.hl;
+        }
+
+        d->Xdata = boost::make_shared<SnowStation>(false,false);
+        d->Xdata->initialize(SSdata,0);
 
+        d->cum_precip = faces[F_CUM_PRECIP][i];
+        d->sum_subl = faces[F_SUM_SUBL][i];
     }
 }
@@ -49,6 +49,13 @@ public:
 
     virtual void init(mesh& domain);
 
+    /**
+     * Saves each face's snow cover as a contiguous ragged array, one value per element, in the same fields a *.sno file
+     * holds: snowpack:n_layers is the per-face element count and each snowpack:layer_* variable holds all faces' elements back to back.
+     */
+    virtual void checkpoint(mesh& domain, netcdf& chkpt);
+    virtual void load_checkpoint(mesh& domain, netcdf& chkpt);
+
 
     struct data : public face_info
     {
@@ -70,6 +77,9 @@ public:
         double sum_subl;
     };
 
+    // the no-snow initial condition, i.e., what a *.sno file would otherwise provide
+    SN_SNOWSOIL_DATA initial_snowcover(mesh_elem& face);
+
     double sn_dt; // calculation step length
     double const_T_g; // constant ground temp, degC
 
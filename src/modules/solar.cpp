@@ -25,7 +25,7 @@
 REGISTER_MODULE_CPP(solar);
 
 solar::solar(config_file cfg)
-        : module_base("solar", parallel::data, cfg)
+        : module_base("solar", parallel::domain, cfg)
 {
     provides("solar_el");
     provides("solar_az");
@@ -36,36 +36,17 @@ solar::~solar()
 {
 
 }
-void solar::run(mesh_elem &face)
+solar::ephemeris solar::sun(const boost::posix_time::ptime& t, int utc_offset)
 {
-    double Lon = 0;
-    double Lat = 0;
-    if(global_param->is_geographic())
-    {
-        Lon = face->center().x();
-        Lat = face->center().y();
-
-    }
-    else{
-        auto data = face->get_module_data<solar::data>(ID);
-        Lon = data->lng;
-        Lat = data->lat;
-    }
-
-
-    //Following the RA DEC to Az Alt conversion sequence explained here:
-    //http://www.stargazing.net/kepler/altaz.html
-
     //UTC offset. Don't know how to use datetime's UTC converter yet....
-    boost::posix_time::time_duration UTC_offset = boost::posix_time::hours(global_param->_utc_offset);
-    std::tm tm = boost::posix_time::to_tm(global_param->posix_time()+UTC_offset);
+    boost::posix_time::time_duration UTC_offset = boost::posix_time::hours(utc_offset);
+    std::tm tm = boost::posix_time::to_tm(t+UTC_offset);
     double year =  tm.tm_year + 1900.; //convert from epoch
     double month =  tm.tm_mon + 1.;//conert jan == 0
     double day =   tm.tm_mday; //starts at 1, ok
     double hour = tm.tm_hour; // 0 = midnight, ok
     double min = tm.tm_min; // 0, ok
     double sec = tm.tm_sec; // [0,60] in c++11, ok http://en.cppreference.com/w/cpp/chrono/c/tm
-    double Alt = face->center().z();//0.; //TODO: fix this?
 
     if (month <= 2.0)
     {
@@ -80,7 +61,6 @@ void solar::run(mesh_elem &face)
     double d = jd-2451543.5;
     // Keplerian Elements for the Sun (geocentric)
     double w = 282.9404+4.70935*pow(10,-5)*d; //    (longitude of perihelion degrees)
-    double a = 1.000000;          //    (mean distance, a.u.)
     double e = 0.016709- 1.151*pow(10.,-9.)*d;  //    (eccentricity)
     double M = fmod(356.0470+0.9856002585*d,360.0); //  (mean anomaly degrees)
     double L = w + M;                     //(Sun's mean longitude degrees)
@@ -98,7 +78,6 @@ void solar::run(mesh_elem &face)
     double r = sqrt(x*x + y*y);
     double v = atan2(y,x)*(180./M_PI);
 
-
     //find the longitude of the sun
     double lon = v + w;
 
@@ -112,38 +91,57 @@ void solar::run(mesh_elem &face)
     double yequat = yeclip*cos(oblecl*(M_PI/180.))+zeclip*sin(oblecl*(M_PI/180.));
     double zequat = yeclip*sin(23.4406*(M_PI/180.))+zeclip*cos(oblecl*(M_PI/180.));
 
-    //convert equatorial rectangular coordinates to RA and Decl:
-    r = sqrt(xequat*xequat + yequat*yequat + zequat*zequat)-(Alt/149598000.0); //roll up the altitude correction
-    double RA = atan2(yequat,xequat)*(180./M_PI);
-    double delta = asin(zequat/r)*(180./M_PI);
-
-    //Find the J2000 value
-    double J2000 = jd - 2451545.0;
+    ephemeris eph;
+    eph.zequat = zequat;
+    eph.r = sqrt(xequat*xequat + yequat*yequat + zequat*zequat);
+    eph.RA = atan2(yequat,xequat)*(180./M_PI);
 
     double UTH = hour+min/60.0+sec/3600.0;   //Calculate local siderial time
     double GMST0=fmod(L+180.,360.)/15.;
-    double SIDTIME = GMST0 + UTH + Lon/15.;
+    eph.SIDTIME = GMST0 + UTH;
+
+    return eph;
+}
+
+void solar::run(mesh& domain)
+{
+    // the same for every face
+    const ephemeris eph = sun(global_param->posix_time(), global_param->_utc_offset);
 
-    //Replace RA with hour angle HA
-    double HA = (SIDTIME*15. - RA);
+    #pragma omp parallel for
+    for (size_t i = 0; i < domain->size_faces(); i++)
+    {
+        auto face = domain->face(i);
+        auto data = face->get_module_data<solar::data>(ID);
+
+        double Alt = face->center().z();//0.; //TODO: fix this?
+
+        //convert equatorial rectangular coordinates to RA and Decl:
+        double r = eph.r - (Alt/149598000.0); //roll up the altitude correction
+        double delta = asin(eph.zequat/r)*(180./M_PI);
+
+        double SIDTIME = eph.SIDTIME + data->lng_hours;
 
-    //convert to rectangular coordinate system
-    x = cos(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
-    y = sin(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
-    double z = sin(delta*(M_PI/180.));
+        //Replace RA with hour angle HA
+        double HA = (SIDTIME*15. - eph.RA);
 
-    //rotate this along an axis going east-west.
-    double xhor = x*cos((90.-Lat)*(M_PI/180.))-z*sin((90.-Lat)*(M_PI/180.));
-    double yhor = y;
-    double zhor = x*sin((90.-Lat)*(M_PI/180.))+z*cos((90.-Lat)*(M_PI/180.));
+        //convert to rectangular coordinate system
+        double x = cos(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
+        double y = sin(HA*(M_PI/180.))*cos(delta*(M_PI/180.));
+        double z = sin(delta*(M_PI/180.));
 
-    //Find the h and AZ
-    double Az = atan2(yhor,xhor)*(180./M_PI) + 180.;
-    double El = asin(zhor)*(180./M_PI);
+        //rotate this along an axis going east-west.
+        double xhor = x*data->cos_colat-z*data->sin_colat;
+        double yhor = y;
+        double zhor = x*data->sin_colat+z*data->cos_colat;
 
-    (*face)["solar_az"_s]=Az;
-    (*face)["solar_el"_s]=El;
+        //Find the h and AZ
+        double Az = atan2(yhor,xhor)*(180./M_PI) + 180.;
+        double El = asin(zhor)*(180./M_PI);
 
+        (*face)["solar_az"_s]=Az;
+        (*face)["solar_el"_s]=El;
+    }
 }
 void solar::init(mesh& domain)
 {
@@ -165,6 +163,12 @@ void solar::init(mesh& domain)
 
     bool svf_compute = cfg.get("svf.compute",true);
 
+    boost::shared_ptr<const horizon_table> horizon;
+    if(svf_compute)
+    {
+        horizon = domain->horizon_angles(N, face_stencil::uniform_steps(steps, size_of_step));
+    }
+
     OGRSpatialReference monUtm;
     OGRSpatialReference monGeo;
     OGRCoordinateTransformation* coordTrans = nullptr;
@@ -185,44 +189,34 @@ void solar::init(mesh& domain)
 
 	       auto face = domain->face(i);
 
+	       double x = face->center().x();
+	       double y = face->center().y();
+
 	       // we are UTM and need to convert internally to lat long to calc the solar position
 	       if(!domain->is_geographic())
 	       {
-		   double x = face->center().x();
-		   double y = face->center().y();
 		   int reprojected = coordTrans->Transform(1, &x, &y);
-
-		   auto d = face->make_module_data<solar::data>(ID);
-		   d->lat = y;
-		   d->lng = x;
 	       }
 
+	       auto d = face->make_module_data<solar::data>(ID);
+	       d->lat = y;
+	       d->lng = x;
+	       d->lng_hours = x/15.;
+	       d->cos_colat = cos((90.-y)*(M_PI/180.));
+	       d->sin_colat = sin((90.-y)*(M_PI/180.));
+
 	       double svf = 0.0;
 
 	       if(svf_compute)
 	       {
-               Point_3 me = face->center();
                auto cosSlope = cos(face->slope());
                auto sinSlope = sin(face->slope());
 
                //for each search azimuthal sector
                for (int k = 0; k < N; k++)
                {
-                   double phi = 0.;
-                   // search along each azimuth in j step increments to find horizon angle
-                   for (int j = 1; j <= steps; ++j)
-                   {
-                   double distance = j * size_of_step;
-
-                   auto f = domain->find_closest_face(math::gis::point_from_bearing(me, k * azimuthal_width, distance));
-
-                   double z_diff = (f->center().z() - me.z());
-                   if (z_diff > 0)
-                   {
-                       double dist = math::gis::distance(f->center(), me);
-                       phi = std::max(atan(z_diff / dist), phi);
-                   }
-                   }
+                   // horizon angle of this sector
+                   double phi = horizon->at(i, k);
 
                    auto cosPhi = cos(phi);
                    auto sinPhi = sin(phi);
@@ -32,7 +32,8 @@
  * @{
  * \class solar
  * \brief Calculates solar position. Deals with UTM/geographic meshes.
- * This could have be it's own function, however was put into a module so-as to be able to cache the results if it is a UTM grid
+ * The sun's position in equatorial coordinates is the same for every face at a given time, so it is computed once per
+ * timestep (solar::ephemeris). Each face then only converts it to its own horizon, using its lat/long cached at init.
  *
  * Depends:
  *
@@ -43,15 +44,38 @@ class solar : public module_base
 REGISTER_MODULE_HPP(solar);
 public:
 
-    //if we have a UTM mesh, cache the calculated lat and long
+    //cache the lat and long of each face, plus what only depends on them
     struct data : public face_info
     {
         double lat;
         double lng;
+
+        double lng_hours;   // lng / 15
+        double cos_colat;   // cos(90 - lat)
+        double sin_colat;   // sin(90 - lat)
     };
 
+    /**
+     * Position of the sun at one instant, independent of where it is seen from.
+     * Following the RA DEC to Az Alt conversion sequence explained here: http://www.stargazing.net/kepler/altaz.html
+     */
+    struct ephemeris
+    {
+        double zequat;  // equatorial rectangular z
+        double r;       // distance, a.u.
+        double RA;      // right ascension, degrees
+        double SIDTIME; // local sidereal time at longitude 0, hours
+    };
+
+    /**
+     * @param t Model time, UTC is t + utc_offset hours
+     * @param utc_offset
+     * @return
+     */
+    static ephemeris sun(const boost::posix_time::ptime& t, int utc_offset);
+
     solar(config_file cfg);
     ~solar();
-    void run(mesh_elem &face);
+    void run(mesh& domain);
     void init(mesh& domain);
 };
@@ -0,0 +1,129 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "output_writer.hpp"
+
+#include <algorithm>
+
+output_writer::output_writer(size_t capacity)
+{
+    _capacity = std::max<size_t>(1, capacity);
+    _busy = false;
+    _stop = false;
+    _stalls = 0;
+}
+
+output_writer::~output_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _not_empty.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void output_writer::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = std::max<size_t>(1, capacity);
+}
+
+void output_writer::submit(std::function<void()> job)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _rethrow();
+
+    if (!_thread.joinable())
+        _thread = std::thread(&output_writer::_run, this);
+
+    if (_queue.size() >= _capacity)
+    {
+        ++_stalls;
+        _not_full.wait(lock, [this] { return _queue.size() < _capacity; });
+        _rethrow();
+    }
+
+    _queue.push_back(std::move(job));
+    lock.unlock();
+    _not_empty.notify_one();
+}
+
+void output_writer::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _queue.empty() && !_busy; });
+    _rethrow();
+}
+
+size_t output_writer::stalls()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stalls;
+}
+
+void output_writer::_rethrow()
+{
+    if (_error)
+    {
+        auto e = _error;
+        _error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void output_writer::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _not_empty.wait(lock, [this] { return _stop || !_queue.empty(); });
+        if (_queue.empty()) // and _stop
+            break;
+
+        auto job = std::move(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+        lock.unlock();
+        _not_full.notify_one();
+
+        try
+        {
+            job();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> error_lock(_mutex);
+            if (!_error)
+                _error = std::current_exception();
+        }
+
+        lock.lock();
+        _busy = false;
+        if (_queue.empty())
+            _idle.notify_all();
+    }
+}
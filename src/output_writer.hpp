@@ -0,0 +1,98 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * \class output_writer
+ * \brief Runs output jobs on a dedicated thread, behind a bounded queue
+ *
+ * The timestep loop snapshots the data it wants written into a job and submits it. The job is then written while the
+ * model carries on with the next timesteps. submit() only blocks, i.e., back-pressure, once capacity jobs are
+ * waiting, which means the writer has fallen behind.
+ *
+ * Jobs run one at a time and in submission order. If a job throws, the first exception is rethrown by the next call
+ * to submit() or wait().
+ */
+class output_writer
+{
+public:
+    /**
+     * @param capacity Number of jobs that may be waiting before submit() blocks. At least 1.
+     */
+    explicit output_writer(size_t capacity = 2);
+
+    /**
+     * Finishes the outstanding jobs. Errors are dropped, call wait() first to see them.
+     */
+    ~output_writer();
+
+    /**
+     * Only to be called while nothing is queued
+     * @param capacity
+     */
+    void set_capacity(size_t capacity);
+
+    /**
+     * Queues a job, blocking while the queue is full. The writer thread is started on the first call.
+     * @param job
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * Blocks until every submitted job has run
+     */
+    void wait();
+
+    /**
+     * Number of times submit() had to wait for the writer
+     */
+    size_t stalls();
+
+private:
+    void _run();
+    void _rethrow(); // with _mutex held
+
+    std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    std::condition_variable _idle;
+
+    std::deque< std::function<void()> > _queue;
+    size_t _capacity;
+    bool _busy; // a job is running
+    bool _stop;
+    size_t _stalls;
+    std::exception_ptr _error;
+
+    std::thread _thread;
+};
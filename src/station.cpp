@@ -107,6 +107,11 @@ double station::get(std::string variable)
     return _itr->get(variable);
 }
 
+double station::get(size_t column)
+{
+    return _itr->get(column);
+}
+
 void station::add_variable(std::string var)
 {
     raw_timeseries()->init_new_variable(var);
@@ -119,6 +124,7 @@ void station::reset_itrs()
 
 bool station::next()
 {
+    //the iterators are just row indexes, so this doesn't allocate
     ++_itr;
     if (_itr == _obs->end())
         return false;
@@ -182,6 +182,13 @@ public:
     */
     double get(std::string variable);
 
+    /**
+    * Returns the variable in the given column of the station at the current timestep. Avoids the name lookup of get(std::string)
+    * \param column column index from raw_timeseries()->column_index()
+    * \return value of the requested variable
+    */
+    double get(size_t column);
+
     /**
      * Save the internal timeseres to a file
      * \param filename
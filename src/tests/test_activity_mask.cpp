@@ -0,0 +1,88 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "mesh/activity_mask.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ActivityMask, collects_active_faces)
+{
+    std::vector<double> swe = {0, 5, 0, 0, 12, 3};
+
+    activity_mask mask;
+    mask.update(swe.size(), [&](size_t i) -> bool { return swe[i] > 0; });
+
+    EXPECT_EQ(3u, mask.count());
+    EXPECT_FALSE(mask.none());
+    EXPECT_FALSE(mask.all());
+    EXPECT_EQ(std::vector<size_t>({1, 4, 5}), mask.faces());
+
+    for (size_t i = 0; i < swe.size(); i++)
+        EXPECT_EQ(swe[i] > 0, mask.active(i));
+}
+
+TEST(ActivityMask, none_and_all)
+{
+    activity_mask mask;
+    mask.update(4, [](size_t) -> bool { return false; });
+    EXPECT_TRUE(mask.none());
+    EXPECT_FALSE(mask.all());
+    EXPECT_TRUE(mask.faces().empty());
+
+    mask.update(4, [](size_t) -> bool { return true; });
+    EXPECT_FALSE(mask.none());
+    EXPECT_TRUE(mask.all());
+    EXPECT_EQ(4u, mask.count());
+}
+
+TEST(ActivityMask, update_replaces_previous_mask)
+{
+    activity_mask mask;
+    mask.update(5, [](size_t i) -> bool { return i < 3; });
+    EXPECT_EQ(3u, mask.count());
+
+    mask.update(5, [](size_t i) -> bool { return i == 4; });
+    EXPECT_EQ(std::vector<size_t>({4}), mask.faces());
+    EXPECT_FALSE(mask.active(0));
+    EXPECT_TRUE(mask.active(4));
+
+    // mesh size changes, e.g., a different domain
+    mask.update(2, [](size_t) -> bool { return true; });
+    EXPECT_TRUE(mask.all());
+    EXPECT_EQ(2u, mask.count());
+}
+
+TEST(ActivityMask, large_mask_in_order)
+{
+    const size_t n = 100000;
+    activity_mask mask;
+    mask.update(n, [](size_t i) -> bool { return i % 7 == 3; });
+
+    ASSERT_EQ((n + 3) / 7, mask.count());
+    for (size_t k = 0; k < mask.count(); k++)
+        EXPECT_EQ(7 * k + 3, mask.faces()[k]);
+}
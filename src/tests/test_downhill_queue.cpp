@@ -0,0 +1,180 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "mesh/downhill_queue.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // a face graph of up to 3 neighbours per face, like a triangulation, with snow_slide-like redistribution
+    struct slope
+    {
+        std::vector<std::vector<size_t>> neighbours;
+        std::vector<double> z;        // visiting order, fixed at the start
+        std::vector<double> depth;
+        std::vector<double> capacity;
+        std::vector<size_t> avalanched; // faces that gave snow away, in order
+
+        slope(size_t n, unsigned seed, bool ties)
+            : neighbours(n), z(n), depth(n), capacity(n)
+        {
+            srand(seed);
+            for (size_t i = 0; i < n; i++)
+            {
+                z[i] = ties ? rand() % 8 : 100.0 * rand() / RAND_MAX;
+                depth[i] = 2.0 * rand() / RAND_MAX;
+                capacity[i] = 1.5;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    size_t j = rand() % n;
+                    if (j != i && neighbours[i].size() < 3 && neighbours[j].size() < 3 &&
+                        std::find(neighbours[i].begin(), neighbours[i].end(), j) == neighbours[i].end())
+                    {
+                        neighbours[i].push_back(j);
+                        neighbours[j].push_back(i);
+                    }
+                }
+            }
+        }
+
+        // Sends the depth above capacity to the neighbours whose surface is lower, weighted by the difference
+        void visit(size_t i, std::vector<size_t>& receivers)
+        {
+            if (depth[i] <= capacity[i])
+                return;
+
+            double s = z[i] + depth[i];
+            std::vector<double> w(neighbours[i].size());
+            double sum = 0;
+            for (size_t k = 0; k < w.size(); k++)
+            {
+                size_t j = neighbours[i][k];
+                w[k] = std::max(0.0, s - (z[j] + depth[j]));
+                sum += w[k];
+            }
+            if (sum == 0)
+                return;
+
+            double excess = depth[i] - capacity[i];
+            for (size_t k = 0; k < w.size(); k++)
+            {
+                if (w[k] == 0)
+                    continue;
+                depth[neighbours[i][k]] += excess * w[k] / sum;
+                receivers.push_back(neighbours[i][k]);
+            }
+            depth[i] = capacity[i];
+            avalanched.push_back(i);
+        }
+    };
+
+    // every face, in the same (z, index) descending order as downhill_queue
+    void full_sort(slope& m)
+    {
+        std::vector<size_t> order(m.z.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return std::make_pair(m.z[a], a) > std::make_pair(m.z[b], b);
+        });
+
+        std::vector<size_t> ignored;
+        for (auto i : order)
+            m.visit(i, ignored);
+    }
+
+    void queued(slope& m, downhill_queue& q)
+    {
+        std::vector<size_t> seeds;
+        for (size_t i = 0; i < m.z.size(); i++)
+        {
+            if (m.depth[i] > m.capacity[i])
+                seeds.push_back(i);
+        }
+
+        q.run(m.z.size(), seeds, [&](size_t i) { return m.z[i]; },
+              [&](size_t i, std::vector<size_t>& receivers) { m.visit(i, receivers); });
+    }
+}
+
+TEST(DownhillQueue, matches_full_sort_on_random_graphs)
+{
+    downhill_queue q; // reused, as snow_slide does
+    for (unsigned seed = 1; seed <= 200; seed++)
+    {
+        for (bool ties : {false, true})
+        {
+            slope a(300, seed, ties);
+            slope b(300, seed, ties);
+
+            full_sort(a);
+            queued(b, q);
+
+            ASSERT_FALSE(a.avalanched.empty());
+            ASSERT_EQ(a.avalanched, b.avalanched) << "seed " << seed;
+            ASSERT_EQ(a.depth, b.depth) << "seed " << seed;
+        }
+    }
+}
+
+TEST(DownhillQueue, only_visits_seeds_and_receivers)
+{
+    // a chain 0 - 1 - 2 - 3 going down, and an unconnected face 4
+    std::vector<double> z = {4, 3, 2, 1, 10};
+    std::vector<std::vector<size_t>> next = {{1}, {2}, {}, {}, {}};
+
+    std::vector<size_t> visited;
+    downhill_queue q;
+    q.run(z.size(), {0}, [&](size_t i) { return z[i]; },
+          [&](size_t i, std::vector<size_t>& receivers) {
+              visited.push_back(i);
+              receivers.insert(receivers.end(), next[i].begin(), next[i].end());
+          });
+    EXPECT_EQ(std::vector<size_t>({0, 1, 2}), visited);
+}
+
+TEST(DownhillQueue, skips_higher_receivers)
+{
+    // 1 is higher than 0, so a full sort would already have passed it
+    std::vector<double> z = {1, 2, 0};
+
+    std::vector<size_t> visited;
+    downhill_queue q;
+    q.run(z.size(), {0}, [&](size_t i) { return z[i]; },
+          [&](size_t i, std::vector<size_t>& receivers) {
+              visited.push_back(i);
+              if (i == 0)
+                  receivers = {1, 2, 2};
+          });
+    EXPECT_EQ(std::vector<size_t>({0, 2}), visited);
+}
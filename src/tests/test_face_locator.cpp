@@ -0,0 +1,348 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "mesh/face_locator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::vector<double> random_points(size_t n, double scale, unsigned seed)
+    {
+        srand(seed);
+        std::vector<double> p(2 * n);
+        for (auto& v : p)
+            v = scale * rand() / RAND_MAX;
+        return p;
+    }
+
+    // Just enough of a triangulation for walk_to and face_locator::locate
+    struct mock_point
+    {
+        double px, py;
+        double x() const { return px; }
+        double y() const { return py; }
+    };
+
+    struct mock_vertex
+    {
+        mock_point p;
+        mock_point point() const { return p; }
+    };
+
+    struct mock_face
+    {
+        mock_vertex* v[3];
+        mock_face* n[3]; // n[i] is across from v[i]
+        bool _is_ghost;
+
+        mock_vertex* vertex(int i) { return v[i]; }
+        mock_face* neighbor(int i) { return n[i]; }
+
+        // same strict barycentric test as face::contains, so points on an edge aren't contained
+        bool contains(double x, double y)
+        {
+            double x1 = v[1]->p.px, y1 = v[1]->p.py;
+            double x2 = v[2]->p.px, y2 = v[2]->p.py;
+            double x3 = v[0]->p.px, y3 = v[0]->p.py;
+            double l1 = ((y2 - y3) * (x - x3) + (x3 - x2) * (y - y3)) / ((y2 - y3) * (x1 - x3) + (x3 - x2) * (y1 - y3));
+            double l2 = ((y3 - y1) * (x - x3) + (x1 - x3) * (y - y3)) / ((y3 - y1) * (x2 - x3) + (x1 - x3) * (y2 - y3));
+            double l3 = 1.0 - l1 - l2;
+            return l1 > 0 && l1 < 1 && l2 > 0 && l2 < 1 && l3 > 0 && l3 < 1;
+        }
+
+        double cx() const { return (v[0]->p.px + v[1]->p.px + v[2]->p.px) / 3; }
+        double cy() const { return (v[0]->p.py + v[1]->p.py + v[2]->p.py) / 3; }
+    };
+
+    struct mock_mesh
+    {
+        std::vector<std::unique_ptr<mock_vertex>> vertexes;
+        std::vector<std::unique_ptr<mock_face>> faces;
+
+        // a grid of nx by ny cells over [x0, x0 + nx*dx] x [y0, y0 + ny*dy], two triangles per cell, each with a
+        // random winding and starting vertex. jitter moves the interior vertexes by up to that fraction of a cell
+        void add_grid(size_t nx, size_t ny, double x0, double y0, double dx, double dy, double jitter)
+        {
+            size_t base = vertexes.size();
+            for (size_t r = 0; r <= ny; r++)
+            {
+                for (size_t c = 0; c <= nx; c++)
+                {
+                    bool interior = r > 0 && r < ny && c > 0 && c < nx;
+                    double jx = interior ? jitter * dx * (2.0 * rand() / RAND_MAX - 1) : 0;
+                    double jy = interior ? jitter * dy * (2.0 * rand() / RAND_MAX - 1) : 0;
+                    vertexes.emplace_back(new mock_vertex{{x0 + c * dx + jx, y0 + r * dy + jy}});
+                }
+            }
+
+            auto vid = [&](size_t c, size_t r) { return vertexes[base + r * (nx + 1) + c].get(); };
+            for (size_t r = 0; r < ny; r++)
+            {
+                for (size_t c = 0; c < nx; c++)
+                {
+                    add_face(vid(c, r), vid(c + 1, r), vid(c + 1, r + 1));
+                    add_face(vid(c, r), vid(c + 1, r + 1), vid(c, r + 1));
+                }
+            }
+        }
+
+        void add_face(mock_vertex* a, mock_vertex* b, mock_vertex* c)
+        {
+            mock_vertex* v[3] = {a, b, c};
+            if (rand() % 2)
+                std::swap(v[1], v[2]);
+            std::rotate(v, v + rand() % 3, v + 3);
+
+            faces.emplace_back(new mock_face{{v[0], v[1], v[2]}, {nullptr, nullptr, nullptr}, false});
+        }
+
+        // sets the neighbours from the shared edges
+        void connect()
+        {
+            std::map<std::pair<mock_vertex*, mock_vertex*>, std::pair<mock_face*, int>> edges;
+            for (auto& f : faces)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    auto e = std::minmax(f->v[(i + 1) % 3], f->v[(i + 2) % 3]);
+                    auto it = edges.find(e);
+                    if (it == edges.end())
+                    {
+                        edges[e] = std::make_pair(f.get(), i);
+                    }
+                    else
+                    {
+                        f->n[i] = it->second.first;
+                        it->second.first->n[it->second.second] = f.get();
+                    }
+                }
+            }
+        }
+
+        face_locator locator() const
+        {
+            std::vector<double> centers;
+            double extent = 0;
+            for (auto& f : faces)
+            {
+                centers.push_back(f->cx());
+                centers.push_back(f->cy());
+                for (int i = 0; i < 3; i++)
+                    extent = std::max(extent, std::hypot(f->v[i]->p.px - f->cx(), f->v[i]->p.py - f->cy()));
+            }
+            return face_locator(centers, extent);
+        }
+
+        mock_face* brute_locate(double x, double y) const
+        {
+            for (auto& f : faces)
+            {
+                if (!f->_is_ghost && f->contains(x, y))
+                    return f.get();
+            }
+            return nullptr;
+        }
+    };
+
+    size_t brute_closest(const std::vector<double>& c, double x, double y)
+    {
+        size_t best = 0;
+        double bd = 1e300;
+        for (size_t i = 0; i < c.size() / 2; i++)
+        {
+            double d = (c[2 * i] - x) * (c[2 * i] - x) + (c[2 * i + 1] - y) * (c[2 * i + 1] - y);
+            if (d < bd)
+            {
+                bd = d;
+                best = i;
+            }
+        }
+        return best;
+    }
+}
+
+TEST(face_locator, closest_matches_brute_force)
+{
+    auto centers = random_points(5000, 1000, 1);
+    // a dense cluster, so the buckets are uneven
+    auto cluster = random_points(2000, 10, 2);
+    centers.insert(centers.end(), cluster.begin(), cluster.end());
+
+    face_locator loc(centers, 0);
+    ASSERT_EQ(loc.size(), 7000u);
+
+    auto queries = random_points(2000, 1400, 3);
+    for (size_t q = 0; q < queries.size() / 2; q++)
+    {
+        // inside and outside the grid
+        double x = queries[2 * q] - 200;
+        double y = queries[2 * q + 1] - 200;
+        EXPECT_EQ(loc.closest(x, y), brute_closest(centers, x, y));
+    }
+}
+
+TEST(face_locator, in_radius)
+{
+    auto centers = random_points(3000, 500, 4);
+    face_locator loc(centers, 0);
+
+    auto queries = random_points(200, 600, 5);
+    for (size_t q = 0; q < queries.size() / 2; q++)
+    {
+        double x = queries[2 * q] - 50;
+        double y = queries[2 * q + 1] - 50;
+        double radius = 5 + q % 60;
+
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < centers.size() / 2; i++)
+        {
+            double dx = centers[2 * i] - x;
+            double dy = centers[2 * i + 1] - y;
+            if (dx * dx + dy * dy <= radius * radius)
+                expected.push_back(i);
+        }
+        EXPECT_EQ(loc.in_radius(x, y, radius), expected);
+    }
+}
+
+TEST(face_locator, degenerate)
+{
+    // all on a line, and a single point
+    std::vector<double> line;
+    for (int i = 0; i < 100; i++)
+    {
+        line.push_back(i);
+        line.push_back(5);
+    }
+    face_locator loc(line, 0);
+    EXPECT_EQ(loc.closest(41.2, -30), 41u);
+    EXPECT_EQ(loc.closest(500, 5), 99u);
+
+    face_locator one(std::vector<double>{3, 4}, 0);
+    EXPECT_EQ(one.closest(-100, 100), 0u);
+    EXPECT_EQ(one.in_radius(3, 5, 1).size(), 1u);
+    EXPECT_TRUE(one.in_radius(3, 6, 1).empty());
+}
+
+TEST(face_locator, locate_walks_mixed_windings)
+{
+    srand(6);
+    mock_mesh m;
+    m.add_grid(60, 40, 0, 0, 10, 15, 0.3);
+    m.connect();
+
+    // a few ghost faces, which are never returned
+    for (size_t i = 0; i < m.faces.size(); i += 37)
+        m.faces[i]->_is_ghost = true;
+
+    auto loc = m.locator();
+    auto face = [&](size_t i) { return m.faces[i].get(); };
+
+    size_t found = 0;
+    mock_face* prev = nullptr;
+    auto q = random_points(20000, 700, 7);
+    for (size_t i = 0; i < q.size() / 2; i++)
+    {
+        // some outside of the mesh too
+        double x = q[2 * i] - 50;
+        double y = q[2 * i + 1] - 50;
+
+        auto expected = m.brute_locate(x, y);
+        ASSERT_EQ(loc.locate(x, y, face), expected) << x << ", " << y;
+        found += expected != nullptr;
+
+        // as locate_faces does, walking on from the previous hit. It may stop at a ghost face, but never elsewhere
+        if (prev && expected)
+        {
+            auto w = walk_to(prev, x, y, 1000000);
+            EXPECT_TRUE(w == expected || w == nullptr);
+        }
+        if (expected)
+            prev = expected;
+    }
+    EXPECT_GT(found, 10000u);
+}
+
+TEST(face_locator, locate_falls_back_around_concave_boundary)
+{
+    srand(8);
+    mock_mesh m;
+    // long thin triangles below a slit, small ones above it. Points just below the slit have their closest center
+    // above it, so the walk runs off the upper strip's edge
+    m.add_grid(10, 1, 0, 0, 10, 10, 0);
+    m.add_grid(40, 2, 0, 10.1, 2.5, 0.25, 0);
+    m.connect();
+
+    auto loc = m.locator();
+    auto face = [&](size_t i) { return m.faces[i].get(); };
+
+    size_t fallbacks = 0;
+    for (double x = 0.3; x < 100; x += 1.7)
+    {
+        double y = 9.95;
+        auto expected = m.brute_locate(x, y);
+        ASSERT_NE(expected, nullptr);
+
+        auto start = face(loc.closest(x, y));
+        if (start->cy() > 10 && walk_to(start, x, y) == nullptr)
+            fallbacks++;
+
+        EXPECT_EQ(loc.locate(x, y, face), expected) << x;
+    }
+    EXPECT_GT(fallbacks, 0u);
+
+    // in the slit itself
+    EXPECT_EQ(loc.locate(50.3, 10.05, face), nullptr);
+}
+
+TEST(face_locator, locate_on_shared_edge_is_null)
+{
+    srand(9);
+    mock_mesh m;
+    m.add_grid(8, 8, 0, 0, 1, 1, 0);
+    m.connect();
+
+    auto loc = m.locator();
+    auto face = [&](size_t i) { return m.faces[i].get(); };
+
+    // a diagonal, a horizontal and a vertical edge, and a vertex
+    EXPECT_EQ(loc.locate(3.5, 3.5, face), nullptr);
+    EXPECT_EQ(loc.locate(2.25, 4.0, face), nullptr);
+    EXPECT_EQ(loc.locate(5.0, 1.75, face), nullptr);
+    EXPECT_EQ(loc.locate(4.0, 4.0, face), nullptr);
+
+    // just off the diagonal
+    EXPECT_NE(loc.locate(3.5, 3.5001, face), nullptr);
+    EXPECT_EQ(loc.locate(3.5, 3.5001, face), m.brute_locate(3.5, 3.5001));
+}
+
@@ -0,0 +1,122 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "face_order.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // cell centres of an nx by ny grid, listed in a scrambled order
+    void grid(size_t nx, size_t ny, std::vector<double>& x, std::vector<double>& y)
+    {
+        x.clear();
+        y.clear();
+        for (size_t k = 0; k < nx * ny; k++)
+        {
+            size_t i = (k * 7919) % (nx * ny);
+            x.push_back(static_cast<double>(i % nx) + 0.5);
+            y.push_back(static_cast<double>(i / nx) + 0.5);
+        }
+    }
+
+    bool is_permutation(std::vector<size_t> order, size_t n)
+    {
+        std::sort(order.begin(), order.end());
+        std::vector<size_t> expected(n);
+        std::iota(expected.begin(), expected.end(), 0);
+        return order == expected;
+    }
+}
+
+TEST(FaceOrder, hilbert_steps_to_a_neighbour)
+{
+    std::vector<double> x, y;
+    grid(16, 16, x, y);
+
+    auto order = face_order::hilbert(x, y);
+    ASSERT_TRUE(is_permutation(order, x.size()));
+
+    for (size_t i = 1; i < order.size(); i++)
+    {
+        double d = std::fabs(x[order[i]] - x[order[i - 1]]) + std::fabs(y[order[i]] - y[order[i - 1]]);
+        EXPECT_DOUBLE_EQ(1.0, d) << "at " << i;
+    }
+}
+
+TEST(FaceOrder, morton_is_a_permutation)
+{
+    std::vector<double> x, y;
+    grid(13, 7, x, y);
+
+    auto order = face_order::morton(x, y);
+    EXPECT_TRUE(is_permutation(order, x.size()));
+}
+
+TEST(FaceOrder, coordinate_bisection_splits_the_long_axis)
+{
+    std::vector<double> x, y;
+    grid(16, 4, x, y);
+
+    auto order = face_order::coordinate_bisection(x, y);
+    ASSERT_TRUE(is_permutation(order, x.size()));
+
+    // the first half of the ordering is the left half of the grid
+    for (size_t i = 0; i < order.size() / 2; i++)
+        EXPECT_LT(x[order[i]], 8.0);
+}
+
+TEST(FaceOrder, graph_bisection_follows_the_adjacency)
+{
+    // a chain of faces, numbered out of order
+    const size_t n = 50;
+    std::vector<size_t> label(n);
+    for (size_t i = 0; i < n; i++)
+        label[i] = (i * 17) % n;
+
+    std::vector<size_t> neighbours(3 * n, face_order::no_neighbour);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i > 0)
+            neighbours[3 * label[i]] = label[i - 1];
+        if (i + 1 < n)
+            neighbours[3 * label[i] + 1] = label[i + 1];
+    }
+
+    auto order = face_order::graph_bisection(neighbours);
+    ASSERT_TRUE(is_permutation(order, n));
+
+    for (size_t i = 1; i < n; i++)
+    {
+        auto& nb = neighbours;
+        size_t a = order[i - 1], b = order[i];
+        EXPECT_TRUE(nb[3 * a] == b || nb[3 * a + 1] == b) << "at " << i;
+    }
+}
@@ -0,0 +1,86 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "mesh/horizon_table.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(horizon_table, interpolates_between_sectors)
+{
+    horizon_table h(1, 4, {100, 200});
+    h.at(0, 0) = 0.4f; // N
+    h.at(0, 1) = 0.2f; // E
+    h.at(0, 3) = 0.0f; // W
+
+    EXPECT_NEAR(h.horizon(0, 0), 0.4, 1e-6);
+    EXPECT_NEAR(h.horizon(0, 45), 0.3, 1e-6);
+    EXPECT_NEAR(h.horizon(0, 90), 0.2, 1e-6);
+    EXPECT_NEAR(h.horizon(0, 315), 0.2, 1e-6); // wraps W -> N
+    EXPECT_NEAR(h.horizon(0, -45), 0.2, 1e-6);
+    EXPECT_NEAR(h.horizon(0, 360), 0.4, 1e-6);
+
+    EXPECT_TRUE(h.shadowed(0, 0, 20));  // 0.4 rad ~ 22.9 deg
+    EXPECT_FALSE(h.shadowed(0, 0, 25));
+}
+
+TEST(horizon_table, save_load)
+{
+    std::string file = "test_horizon_table.bin";
+
+    horizon_table h(3, 8, {50, 100});
+    h.set_checksum(1234.5);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t k = 0; k < 8; k++)
+            h.at(i, k) = 0.01f * (i * 8 + k);
+    h.save(file);
+
+    horizon_table same(3, 8, {50, 100});
+    same.set_checksum(1234.5);
+    ASSERT_TRUE(same.load(file));
+    for (size_t i = 0; i < 3; i++)
+        for (size_t k = 0; k < 8; k++)
+            EXPECT_EQ(h.at(i, k), same.at(i, k));
+
+    horizon_table other_mesh(3, 8, {50, 100});
+    other_mesh.set_checksum(1.0);
+    EXPECT_FALSE(other_mesh.load(file));
+    EXPECT_EQ(other_mesh.at(2, 7), 0.f);
+
+    horizon_table other_sectors(3, 12, {50, 100});
+    other_sectors.set_checksum(1234.5);
+    EXPECT_FALSE(other_sectors.load(file));
+
+    horizon_table other_distances(3, 8, {50, 150});
+    other_distances.set_checksum(1234.5);
+    EXPECT_FALSE(other_distances.load(file));
+
+    EXPECT_FALSE(same.load("does_not_exist.bin"));
+
+    std::remove(file.c_str());
+}
@@ -165,3 +165,71 @@ TEST_F(InterpTest,interpolation_class_static_size2)
 
 
 }
+
+TEST_F(InterpTest,batch_matches_single)
+{
+    std::vector<double> sx = {69., 59., 75., 86., 88.};
+    std::vector<double> sy = {76., 64., 52., 73., 53.};
+    std::vector<double> sz = {20.820, 10.910, 10.380, 14.600, 10.560};
+
+    std::vector<boost::tuple<double,double,double> > xy;
+    for(size_t i = 0; i < sx.size(); i++)
+        xy.push_back( boost::make_tuple(sx[i],sy[i],sz[i]));
+
+    std::vector<double> qx = {69., 60., 80., 87.5, 70.};
+    std::vector<double> qy = {67., 60., 70., 55., 50.};
+
+    for(auto ia : {interp_alg::tpspline, interp_alg::idw})
+    {
+        interpolation s(ia);
+        interpolation batch(ia);
+
+        std::vector<double> out(qx.size());
+        batch.batch(sx.size(), sx.data(), sy.data(), sz.data(), qx.size(), qx.data(), qy.data(), out.data());
+
+        for(size_t q = 0; q < qx.size(); q++)
+        {
+            auto query = boost::make_tuple(qx[q],qy[q],0.);
+            ASSERT_NEAR(out[q], s(xy,query), 1e-5);
+        }
+    }
+}
+
+TEST_F(InterpTest,idw_coincident_station)
+{
+    // the 2nd and 4th stations share a location, the first one there is taken exactly
+    std::vector<double> sx = {69., 59., 75., 59., 88.};
+    std::vector<double> sy = {76., 64., 52., 64., 53.};
+    std::vector<double> sz = {20.820, 10.910, 10.380, 14.600, 10.560};
+
+    std::vector<boost::tuple<double,double,double> > xy;
+    for(size_t i = 0; i < sx.size(); i++)
+        xy.push_back( boost::make_tuple(sx[i],sy[i],sz[i]));
+
+    // on a station, on the shared location, and 1 mm away from a station
+    std::vector<double> qx = {75., 59., 88.001};
+    std::vector<double> qy = {52., 64., 53.};
+
+    interpolation s(interp_alg::idw);
+    interpolation batch(interp_alg::idw);
+
+    std::vector<double> out(qx.size());
+    batch.batch(sx.size(), sx.data(), sy.data(), sz.data(), qx.size(), qx.data(), qy.data(), out.data());
+
+    for(size_t q = 0; q < qx.size(); q++)
+    {
+        auto query = boost::make_tuple(qx[q],qy[q],0.);
+        ASSERT_NEAR(out[q], s(xy,query), 1e-9);
+    }
+    ASSERT_DOUBLE_EQ(out[0], 10.380);
+    ASSERT_DOUBLE_EQ(out[1], 10.910);
+    ASSERT_NEAR(out[2], 10.560, 1e-3);
+}
+
+TEST_F(InterpTest,fast_e1_log)
+{
+    for(double x : {1e-6, 0.01, 0.5, 1.0, 1.5, 5., 50.})
+    {
+        ASSERT_NEAR(thin_plate_spline::fast_e1_log(x), gsl_sf_expint_E1(x) + log(x), 1e-6);
+    }
+}
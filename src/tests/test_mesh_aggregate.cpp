@@ -0,0 +1,153 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "mesh/mesh_aggregate.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    using boost::posix_time::hours;
+    using boost::posix_time::ptime;
+
+    // two variables on two faces, [variable][face]
+    std::vector<double> values(double a0, double a1, double b0, double b1)
+    {
+        return {a0, a1, b0, b1};
+    }
+}
+
+TEST(MeshAggregate, reduces_over_a_day)
+{
+    ptime t(boost::gregorian::date(2020, 1, 1), hours(1));
+
+    mesh_aggregate mean(2, mesh_aggregate::period::day, {"a", "b"},
+                        {mesh_aggregate::stat::mean, mesh_aggregate::stat::sum});
+    mesh_aggregate minmax(2, mesh_aggregate::period::day, {"a", "b"},
+                          {mesh_aggregate::stat::min, mesh_aggregate::stat::max});
+
+    const double a[] = {1, 4, -2};
+    for (int k = 0; k < 3; k++)
+    {
+        auto v = values(a[k], 10 * k, a[k] * 0.5, -9999);
+        mean.add(v, t + hours(k));
+        minmax.add(v, t + hours(k));
+    }
+
+    EXPECT_EQ(3u, mean.count());
+    EXPECT_EQ(ptime(boost::gregorian::date(2020, 1, 1)), mean.start());
+    EXPECT_FALSE(mean.closed_by(t + hours(22)));
+    EXPECT_TRUE(mean.closed_by(t + hours(23)));
+
+    auto r = mean.result();
+    ASSERT_EQ(4u, r.size());
+    EXPECT_FLOAT_EQ(1.f, r[0]);      // mean a, face 0
+    EXPECT_FLOAT_EQ(10.f, r[1]);     // mean a, face 1
+    EXPECT_FLOAT_EQ(1.5f, r[2]);     // sum b, face 0
+    EXPECT_FLOAT_EQ(-9999.f, r[3]);  // sum b, face 1, never valid
+
+    r = minmax.result();
+    EXPECT_FLOAT_EQ(-2.f, r[0]);
+    EXPECT_FLOAT_EQ(0.f, r[1]);
+    EXPECT_FLOAT_EQ(2.f, r[2]);
+    EXPECT_FLOAT_EQ(-9999.f, r[3]);
+}
+
+TEST(MeshAggregate, skips_missing_values)
+{
+    ptime t(boost::gregorian::date(2020, 1, 1));
+    mesh_aggregate agg(2, mesh_aggregate::period::day, {"a", "b"},
+                       {mesh_aggregate::stat::mean, mesh_aggregate::stat::last});
+
+    agg.add(values(2, -9999, 1, 5), t);
+    agg.add(values(-9999, -9999, 2, -9999), t + hours(1));
+    agg.add(values(4, 3, 3, -9999), t + hours(2));
+
+    auto r = agg.result();
+    EXPECT_FLOAT_EQ(3.f, r[0]);  // (2 + 4) / 2, not / 3
+    EXPECT_FLOAT_EQ(3.f, r[1]);
+    EXPECT_FLOAT_EQ(3.f, r[2]);
+    EXPECT_FLOAT_EQ(5.f, r[3]);  // last valid value
+}
+
+TEST(MeshAggregate, resets_at_period_boundary)
+{
+    ptime t(boost::gregorian::date(2020, 1, 31), hours(22));
+    mesh_aggregate agg(2, mesh_aggregate::period::day, {"a", "b"},
+                       {mesh_aggregate::stat::sum, mesh_aggregate::stat::max});
+
+    agg.add(values(1, 1, 100, 100), t);
+    agg.add(values(1, 1, 100, 100), t + hours(1));
+    EXPECT_EQ(2u, agg.count());
+
+    // adding into the next day without calling result() discards the open window
+    agg.add(values(5, 6, 7, 8), t + hours(2));
+    EXPECT_EQ(1u, agg.count());
+    EXPECT_EQ(ptime(boost::gregorian::date(2020, 2, 1)), agg.start());
+
+    auto r = agg.result();
+    EXPECT_FLOAT_EQ(5.f, r[0]);
+    EXPECT_FLOAT_EQ(6.f, r[1]);
+    EXPECT_FLOAT_EQ(7.f, r[2]);
+    EXPECT_FLOAT_EQ(8.f, r[3]);
+
+    // result() starts an empty window
+    EXPECT_EQ(0u, agg.count());
+    r = agg.result();
+    for (auto v : r)
+        EXPECT_FLOAT_EQ(-9999.f, v);
+}
+
+TEST(MeshAggregate, monthly_windows)
+{
+    mesh_aggregate agg(1, mesh_aggregate::period::month, {"a"}, {mesh_aggregate::stat::mean});
+
+    ptime t(boost::gregorian::date(2020, 2, 1));
+    for (int d = 0; d < 29; d++)
+    {
+        ptime now = t + boost::gregorian::days(d);
+        ASSERT_FALSE(agg.count() > 0 && agg.closed_by(now));
+        agg.add(std::vector<double>{double(d)}, now);
+    }
+    EXPECT_EQ(29u, agg.count());
+    EXPECT_TRUE(agg.closed_by(ptime(boost::gregorian::date(2020, 3, 1))));
+
+    auto r = agg.result();
+    EXPECT_FLOAT_EQ(14.f, r[0]);
+}
+
+TEST(MeshAggregate, parses_names)
+{
+    EXPECT_EQ(mesh_aggregate::period::day, mesh_aggregate::to_period("daily"));
+    EXPECT_EQ(mesh_aggregate::period::month, mesh_aggregate::to_period("month"));
+    EXPECT_EQ(mesh_aggregate::stat::max, mesh_aggregate::to_stat("max"));
+    EXPECT_ANY_THROW(mesh_aggregate::to_period("weekly"));
+    EXPECT_ANY_THROW(mesh_aggregate::to_stat("median"));
+
+    mesh_aggregate agg(2, mesh_aggregate::period::day, {"a", "b"}, {});
+    EXPECT_ANY_THROW(agg.add(std::vector<double>{1, 2, 3}, ptime(boost::gregorian::date(2020, 1, 1))));
+}
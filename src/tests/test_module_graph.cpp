@@ -0,0 +1,128 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "module_graph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// 0 data, 1 domain after 0, 2 data after 0, 3 data after 1, 4 domain on its own
+TEST(ModuleGraph, fuses_data_modules)
+{
+    module_graph g;
+    std::vector<size_t> order;
+    std::mutex m;
+
+    g.build({true, false, true, true, false}, {{}, {0}, {0}, {1}, {}},
+            [&](size_t n)
+            {
+                std::lock_guard<std::mutex> lock(m);
+                for (auto i : g.nodes()[n].items)
+                    order.push_back(i);
+            });
+
+    // 2 joins 0's sweep, 3 can't as it has to wait for 1
+    ASSERT_EQ(4u, g.nodes().size());
+    EXPECT_EQ(std::vector<size_t>({0, 2}), g.nodes()[0].items);
+    EXPECT_EQ(std::vector<size_t>({1}), g.nodes()[1].items);
+    EXPECT_EQ(std::vector<size_t>({3}), g.nodes()[2].items);
+    EXPECT_EQ(std::vector<size_t>({4}), g.nodes()[3].items);
+
+    // the graph is reused every timestep
+    for (int ts = 0; ts < 3; ts++)
+    {
+        order.clear();
+        g.run();
+
+        auto pos = [&](size_t i) { return std::find(order.begin(), order.end(), i) - order.begin(); };
+        ASSERT_EQ(5u, order.size());
+        EXPECT_LT(pos(0), pos(1));
+        EXPECT_LT(pos(0), pos(2));
+        EXPECT_LT(pos(1), pos(3));
+    }
+}
+
+TEST(ModuleGraph, rethrows_and_skips_dependents)
+{
+    module_graph g;
+    std::atomic<int> ran(0);
+
+    g.build({false, false}, {{}, {0}},
+            [&](size_t n)
+            {
+                ran++;
+                if (n == 0)
+                    throw std::runtime_error("module failed");
+            });
+
+    EXPECT_THROW(g.run(), std::runtime_error);
+    EXPECT_EQ(1, ran.load());
+}
+
+// 0 domain, 1 domain that declares nothing, 2 domain on its own. 1 must stay between 0 and 2.
+TEST(ModuleGraph, keep_order)
+{
+    module_graph g;
+    std::vector<size_t> order;
+    std::mutex m;
+
+    g.build({false, false, false}, {{}, {}, {}},
+            [&](size_t n)
+            {
+                std::lock_guard<std::mutex> lock(m);
+                for (auto i : g.nodes()[n].items)
+                    order.push_back(i);
+            },
+            {false, true, false});
+
+    ASSERT_EQ(3u, g.nodes().size());
+    EXPECT_EQ(std::vector<size_t>({0}), g.nodes()[1].deps);
+    EXPECT_EQ(std::vector<size_t>({1}), g.nodes()[2].deps);
+
+    g.run();
+    EXPECT_EQ(std::vector<size_t>({0, 1, 2}), order);
+}
+
+TEST(ModuleGraph, rebuild)
+{
+    module_graph g;
+    std::atomic<int> ran(0);
+    auto body = [&](size_t) { ran++; };
+
+    g.build({false, false}, {{}, {0}}, body);
+    g.run();
+    EXPECT_EQ(2, ran.load());
+
+    // the old tasks must be gone, not run alongside the new ones
+    ran = 0;
+    g.build({true, true, false}, {{}, {0}, {1}}, body);
+    ASSERT_EQ(2u, g.nodes().size());
+    g.run();
+    EXPECT_EQ(2, ran.load());
+}
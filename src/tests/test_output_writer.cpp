@@ -0,0 +1,94 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "output_writer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(OutputWriter, runs_jobs_in_order)
+{
+    output_writer w(2);
+    std::vector<int> done;
+
+    for (int i = 0; i < 20; i++)
+        w.submit([&done, i] { done.push_back(i); });
+    w.wait();
+
+    ASSERT_EQ(20u, done.size());
+    for (int i = 0; i < 20; i++)
+        EXPECT_EQ(i, done[i]);
+}
+
+TEST(OutputWriter, blocks_only_when_full)
+{
+    output_writer w(1);
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    std::atomic<int> count(0);
+
+    w.submit([&] {
+        started = true;
+        while (!release)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++count;
+    });
+    while (!started)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // the writer is busy but the queue has room
+    w.submit([&count] { ++count; });
+    EXPECT_EQ(0u, w.stalls());
+
+    // the queue is now full, so this has to wait for the writer
+    std::thread t([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release = true;
+    });
+    w.submit([&count] { ++count; });
+    t.join();
+    w.wait();
+
+    EXPECT_EQ(3, count);
+    EXPECT_EQ(1u, w.stalls());
+}
+
+TEST(OutputWriter, rethrows_job_errors)
+{
+    output_writer w;
+    w.submit([] { throw std::runtime_error("disk full"); });
+    EXPECT_THROW(w.wait(), std::runtime_error);
+
+    // and carries on afterwards
+    bool ran = false;
+    w.submit([&ran] { ran = true; });
+    w.wait();
+    EXPECT_TRUE(ran);
+}
@@ -0,0 +1,96 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "timeseries/point_output.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::string read_file(const std::string& file)
+    {
+        std::ifstream in(file.c_str());
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+}
+
+TEST(PointOutput, writes_blocks_in_order)
+{
+    const std::string file = "test_point_output.csv";
+    {
+        point_output out(file, {"swe", "t"}, 2);
+        boost::posix_time::ptime t(boost::gregorian::date(2020, 1, 1));
+
+        double row[2];
+        for (int k = 0; k < 5; k++)
+        {
+            row[0] = k * 0.5;
+            row[1] = -1.0 / 3.0;
+            out.append(t + boost::posix_time::hours(k), row);
+            if (out.full())
+                out.write(*out.take());
+        }
+        EXPECT_EQ(1u, out.pending());
+        out.write(*out.take());
+        EXPECT_EQ(0u, out.pending());
+    }
+
+    std::string expected = "datetime,swe,t\n"
+                           "20200101T000000,0,-0.333333\n"
+                           "20200101T010000,0.5,-0.333333\n"
+                           "20200101T020000,1,-0.333333\n"
+                           "20200101T030000,1.5,-0.333333\n"
+                           "20200101T040000,2,-0.333333\n";
+    EXPECT_EQ(expected, read_file(file));
+    std::remove(file.c_str());
+}
+
+TEST(PointOutput, matches_ostream_formatting)
+{
+    const std::string file = "test_point_output_fmt.csv";
+    const double values[] = {-9999, 1e-7, 123456789.0, 0.1 + 0.2, -0.0};
+    {
+        point_output out(file, {"a", "b", "c", "d", "e"});
+        boost::posix_time::ptime t(boost::gregorian::date(2020, 1, 1));
+        out.append(t, values);
+        out.write(*out.take());
+    }
+
+    std::stringstream ss;
+    ss << "datetime,a,b,c,d,e\n20200101T000000";
+    for (double v : values)
+        ss << "," << v;
+    ss << "\n";
+
+    EXPECT_EQ(ss.str(), read_file(file));
+    std::remove(file.c_str());
+}
@@ -0,0 +1,119 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+#include "math/precond_refresh.hpp"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // Number of rebuilds over a sequence of solves, following the same build -> solve -> solved() cycle as PBSM3D
+    size_t count_rebuilds(precond_refresh& r, const std::vector<size_t>& iters, size_t max_iters)
+    {
+        size_t builds = 0;
+        for (auto it : iters)
+        {
+            if (r.stale())
+            {
+                r.rebuilt();
+                builds++;
+            }
+            r.solved(it, max_iters);
+        }
+        return builds;
+    }
+}
+
+TEST(PrecondRefresh, stale_until_built)
+{
+    precond_refresh r;
+    EXPECT_TRUE(r.stale());
+    r.rebuilt();
+    EXPECT_FALSE(r.stale());
+    EXPECT_EQ(0u, r.reference_iters());
+}
+
+TEST(PrecondRefresh, first_solve_sets_reference)
+{
+    precond_refresh r(2.0);
+    r.rebuilt();
+    r.solved(10, 500);
+    EXPECT_EQ(10u, r.reference_iters());
+    EXPECT_FALSE(r.stale());
+
+    r.solved(20, 500); // not more than twice
+    EXPECT_FALSE(r.stale());
+
+    r.solved(21, 500);
+    EXPECT_TRUE(r.stale());
+
+    r.rebuilt();
+    EXPECT_FALSE(r.stale());
+    EXPECT_EQ(0u, r.reference_iters());
+}
+
+TEST(PrecondRefresh, stale_when_not_converged)
+{
+    precond_refresh r(100.0);
+    r.rebuilt();
+    r.solved(500, 500);
+    EXPECT_TRUE(r.stale());
+}
+
+TEST(PrecondRefresh, zero_iterations_keep_reference_unknown)
+{
+    // a warm start that already satisfies the tolerance doesn't solve at all
+    precond_refresh r(2.0);
+    r.rebuilt();
+    r.solved(0, 500);
+    EXPECT_EQ(0u, r.reference_iters());
+    EXPECT_FALSE(r.stale());
+}
+
+TEST(PrecondRefresh, ratio_zero_rebuilds_every_step)
+{
+    std::vector<size_t> iters = {10, 10, 10, 10, 10, 10};
+
+    precond_refresh never(0.0);
+    EXPECT_EQ(iters.size(), count_rebuilds(never, iters, 500));
+
+    precond_refresh negative(-1.0);
+    EXPECT_EQ(iters.size(), count_rebuilds(negative, iters, 500));
+
+    precond_refresh keep(2.0);
+    EXPECT_EQ(1u, count_rebuilds(keep, iters, 500));
+}
+
+TEST(PrecondRefresh, reset_forces_rebuild)
+{
+    precond_refresh r(2.0);
+    EXPECT_EQ(2u, count_rebuilds(r, {10, 12, 30, 12}, 500));
+
+    r.reset();
+    EXPECT_TRUE(r.stale());
+    EXPECT_EQ(0u, r.reference_iters());
+}
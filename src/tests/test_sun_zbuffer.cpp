@@ -0,0 +1,352 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+
+
+#include "math/sun_zbuffer.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    const double deg = M_PI / 180.0;
+
+    // a grid of nx by ny cells of size h from (x0, y0), two triangles per cell with random windings, z = height(x, y)
+    struct terrain
+    {
+        std::vector<double> xyz;
+        std::vector<uint32_t> faces;
+
+        terrain(size_t nx, size_t ny, double h, double x0, double y0, std::function<double(double, double)> height)
+        {
+            srand(42);
+            for (size_t r = 0; r <= ny; r++)
+            {
+                for (size_t c = 0; c <= nx; c++)
+                {
+                    double x = c * h;
+                    double y = r * h;
+                    xyz.push_back(x0 + x);
+                    xyz.push_back(y0 + y);
+                    xyz.push_back(height(x, y));
+                }
+            }
+
+            auto vid = [&](size_t c, size_t r) { return static_cast<uint32_t>(r * (nx + 1) + c); };
+            for (size_t r = 0; r < ny; r++)
+            {
+                for (size_t c = 0; c < nx; c++)
+                {
+                    add_face(vid(c, r), vid(c + 1, r), vid(c + 1, r + 1));
+                    add_face(vid(c, r), vid(c + 1, r + 1), vid(c, r + 1));
+                }
+            }
+        }
+
+        void add_face(uint32_t a, uint32_t b, uint32_t c)
+        {
+            if (rand() % 2)
+                std::swap(b, c);
+            faces.push_back(a);
+            faces.push_back(b);
+            faces.push_back(c);
+        }
+
+        size_t size_faces() const
+        {
+            return faces.size() / 3;
+        }
+
+        const double* vertex(size_t face, int v) const
+        {
+            return &xyz[faces[face * 3 + v] * 3];
+        }
+
+        double center(size_t face, int d) const
+        {
+            return (vertex(face, 0)[d] + vertex(face, 1)[d] + vertex(face, 2)[d]) / 3.0;
+        }
+
+        // face whose center is nearest (x, y)
+        size_t face_at(double x, double y) const
+        {
+            size_t best = 0;
+            double dbest = HUGE_VAL;
+            for (size_t i = 0; i < size_faces(); i++)
+            {
+                double d = std::pow(center(i, 0) - x, 2) + std::pow(center(i, 1) - y, 2);
+                if (d < dbest)
+                {
+                    dbest = d;
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        // unit vector towards the sun
+        static void sun_dir(double az, double el, double* d)
+        {
+            d[0] = std::cos(el * deg) * std::sin(az * deg);
+            d[1] = std::cos(el * deg) * std::cos(az * deg);
+            d[2] = std::sin(el * deg);
+        }
+
+        // cosine of the angle between the (upward) face normal and the sun
+        double incidence(size_t face, double az, double el) const
+        {
+            const double* a = vertex(face, 0);
+            const double* b = vertex(face, 1);
+            const double* c = vertex(face, 2);
+            double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+            if (n[2] < 0)
+                for (auto& x : n)
+                    x = -x;
+            double d[3];
+            sun_dir(az, el, d);
+            return (n[0] * d[0] + n[1] * d[1] + n[2] * d[2]) / std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        }
+
+        // exact answer: does the ray from the face's center towards the sun hit any other face
+        bool ray_blocked(size_t face, double az, double el) const
+        {
+            double o[3] = {center(face, 0), center(face, 1), center(face, 2)};
+            double d[3];
+            sun_dir(az, el, d);
+
+            for (size_t i = 0; i < size_faces(); i++)
+            {
+                if (i == face)
+                    continue;
+
+                // Moller-Trumbore
+                const double* a = vertex(i, 0);
+                const double* b = vertex(i, 1);
+                const double* c = vertex(i, 2);
+                double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                double p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+                double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+                if (std::fabs(det) < 1e-12)
+                    continue;
+                double s[3] = {o[0] - a[0], o[1] - a[1], o[2] - a[2]};
+                double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+                if (u < 0 || u > 1)
+                    continue;
+                double q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+                double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+                if (v < 0 || u + v > 1)
+                    continue;
+                double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+                if (t > 1e-6)
+                    return true;
+            }
+            return false;
+        }
+    };
+
+    // the same sun everywhere
+    void run(sun_zbuffer& zb, const terrain& t, double az, double el)
+    {
+        std::vector<double> sun;
+        for (size_t i = 0; i < t.xyz.size() / 3; i++)
+        {
+            sun.push_back(az);
+            sun.push_back(el);
+        }
+        zb.run(t.xyz, sun, t.faces, std::vector<double>(t.size_faces(), el));
+    }
+
+    // 200 m x 100 m, with a 30 m high ridge running north-south at x = 100
+    double ridge(double x, double)
+    {
+        return 30 * std::exp(-std::pow((x - 100) / 15, 2));
+    }
+}
+
+TEST(SunZbuffer, ridge_shadow)
+{
+    terrain t(40, 20, 5, 0, 0, ridge);
+    sun_zbuffer zb;
+
+    // low sun in the east
+    run(zb, t, 90, 20);
+
+    // 50 m west of the crest the ray only climbs 18 m by the crest
+    EXPECT_TRUE(zb.shadowed(t.face_at(50, 50)));
+    EXPECT_FALSE(zb.facing_away(t.face_at(50, 50)));
+    EXPECT_TRUE(t.ray_blocked(t.face_at(50, 50), 90, 20));
+
+    // 95 m west, it clears it
+    EXPECT_FALSE(zb.shadowed(t.face_at(5, 50)));
+
+    // facing the sun
+    EXPECT_FALSE(zb.shadowed(t.face_at(120, 50)));
+    EXPECT_FALSE(zb.shadowed(t.face_at(180, 50)));
+
+    // the sun in the west instead
+    run(zb, t, 270, 20);
+    EXPECT_FALSE(zb.shadowed(t.face_at(50, 50)));
+    EXPECT_TRUE(zb.shadowed(t.face_at(150, 50)));
+}
+
+TEST(SunZbuffer, facing_away)
+{
+    terrain t(40, 20, 5, 0, 0, ridge);
+    sun_zbuffer zb;
+
+    for (double az : {90.0, 270.0, 30.0})
+    {
+        run(zb, t, az, 20);
+
+        // the flanks of the ridge away from the sun are steeper than the sun is high
+        size_t away = 0;
+        for (size_t i = 0; i < t.size_faces(); i++)
+        {
+            double cos_i = t.incidence(i, az, 20);
+            if (std::fabs(cos_i) < 1e-9)
+                continue;
+
+            EXPECT_EQ(cos_i < 0, zb.facing_away(i)) << "face " << i << " az " << az;
+            if (cos_i < 0)
+            {
+                EXPECT_TRUE(zb.shadowed(i));
+                away++;
+            }
+        }
+        EXPECT_GT(away, 0u);
+    }
+}
+
+TEST(SunZbuffer, flat_plane_not_self_shadowed)
+{
+    // also far from the origin, as UTM coordinates are
+    for (double offset : {0.0, 1.0})
+    {
+        terrain flat(40, 40, 5, offset * 5e5, offset * 5e6, [](double, double) { return 1000.0; });
+        terrain tilted(40, 40, 5, offset * 5e5, offset * 5e6, [](double x, double y) { return 1000 + 0.05 * x + 0.02 * y; });
+
+        for (const terrain* t : {&flat, &tilted})
+        {
+            for (double raster_size : {0.0, 0.25})
+            {
+                for (double az : {0.0, 45.0, 135.0, 260.0})
+                {
+                    for (double el : {8.0, 20.0, 60.0, 89.0})
+                    {
+                        sun_zbuffer zb;
+                        zb.raster_size = raster_size;
+                        run(zb, *t, az, el);
+
+                        size_t shadowed = 0;
+                        for (size_t i = 0; i < t->size_faces(); i++)
+                            shadowed += zb.shadowed(i);
+                        EXPECT_EQ(0u, shadowed) << "offset " << offset << " raster " << raster_size << " az " << az
+                                                << " el " << el;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(SunZbuffer, utm_precision)
+{
+    // with cells this small the bias is below a float's resolution of z' at 5e6 m, unless z' is kept local
+    terrain t(10, 10, 1, 5e5, 5e6, [](double, double) { return 1000.0; });
+
+    for (double az : {0.0, 30.0, 180.0})
+    {
+        for (double el : {30.0, 45.0, 60.0})
+        {
+            sun_zbuffer zb;
+            zb.raster_size = 0.01;
+            run(zb, t, az, el);
+
+            size_t shadowed = 0;
+            for (size_t i = 0; i < t.size_faces(); i++)
+                shadowed += zb.shadowed(i);
+            EXPECT_EQ(0u, shadowed) << "az " << az << " el " << el;
+        }
+    }
+}
+
+TEST(SunZbuffer, below_cutoff)
+{
+    terrain t(40, 20, 5, 0, 0, ridge);
+    sun_zbuffer zb;
+    run(zb, t, 90, 4);
+
+    for (size_t i = 0; i < t.size_faces(); i++)
+    {
+        EXPECT_FALSE(zb.shadowed(i));
+        EXPECT_EQ(0, zb.z_prime(i));
+    }
+}
+
+TEST(SunZbuffer, bands)
+{
+    // small cells, so the 5 m faces span several bands of rows
+    terrain t(40, 20, 5, 5e5, 5e6, ridge);
+    sun_zbuffer one;
+    one.raster_size = 0.5;
+    one.band_rows = 1 << 30;
+    run(one, t, 120, 25);
+    ASSERT_EQ(1u, (one.rows() + one.band_rows - 1) / one.band_rows);
+
+    // how the rows are split mustn't change anything
+    for (size_t band_rows : {1, 3, 16})
+    {
+        sun_zbuffer zb;
+        zb.raster_size = 0.5;
+        zb.band_rows = band_rows;
+        run(zb, t, 120, 25);
+        ASSERT_GT(zb.rows(), 4 * band_rows);
+
+        for (size_t i = 0; i < t.size_faces(); i++)
+        {
+            EXPECT_EQ(one.shadowed(i), zb.shadowed(i)) << "face " << i << " band_rows " << band_rows;
+            EXPECT_EQ(one.z_prime(i), zb.z_prime(i));
+        }
+    }
+
+    // and it agrees with casting rays, but for a few faces the shadow's edge crosses
+    size_t agree = 0;
+    size_t shadowed = 0;
+    for (size_t i = 0; i < t.size_faces(); i++)
+    {
+        bool exact = one.facing_away(i) || t.ray_blocked(i, 120, 25);
+        agree += exact == one.shadowed(i);
+        shadowed += exact;
+    }
+    EXPECT_GT(shadowed, t.size_faces() / 10);
+    EXPECT_GE(agree, t.size_faces() * 97 / 100);
+}
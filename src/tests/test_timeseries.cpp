@@ -292,4 +292,36 @@ TEST_F(TimeseriesTest, ToFile)
 TEST_F(TimeseriesTest, MissingTimeStep)
 {
     ASSERT_ANY_THROW(s0.open("missing_timestep.txt"));
-}
\ No newline at end of file
+}
+TEST_F(TimeseriesTest, ParseNumberFormats)
+{
+    std::ofstream out("test_number_formats.txt");
+    out << "datetime,a,b,c\n";
+    out << "20100101T000000,.5,5.,-1e3\n";
+    out << "20100101T010000,+2,1.25E-2,0\n";
+    out.close();
+
+    ASSERT_NO_THROW(s0.open("test_number_formats.txt"));
+
+    auto a = s0.get_time_series("a");
+    auto b = s0.get_time_series("b");
+    auto c = s0.get_time_series("c");
+
+    EXPECT_DOUBLE_EQ(0.5, a[0]);
+    EXPECT_DOUBLE_EQ(2, a[1]);
+    EXPECT_DOUBLE_EQ(5, b[0]);
+    EXPECT_DOUBLE_EQ(0.0125, b[1]);
+    EXPECT_DOUBLE_EQ(-1000, c[0]);
+    EXPECT_DOUBLE_EQ(0, c[1]);
+}
+
+TEST_F(TimeseriesTest, ParseBadValue)
+{
+    std::ofstream out("test_bad_value.txt");
+    out << "datetime,a\n";
+    out << "20100101T000000,1.0\n";
+    out << "20100101T010000,1.0x\n";
+    out.close();
+
+    ASSERT_THROW(s0.open("test_bad_value.txt"), forcing_no_regexmatch);
+}
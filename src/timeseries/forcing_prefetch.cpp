@@ -0,0 +1,153 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "forcing_prefetch.hpp"
+
+#include <algorithm>
+
+forcing_prefetch::forcing_prefetch()
+    : _nc(nullptr), _first(0), _count(0), _stop(false)
+{
+
+}
+
+forcing_prefetch::~forcing_prefetch()
+{
+    stop();
+}
+
+void forcing_prefetch::start(netcdf& nc, const std::vector<std::string>& variables, size_t first, size_t count, size_t depth)
+{
+    stop();
+
+    _nc = &nc;
+    _variables = variables;
+    _first = first;
+    _count = count;
+    _stop = false;
+    _error = nullptr;
+
+    depth = std::max<size_t>(depth, 1);
+    size_t grid = nc.get_xsize() * nc.get_ysize();
+
+    _ring.resize(depth);
+    for (auto& sl : _ring)
+    {
+        sl.timestep = 0;
+        sl.ready = false;
+        sl.data.assign(_variables.size(), std::vector<double>(grid));
+    }
+
+    _thread = std::thread(&forcing_prefetch::_read_loop, this);
+}
+
+void forcing_prefetch::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void forcing_prefetch::wait(size_t timestep)
+{
+    if (timestep < _first || timestep >= _first + _count)
+        BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Forcing timestep " + std::to_string(timestep) + " is outside the prefetched range"));
+
+    auto& sl = _ring[(timestep - _first) % _ring.size()];
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [&] { return _error || (sl.ready && sl.timestep == timestep); });
+
+    if (_error)
+        std::rethrow_exception(_error);
+}
+
+const double* forcing_prefetch::get(size_t timestep, size_t var) const
+{
+    return _ring[(timestep - _first) % _ring.size()].data[var].data();
+}
+
+void forcing_prefetch::release(size_t timestep)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _ring[(timestep - _first) % _ring.size()].ready = false;
+    }
+    _cv.notify_all();
+}
+
+const std::vector<std::string>& forcing_prefetch::variables() const
+{
+    return _variables;
+}
+
+void forcing_prefetch::_read_loop()
+{
+    try
+    {
+        for (size_t i = 0; i < _count; i++)
+        {
+            size_t timestep = _first + i;
+            auto& sl = _ring[i % _ring.size()];
+
+            // wait for the consumer to be done with whatever is in this slot
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [&] { return _stop || !sl.ready; });
+
+                if (_stop)
+                    return;
+            }
+
+            // the slot is ours until it is marked ready, so read without holding _mutex
+            {
+                std::lock_guard<std::mutex> lock(netcdf::lib_mutex());
+                for (size_t v = 0; v < _variables.size(); v++)
+                {
+                    _nc->get_var(_variables[v], timestep, sl.data[v].data());
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                sl.timestep = timestep;
+                sl.ready = true;
+            }
+            _cv.notify_all();
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+        _cv.notify_all();
+    }
+}
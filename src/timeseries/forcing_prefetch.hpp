@@ -0,0 +1,115 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "netcdf.hpp"
+
+/**
+ * \class forcing_prefetch
+ * \brief Ring buffer of NetCDF forcing timesteps, filled by a background thread
+ *
+ * Holds depth timesteps of every forcing variable for the whole grid. While the model computes timestep t, the
+ * background thread reads t+1 ... t+depth-1 so that the forcing I/O overlaps with the computation. The consumer calls
+ * get() to obtain timestep t (blocking only if it hasn't been read yet) and release() once done with it, which frees
+ * the slot for the next read.
+ *
+ * Timesteps must be consumed in order. Only the background thread reads from the netcdf file once start() has been called.
+ */
+class forcing_prefetch
+{
+public:
+    forcing_prefetch();
+    ~forcing_prefetch();
+
+    forcing_prefetch(const forcing_prefetch&) = delete;
+    forcing_prefetch& operator=(const forcing_prefetch&) = delete;
+
+    /**
+     * Starts the background thread
+     * @param nc Open netcdf file. Must outlive this object
+     * @param variables Variables to read for each timestep
+     * @param first First timestep (index into the netcdf file) to read
+     * @param count Number of timesteps to read
+     * @param depth Number of timesteps held in memory. >= 2 for any overlap.
+     */
+    void start(netcdf& nc, const std::vector<std::string>& variables, size_t first, size_t count, size_t depth);
+
+    /**
+     * Stops and joins the background thread. Called by the dtor.
+     */
+    void stop();
+
+    /**
+     * Blocks until the given timestep has been read. Rethrows any exception from the background thread.
+     * @param timestep Index into the netcdf file
+     */
+    void wait(size_t timestep);
+
+    /**
+     * Grid of values for one variable of a timestep previously wait()ed for. Valid until release(timestep).
+     * @param timestep Index into the netcdf file
+     * @param var Index into the variables given to start()
+     * @return ysize*xsize values, indexed as x + y*xsize
+     */
+    const double* get(size_t timestep, size_t var) const;
+
+    /**
+     * Finished with the timestep, the slot can be reused for a future read
+     * @param timestep
+     */
+    void release(size_t timestep);
+
+    const std::vector<std::string>& variables() const;
+
+private:
+    struct slot
+    {
+        size_t timestep;
+        bool ready;
+        std::vector< std::vector<double> > data; // [variable][grid]
+    };
+
+    void _read_loop();
+
+    netcdf* _nc;
+    std::vector<std::string> _variables;
+    size_t _first;
+    size_t _count;
+
+    std::vector<slot> _ring;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop;
+    std::exception_ptr _error;
+};
@@ -25,9 +25,12 @@
 
 #include "netcdf.hpp"
 
+#include <algorithm>
+
 netcdf::netcdf()
 {
     _is_open = false;
+    _staging = false;
 }
 netcdf::~netcdf()
 {
@@ -40,27 +43,138 @@ netcdf::~netcdf()
  }
 void netcdf::create_variable1D( const std::string& var, size_t length)
 {
-    //only create the dim and variables once
-    try
+    if(_staging)
     {
-        add_dim1D("tri_id",length);
+        _staged[var].dim.clear();
+        _staged[var].values.assign(length, -9999.0);
+        return;
+    }
+
+    _get_or_create_variable1D(var, length);
+}
 
+void netcdf::create_ragged1D(const std::string& var, const std::string& dim, size_t length)
+{
+    if(_staging)
+    {
+        _staged[var].dim = dim;
+        _staged[var].values.assign(length, -9999.0);
+        return;
     }
-    catch(netCDF::exceptions::NcNameInUse& e)
+
+    _get_or_create_variable1D(var, length, dim);
+}
+
+netCDF::NcVar netcdf::_get_or_create_variable1D(const std::string& var, size_t length, const std::string& dim)
+{
+    auto nc_var = _data.getVar(var);
+    if(!nc_var.isNull())
+        return nc_var;
+
+    if(dim.empty())
     {
+        //only create the dim and variables once
+        try
+        {
+            add_dim1D("tri_id",length);
+
+        }
+        catch(netCDF::exceptions::NcNameInUse& e)
+        {
 
+        }
+
+        nc_var = _data.addVar(var.c_str(), netCDF::ncDouble, _dimVector);
+    }
+    else
+    {
+        auto nc_dim = _data.getDim(dim);
+        if(nc_dim.isNull())
+            nc_dim = _data.addDim(dim); // unlimited
+
+        nc_var = _data.addVar(var.c_str(), netCDF::ncDouble, nc_dim);
     }
 
+    // only possible on netCDF-4 files, which is what create() makes
     try
     {
-        auto nc_var = _data.addVar(var.c_str(), netCDF::ncDouble, _dimVector);
+        std::vector<size_t> chunk(1, std::max<size_t>(1, std::min<size_t>(length, 65536)));
+        nc_var.setChunking(netCDF::NcVar::nc_CHUNKED, chunk);
+        nc_var.setCompression(true, true, 1);
     }
-    catch(netCDF::exceptions::NcNameInUse& e)
+    catch(netCDF::exceptions::NcException& e)
     {
+        LOG_DEBUG << "Unable to compress " << var << ": " << e.what();
+    }
 
+    return nc_var;
+}
+
+void netcdf::put_var1D(const std::string& var, const double* values, size_t n)
+{
+    if(_staging)
+    {
+        auto itr = _staged.find(var);
+        if(itr == _staged.end() || itr->second.values.size() != n)
+            BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not initialized: " + var));
+
+        std::copy(values, values + n, itr->second.values.begin());
+        return;
     }
 
+    auto nc_var = _data.getVar(var);
+    if(nc_var.isNull())
+        BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not initialized: " + var));
+
+    if(n == 0)
+        return;
+
+    std::vector<size_t> startp(1, 0), countp(1, n);
+    nc_var.putVar(startp, countp, values);
+}
+
+void netcdf::get_var1D(const std::string& var, double* out, size_t n)
+{
+    auto nc_var = _data.getVar(var);
+    if(nc_var.isNull())
+        BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not found: " + var));
+
+    // ragged variables are on an unlimited dim that may hold stale values past n from an earlier, longer checkpoint
+    bool ok = nc_var.getDimCount() == 1 &&
+              (nc_var.getDim(0).isUnlimited() ? nc_var.getDim(0).getSize() >= n : nc_var.getDim(0).getSize() == n);
+    if(!ok)
+        BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable " + var + " is not a 1D variable of length " + std::to_string(n)));
 
+    if(n == 0)
+        return;
+
+    std::vector<size_t> startp(1, 0), countp(1, n);
+    nc_var.getVar(startp, countp, out);
+}
+
+void netcdf::begin_staging()
+{
+    _staged.clear();
+    _staging = true;
+}
+
+void netcdf::write_staged()
+{
+    _staging = false;
+
+    for(auto& itr : _staged)
+    {
+        std::lock_guard<std::mutex> lock(lib_mutex());
+
+        auto nc_var = _get_or_create_variable1D(itr.first, itr.second.values.size(), itr.second.dim);
+        if(itr.second.values.empty())
+            continue;
+
+        std::vector<size_t> startp(1, 0), countp(1, itr.second.values.size());
+        nc_var.putVar(startp, countp, itr.second.values.data());
+    }
+
+    _staged.clear();
 }
 
 netCDF::NcFile& netcdf::get_ncfile()
@@ -70,9 +184,15 @@ netCDF::NcFile& netcdf::get_ncfile()
 
 void netcdf::put_var1D(const std::string& var, size_t index, double value)
 {
-    auto vars = _data.getVars();
+    if(_staging)
+    {
+        auto itr = _staged.find(var);
+        if(itr == _staged.end() || index >= itr->second.values.size())
+            BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not initialized: " + var));
 
-    auto itr = vars.find(var);
+        itr->second.values[index] = value;
+        return;
+    }
 
     std::vector<size_t> startp,countp;
     startp.push_back(index);
@@ -80,7 +200,12 @@ void netcdf::put_var1D(const std::string& var, size_t index, double value)
 
     try
     {
-        itr->second.putVar(startp,countp,&value);
+        // getVar(name) rather than getVars(), which copies the whole variable map
+        auto nc_var = _data.getVar(var);
+        if(nc_var.isNull())
+            BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not initialized: " + var));
+
+        nc_var.putVar(startp,countp,&value);
     }
     catch(netCDF::exceptions::NcBadId& e)
     {
@@ -287,11 +412,12 @@ double netcdf::get_var1D(std::string var, size_t index)
     countp.push_back(1);
 
 
-    auto vars = _data.getVars();
+    auto nc_var = _data.getVar(var);
+    if(nc_var.isNull())
+        BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("Variable not found: " + var));
 
-    auto itr = vars.find(var);
     double data=-9999.0;
-    itr->second.getVar(startp,countp,&data);
+    nc_var.getVar(startp,countp,&data);
 
     return data;
 }
@@ -418,6 +544,20 @@ netcdf::data netcdf::get_var(std::string var, size_t timestep)
      return array;
 }
 
+void netcdf::get_var(const std::string& var, size_t timestep, double* out)
+{
+    std::vector<size_t> startp = {timestep, 0, 0};
+    std::vector<size_t> countp = {1, ygrid, xgrid};
+
+    _data.getVar(var).getVar(startp, countp, out);
+}
+
+std::mutex& netcdf::lib_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
 netcdf::data netcdf::get_var(std::string var, boost::posix_time::ptime timestep)
 {
     auto diff = timestep - _start; // a duration
@@ -27,7 +27,10 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp> // for boost::posix
 #include <netcdf>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "logger.hpp"
 #include "exception.hpp"
@@ -74,9 +77,63 @@ public:
     data get_var(std::string var, boost::posix_time::ptime timestep);
     double get_var(std::string var, size_t timestep, size_t x, size_t y);
 
+    /**
+     * Reads the whole grid for one timestep into out, without allocating.
+     * @param var
+     * @param timestep
+     * @param out Must hold get_ysize()*get_xsize() values. Row major, so out[x + y*xsize]
+     */
+    void get_var(const std::string& var, size_t timestep, double* out);
+
+    /**
+     * The netcdf library is not thread safe. Anything that may call into it while another thread is, e.g., the
+     * forcing prefetch thread, needs to hold this lock.
+     * @return
+     */
+    static std::mutex& lib_mutex();
+
     void add_dim1D(const std::string& var, size_t length);
     void create_variable1D(const std::string& var,  size_t length);
     void put_var1D(const std::string& var, size_t index, double value);
+
+    /**
+     * Writes a whole 1D variable in one call
+     * @param var Variable created with create_variable1D
+     * @param values
+     * @param n Number of values, must be the variable's length
+     */
+    void put_var1D(const std::string& var, const double* values, size_t n);
+
+    /**
+     * Reads a whole 1D variable in one call
+     * @param var
+     * @param out Must hold n values
+     * @param n Number of values, must be the variable's length
+     */
+    void get_var1D(const std::string& var, double* out, size_t n);
+
+    /**
+     * Creates a 1D variable along its own unlimited dimension instead of tri_id. This is for data that doesn't have one
+     * value per triangle, such as the concatenated layers of a ragged array, whose length changes between checkpoints.
+     * Written and read with put_var1D/get_var1D like the per-triangle variables.
+     * @param var
+     * @param dim Name of the dimension, created on first use
+     * @param length Number of values that will be written
+     */
+    void create_ragged1D(const std::string& var, const std::string& dim, size_t length);
+
+    /**
+     * Until write_staged() is called, create_variable1D and put_var1D only copy the data into memory and don't call
+     * into the netcdf library. This allows the modules to hand over their checkpoint data quickly, and have it written
+     * to disk on another thread while the model carries on.
+     */
+    void begin_staging();
+
+    /**
+     * Writes out everything staged since begin_staging(), one bulk write per variable. New variables are created
+     * chunked and compressed. Takes lib_mutex() per variable, so it may be called from a background thread.
+     */
+    void write_staged();
     /**
      * Some data, such as lat/long do not have a time component are only 2 data. This allows loading those data.
      * @param var
@@ -114,4 +171,15 @@ private:
     //if we are creating variables
     std::vector<netCDF::NcDim> _dimVector; //we need this dimension var to create new variables
 
+    // creates the variable, if needed, and returns it. An empty dim means tri_id
+    netCDF::NcVar _get_or_create_variable1D(const std::string& var, size_t length, const std::string& dim = "");
+
+    struct staged_var
+    {
+        std::string dim; // empty for tri_id
+        std::vector<double> values;
+    };
+    bool _staging;
+    std::map<std::string, staged_var> _staged; // 1D variables waiting for write_staged()
+
 };
\ No newline at end of file
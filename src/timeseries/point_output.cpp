@@ -0,0 +1,113 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "point_output.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#include <boost/make_shared.hpp>
+
+#include "exception.hpp"
+
+point_output::point_output(const std::string& file, const std::vector<std::string>& variables, size_t block_rows)
+{
+    _file = file;
+    _variables = variables;
+    _block_rows = std::max<size_t>(1, block_rows);
+    _block = boost::make_shared<block>();
+
+    _out.open(file.c_str());
+    if (!_out.is_open())
+        BOOST_THROW_EXCEPTION(file_write_error()
+                                  << boost::errinfo_errno(errno)
+                                  << boost::errinfo_file_name(file));
+
+    _out << "datetime";
+    for (auto& name : _variables)
+    {
+        _out << "," << name;
+    }
+    _out << std::endl;
+}
+
+void point_output::append(const boost::posix_time::ptime& t, const double* values)
+{
+    if (_block->dates.empty())
+    {
+        _block->dates.reserve(_block_rows);
+        _block->values.reserve(_block_rows * _variables.size());
+    }
+
+    _block->dates.push_back(t);
+    _block->values.insert(_block->values.end(), values, values + _variables.size());
+}
+
+bool point_output::full() const
+{
+    return _block->dates.size() >= _block_rows;
+}
+
+size_t point_output::pending() const
+{
+    return _block->dates.size();
+}
+
+boost::shared_ptr<point_output::block> point_output::take()
+{
+    auto b = _block;
+    _block = boost::make_shared<block>();
+    return b;
+}
+
+void point_output::write(const block& b)
+{
+    _text.clear();
+
+    // %g gives the same text as the default ostream formatting, without the per value stream overhead
+    char buf[32];
+    const size_t nvars = _variables.size();
+    for (size_t k = 0; k < b.dates.size(); k++)
+    {
+        _text += boost::posix_time::to_iso_string(b.dates[k]);
+        for (size_t j = 0; j < nvars; j++)
+        {
+            int n = std::snprintf(buf, sizeof(buf), ",%g", b.values[k * nvars + j]);
+            _text.append(buf, n);
+        }
+        _text += '\n';
+    }
+
+    _out.write(_text.data(), _text.size());
+    _out.flush();
+
+    if (!_out)
+        BOOST_THROW_EXCEPTION(file_write_error() << boost::errinfo_file_name(_file));
+}
+
+const std::vector<std::string>& point_output::variables() const
+{
+    return _variables;
+}
@@ -0,0 +1,103 @@
+//
+// Canadian Hydrological Model - The Canadian Hydrological Model (CHM) is a novel
+// modular unstructured mesh based approach for hydrological modelling
+// Copyright (C) 2018 Christopher Marsh
+//
+// This file is part of Canadian Hydrological Model.
+//
+// Canadian Hydrological Model is free software: you can redistribute it and/or
+// modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Canadian Hydrological Model is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Canadian Hydrological Model.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * \class point_output
+ * \brief Point time series written to disk in blocks of rows as the model runs
+ *
+ * Replaces holding a timeseries of every output variable for the whole run and writing it at the end. Rows are
+ * append()ed to the current block. Once the block is full it is take()n and passed to write(), e.g., on the output
+ * writer thread, which formats it and appends it to the file. So the memory used doesn't depend on the length of the run
+ * and a crash only loses the rows of the unwritten blocks.
+ *
+ * The file is the same csv timeseries::to_file writes: a datetime,var,... header, then one row per timestep.
+ */
+class point_output
+{
+public:
+    struct block
+    {
+        std::vector<boost::posix_time::ptime> dates;
+        std::vector<double> values; // [row][variable]
+    };
+
+    /**
+     * Creates the file and writes the header
+     * @param file
+     * @param variables
+     * @param block_rows Number of rows per block
+     */
+    point_output(const std::string& file, const std::vector<std::string>& variables, size_t block_rows = 1024);
+
+    point_output(const point_output&) = delete;
+    point_output& operator=(const point_output&) = delete;
+
+    /**
+     * Adds a row to the current block
+     * @param t
+     * @param values One per variable
+     */
+    void append(const boost::posix_time::ptime& t, const double* values);
+
+    /**
+     * True once the current block has block_rows rows
+     */
+    bool full() const;
+
+    /**
+     * Number of rows in the current block
+     */
+    size_t pending() const;
+
+    /**
+     * The current block, and starts a new one
+     */
+    boost::shared_ptr<block> take();
+
+    /**
+     * Appends a block to the file. Doesn't touch the current block, so it may run on another thread while rows are being
+     * appended. Calls must be in order and not concurrent with each other.
+     * @param b
+     */
+    void write(const block& b);
+
+    const std::vector<std::string>& variables() const;
+
+private:
+    std::string _file;
+    std::ofstream _out;
+    std::vector<std::string> _variables;
+    size_t _block_rows;
+    boost::shared_ptr<block> _block;
+    std::string _text; // formatting buffer for write()
+};
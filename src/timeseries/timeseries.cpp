@@ -25,10 +25,33 @@
 
 #include "timeseries.hpp"
 
-void timeseries::push_back(double data, std::string variable)
+#include <cstdlib>
+#include <cstring>
+
+void timeseries::_set_columns(const std::vector<std::string>& names, const std::vector<variable_vec>& columns)
 {
-    _variables[variable].push_back(data);
+    _variables.clear();
+    _names = names;
+    _rows = _date_vec.size();
 
+    _data.resize(names.size() * _rows);
+    for (size_t c = 0; c < names.size(); c++)
+    {
+        _variables[names[c]] = c;
+        std::copy(columns[c].begin(), columns[c].end(), _column(c));
+    }
+}
+
+size_t timeseries::_add_column(const std::string& name, double value)
+{
+    size_t c = _names.size();
+    _variables[name] = c;
+    _names.push_back(name);
+
+    //column-major, so a new column is just appended to the end
+    _data.resize(_names.size() * _rows, value);
+
+    return c;
 }
 
 void timeseries::init_new_variable(std::string variable)
@@ -40,20 +63,27 @@ void timeseries::init_new_variable(std::string variable)
                                       << errstr_info("Adding variable to uninitialized timeseries"));
     }
 
-    _variables[variable].assign(size,-9999.0);
+    auto res = _variables.find(variable);
+    if (res != _variables.end())
+        std::fill(_column(res->second), _column(res->second) + _rows, -9999.0);
+    else
+        _add_column(variable, -9999.0);
 }
 
 void timeseries::init(std::set<std::string> variables, date_vec datetime)
 {
-    size_t size = datetime.size();
+   //setup date vector
+   _date_vec = datetime;
+
+   _variables.clear();
+   _names.clear();
+   _data.clear();
+   _rows = _date_vec.size();
 
    for (auto& v: variables)
    {
-       _variables[v].assign(size,-9999.0);
+       _add_column(v, -9999.0);
    }
-
-   //setup date vector
-   _date_vec = datetime;
 }
 
  timeseries::date_vec timeseries::get_date_timeseries()
@@ -62,14 +92,25 @@ void timeseries::init(std::set<std::string> variables, date_vec datetime)
  }
 std::vector<std::string> timeseries::list_variables()
 {
-    std::vector<std::string> vars;
-    for(auto& itr : _variables)
+    return _names;
+}
+
+size_t timeseries::column_index(const std::string& variable) const
+{
+    auto res = _variables.find(variable);
+    if(res == _variables.end())
     {
-        vars.push_back(itr.first);
+        BOOST_THROW_EXCEPTION(forcing_lookup_error()
+                              << errstr_info("Variable " + variable + " does not exist."));
     }
-    
-    return vars;
+    return res->second;
 }
+
+bool timeseries::has(const std::string& variable) const
+{
+    return _variables.find(variable) != _variables.end();
+}
+
 double& timeseries::at(std::string variable, size_t idx)
 {
     auto res = _variables.find(variable);
@@ -78,7 +119,12 @@ double& timeseries::at(std::string variable, size_t idx)
         BOOST_THROW_EXCEPTION(forcing_error()
                               << errstr_info("Unable to find " + variable));
     }
-    return const_cast<double&>(res->second.at(idx));
+    if(idx >= _rows)
+    {
+        BOOST_THROW_EXCEPTION(forcing_error()
+                              << errstr_info("Index " + std::to_string(idx) + " out of range for " + variable));
+    }
+    return _column(res->second)[idx];
 }
 
 timeseries::variable_vec timeseries::get_time_series(std::string variable)
@@ -89,7 +135,7 @@ timeseries::variable_vec timeseries::get_time_series(std::string variable)
         BOOST_THROW_EXCEPTION(forcing_error()
                                 << errstr_info("Unable to find " + variable));
     }   
-    return res->second;
+    return variable_vec(_column(res->second), _column(res->second) + _rows);
 }
 
 void timeseries::subset(boost::posix_time::ptime start,boost::posix_time::ptime end)
@@ -117,23 +163,21 @@ void timeseries::subset(boost::posix_time::ptime start,boost::posix_time::ptime
     }
 
     auto dist_end = std::distance(_date_vec.begin(), itrend);
+    size_t new_rows = dist_end - dist_start;
 
-    //iterate over the map of vectors and build a list of all the variable names
-    //unknown order
-    for (auto& itr : _variables)
+    //each column is contiguous, so pack the [start,end) block of each column to the front of the matrix
+    variable_vec temp(_names.size() * new_rows);
+    for (size_t c = 0; c < _names.size(); c++)
     {
-       auto start_itr = itr.second.begin() + dist_start;
-       auto end_itr = itr.second.begin() + dist_end;
-
-        std::vector<double> temp(start_itr,end_itr);
-        //insert the iterator
-        itr.second = temp;
+        std::copy(_column(c) + dist_start, _column(c) + dist_end, temp.begin() + c * new_rows);
     }
+    _data.swap(temp);
+    _rows = new_rows;
 
     auto start_itr =_date_vec.begin() + dist_start;
     auto end_itr = _date_vec.begin() + dist_end;
-    date_vec temp(start_itr,end_itr);
-    _date_vec = temp;
+    date_vec dtemp(start_itr,end_itr);
+    _date_vec = dtemp;
 
 
 
@@ -152,62 +196,18 @@ boost::tuple<timeseries::iterator, timeseries::iterator> timeseries::range(boost
     //get offset from iterator
     int dist_start = std::distance(_date_vec.begin(), itr_find);
     
-    iterator start_step;
-
-    //iterate over the map of vectors and build a list of all the variable names
-    //unknown order
-    for (auto& itr : _variables)
-    {
-        //itr_map is holding the iterators into each vector
-//        timestep::itr_map::accessor a;
-        //create the keyname for this variable and store the iterator
-
-//        auto res = start_step._currentStep->_itrs.insert(itr.first);
-//        if (!start_step._currentStep->_itrs.insert(a, itr.first))
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_error()
-//                    << errstr_info("Failed to insert " + itr.first)
-//                    );
-//        }
-//
-        start_step._currentStep->_itrs[itr.first]= itr.second.begin()+dist_start;
-        //insert the iterator
-//        res->second =
-    }
+    iterator start_step = begin();
+    start_step._currentStep._row = dist_start;
 
-    //set the date vector to be the begining of the internal data vector
-    start_step._currentStep->_date_itr = _date_vec.begin()+dist_start;
-    
-    
-    
     //ok we can cheat and start from where we currently are instead of two straight calls to find
     itr_find = std::find(_date_vec.begin()+dist_start,_date_vec.end(),end_time);
 
     //get offset from iterator
     int dist_end = std::distance(_date_vec.begin(), itr_find);
     ++dist_end; //get 1 past where we are going
-    iterator end_step;
-
-    //iterate over the map of vectors and build a list of all the variable names
-    //unknown order
-    for (auto& itr : _variables)
-    {
+    iterator end_step = begin();
+    end_step._currentStep._row = dist_end;
 
-//        //create the keyname for this variable and store the iterator
-//        if (!end_step._currentStep->_itrs.insert(itr.first))
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_error()
-//                    << errstr_info("Failed to insert " + itr.first)
-//                    );
-//        }
-//
-        //insert the iterator
-        end_step._currentStep->_itrs[itr.first] = itr.second.begin()+dist_end;
-    }
-
-    //set the date vector to be the begining of the internal data vector
-    end_step._currentStep->_date_itr = _date_vec.begin()+dist_end;
-    
     return boost::tuple<timeseries::iterator, timeseries::iterator>(start_step,end_step);
     
     
@@ -225,37 +225,108 @@ timeseries::iterator timeseries::find(boost::posix_time::ptime time)
     //get offset from iterator
     int dist = std::distance(_date_vec.begin(), itr);
     
-    iterator step;
+    iterator step = begin();
+    step._currentStep._row = dist;
 
-    //iterate over the map of vectors and build a list of all the variable names
-    //unknown order
-    for (auto& itr : _variables)
+    return step;
+}
+
+namespace
+{
+    // same as the old [^,\r\n\s]+ token regex
+    inline bool is_separator(char c)
     {
-//        //create the keyname for this variable and store the iterator
-//        if (!step._currentStep->_itrs.insert(itr.first))
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_insertion_error()
-//                    << errstr_info("Failed to insert " + itr.first)
-//                    );
-//        }
-        
-        //insert the iterator
-        step._currentStep->_itrs[itr.first] = itr.second.begin()+dist;
+        return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
     }
 
-    //set the date vector to be the begining of the internal data vector
-    step._currentStep->_date_itr = _date_vec.begin()+dist;
-    
-    return step;
+    // splits [begin,end) into tokens without allocating
+    void tokenize(const char* begin, const char* end, std::vector< std::pair<const char*, const char*> >& tokens)
+    {
+        tokens.clear();
+        const char* p = begin;
+        while (p < end)
+        {
+            while (p < end && is_separator(*p))
+                ++p;
+
+            const char* tok = p;
+            while (p < end && !is_separator(*p))
+                ++p;
+
+            if (p > tok)
+                tokens.push_back(std::make_pair(tok, p));
+        }
+    }
+
+    // Matches the old ^[-+]?(?:[0-9]+\.?(?:[0-9]*)?|\.[0-9]+)(?:[eE][-+]?[0-9]+)?$ float regex, then converts with strtod
+    bool parse_double(const char* begin, const char* end, double& value)
+    {
+        const char* p = begin;
+        if (p < end && (*p == '+' || *p == '-'))
+            ++p;
+
+        size_t digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') { ++p; ++digits; }
+        if (p < end && *p == '.')
+        {
+            ++p;
+            while (p < end && *p >= '0' && *p <= '9') { ++p; ++digits; }
+        }
+        if (digits == 0)
+            return false;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-'))
+                ++p;
+
+            size_t exp_digits = 0;
+            while (p < end && *p >= '0' && *p <= '9') { ++p; ++exp_digits; }
+            if (exp_digits == 0)
+                return false;
+        }
+
+        if (p != end)
+            return false;
+
+        // the token is always followed by a separator or the end of the buffer, which strtod stops at
+        value = std::strtod(begin, nullptr);
+        return true;
+    }
+
+    inline int digits_to_int(const char* p, size_t n)
+    {
+        int v = 0;
+        for (size_t i = 0; i < n; i++)
+            v = v * 10 + (p[i] - '0');
+        return v;
+    }
+
+    // Fixed format YYYYMMDDThhmmss, same as the old [0-9]{8}T[0-9]{6} regex + from_iso_string
+    bool parse_datetime(const char* begin, const char* end, boost::posix_time::ptime& time)
+    {
+        if (end - begin != 15 || begin[8] != 'T')
+            return false;
+
+        for (int i = 0; i < 15; i++)
+        {
+            if (i != 8 && (begin[i] < '0' || begin[i] > '9'))
+                return false;
+        }
+
+        boost::gregorian::date d(digits_to_int(begin, 4), digits_to_int(begin + 4, 2), digits_to_int(begin + 6, 2));
+        time = boost::posix_time::ptime(d, boost::posix_time::time_duration(digits_to_int(begin + 9, 2),
+                                                                            digits_to_int(begin + 11, 2),
+                                                                            digits_to_int(begin + 13, 2)));
+        return true;
+    }
 }
 
 void timeseries::open(std::string path)
 {
-    std::fstream file(path.c_str());
-    std::string line = "";
+    std::ifstream file(path.c_str(), std::ios::binary);
 
-    //tokenizer
-    regex_tokenizer token;
     //contains the column headers
     std::vector<std::string> header;
 
@@ -265,129 +336,138 @@ void timeseries::open(std::string path)
             << boost::errinfo_file_name(path));
 
     LOG_VERBOSE << "Parsing file " + path;
-    bool done = false;
-    token.set_regex("[^,\\r\\n\\s]+"); //anything but whitespace or ,
-    //read in the file, skip any blank lines at the top of the file
-    while (!done)
-    {
-        getline(file, line);
-        header = token.tokenize<std::string>(line);
 
-        //skip any line that is a blank, or that has text in it
-        if (header.size() != 0)
-            done = true;
+    // Read the whole file in one go and parse it in place. The buffer is null terminated so strtod always stops.
+    file.seekg(0, std::ios::end);
+    std::string buffer(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0, std::ios::beg);
+    file.read(&buffer[0], buffer.size());
 
-    }
+    const char* p = buffer.c_str();
+    const char* buffer_end = p + buffer.size();
 
-    //take that the number of headers is how many columns there should be
-    _cols = header.size();
+    // gives the next line as [line,line_end) and moves p to the start of the following one
+    const char* line = nullptr;
+    const char* line_end = nullptr;
+    auto next_line = [&]() -> bool
+    {
+        if (p >= buffer_end)
+            return false;
 
-//    for (std::vector<std::string>::const_iterator itr = header.begin();
-//            itr != header.end();
-//            itr++)
-//    {
-//        if (!_variables.insert(*itr))
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_insertion_error()
-//                    << errstr_info(std::string("Failed to insert ") + *itr)
-//                    << boost::errinfo_file_name(path)
-//                    );
-//
-//        }
-//    }
+        line = p;
+        line_end = static_cast<const char*>(memchr(p, '\n', buffer_end - p));
+        if (!line_end)
+            line_end = buffer_end;
+        p = line_end + 1;
+        return true;
+    };
 
+    std::vector< std::pair<const char*, const char*> > tokens;
 
+    //read in the file, skip any blank lines at the top of the file
+    while (header.empty())
+    {
+        if (!next_line())
+            BOOST_THROW_EXCEPTION(forcing_error() << errstr_info("No header found") << boost::errinfo_file_name(path));
 
-    //a string defined as anything with a letter in it or that has a special character in this list
-    //~`!@#$%^&*(){[}]|\:;"'<>.?/
-    regex_tokenizer floating("^[-+]?(?:[0-9]+\\.?(?:[0-9]*)?|\\.[0-9]+)(?:[eE][-+]?[0-9]+)?$");
-    regex_tokenizer dateTime("[0-9]{8}T[0-9]{6}"); //iso standard time
+        tokenize(line, line_end, tokens);
+        for (auto& t : tokens)
+            header.push_back(std::string(t.first, t.second));
+    }
 
-    std::vector<std::string> values; //values on a line
+    //take that the number of headers is how many columns there should be
+    _cols = header.size();
 
+    // upper bound on the number of rows so the columns are only allocated once
+    size_t max_rows = std::count(p, buffer_end, '\n') + 1;
 
-    token.set_regex("[^,\\r\\n\\s]+"); //anything but whitespace or ,
+    // the column types and storage are figured out from the first data line, then reused for the rest of the file.
+    // Columns are parsed into separate vectors and packed into the matrix once the file has been checked
+    std::unordered_map<std::string, variable_vec> parsed;
+    std::vector<variable_vec*> columns;
+    bool columns_resolved = false;
 
     int lines = 0;
+    size_t rows = 0;
 
-    //this is used to save the name of the date header so we can find it to check the timestep later
-    std::string dateHeader = "";
-
-    while (getline(file, line))
+    while (next_line())
     {
         lines++;
-        
 
-        values = token.tokenize<std::string>(line);
+        tokenize(line, line_end, tokens);
 
         //make sure it isn't a blank line
-        if (values.size() != 0)
+        if (tokens.empty())
+            continue;
+
+        if (tokens.size() != _cols)
         {
-            //get the col name
-            std::vector<std::string>::const_iterator headerItr = header.begin();
-
-            //how many cols, make sure that equals the number of headers read in.
-            size_t cols_so_far = 0;
-            //for each column
-            for (std::vector<std::string>::const_iterator itr = values.begin();
-                    itr != values.end();
-                    itr++)
-            {
-                std::vector<std::string> doubles;
-                std::vector<std::string> dates;
+            BOOST_THROW_EXCEPTION(forcing_badcast()
+                    << errstr_info("Expected " + std::to_string(_cols) + " columns on line " + std::to_string(rows) )
+                    << boost::errinfo_file_name(path)
+                    );
+        }
 
-                if ((doubles = floating.tokenize<std::string>(*itr)).size() == 1)
-                {
-//                    auto res = _variables.find(*headerItr);
-//                    if (res == _variables.end())
-//                        BOOST_THROW_EXCEPTION(forcing_lookup_error()
-//                            << errstr_info(std::string("Failed to find ") + *headerItr)
-//                            << boost::errinfo_file_name(path)
-//                            );
-                    try
-                    {
-                        //LOG_VERBOSE << "Found " << *headerItr << ": " << doubles[0];
-                        _variables[*headerItr].push_back(boost::lexical_cast<double>(doubles[0]));
-                    } catch (...)
-                    {
-                        BOOST_THROW_EXCEPTION(forcing_badcast()
-                                << errstr_info("Failed to cast " + doubles[0] + " to a double.")
-                                << boost::errinfo_file_name(path)
-                                );
-                    }
-                } else if ((dates = dateTime.tokenize<std::string>(*itr)).size() == 1)
+        if (!columns_resolved)
+        {
+            // mark the date column, if any
+            std::vector<bool> is_date(_cols, false);
+            for (size_t c = 0; c < _cols; c++)
+            {
+                double d;
+                boost::posix_time::ptime t;
+                if (!parse_double(tokens[c].first, tokens[c].second, d) &&
+                    parse_datetime(tokens[c].first, tokens[c].second, t))
                 {
-
-                    //LOG_VERBOSE << "Found " << *headerItr << ": " << dates[0];
-                    _date_vec.push_back(boost::posix_time::from_iso_string(dates[0])); //from_iso_string
-                    
-                    //now we know where the date colum is, we remove it from the hashmap if we haven't already
-                    _variables.erase(*headerItr);
-                  
+                    is_date[c] = true;
                 }
-                else
+            }
+
+            // now we know where the date colum is, every other column is a variable
+            columns.assign(_cols, nullptr);
+            for (size_t c = 0; c < _cols; c++)
+            {
+                if (!is_date[c])
                 {
-                    //something has gone horribly wrong
-                    BOOST_THROW_EXCEPTION(forcing_no_regexmatch()
-                            << errstr_info("Unable to match any regex for " + *itr + ". Line: " + std::to_string(lines))
-                            << boost::errinfo_file_name(path)
-                            );
+                    columns[c] = &parsed[header[c]];
+                    columns[c]->reserve(max_rows);
                 }
+            }
+            _date_vec.clear();
+            _date_vec.reserve(max_rows);
 
-                //next header
-                headerItr++;
-                cols_so_far++;
+            columns_resolved = true;
+        }
 
+        for (size_t c = 0; c < _cols; c++)
+        {
+            bool ok;
+            if (columns[c] == nullptr) // date column
+            {
+                boost::posix_time::ptime t;
+                ok = parse_datetime(tokens[c].first, tokens[c].second, t);
+                if (ok)
+                    _date_vec.push_back(t);
             }
-            if (cols_so_far != _cols)
+            else
             {
-                BOOST_THROW_EXCEPTION(forcing_badcast()
-                        << errstr_info("Expected " + std::to_string(_cols) + " columns on line " + std::to_string(_rows) )
+                double d;
+                ok = parse_double(tokens[c].first, tokens[c].second, d);
+                if (ok)
+                    columns[c]->push_back(d);
+            }
+
+            if (!ok)
+            {
+                //something has gone horribly wrong
+                BOOST_THROW_EXCEPTION(forcing_no_regexmatch()
+                        << errstr_info("Unable to match any regex for " + std::string(tokens[c].first, tokens[c].second) +
+                                       ". Line: " + std::to_string(lines))
                         << boost::errinfo_file_name(path)
                         );
             }
-            _rows++;
         }
+        rows++;
 
     } //end of file read
 
@@ -400,46 +480,38 @@ void timeseries::open(std::string path)
     //	- Each col has the same number of rows
     //	- Time steps are equal
 
-    //get iters for each variables
-    LOG_VERBOSE << "Read in " << _variables.size() << " variables";
-    std::string* headerItems = new std::string[_variables.size()];
-
-    int i = 0;
-    //build a list of all the headers
-    //unknown order
-    for (ts_hashmap::iterator itr = _variables.begin(); itr != _variables.end(); itr++)
+    //variables in the order they appear in the header
+    std::vector<std::string> names;
+    for (auto& h : header)
     {
-        //LOG_VERBOSE << itr->first;
-        headerItems[i++] = itr->first;
+        if (parsed.find(h) != parsed.end() && std::find(names.begin(), names.end(), h) == names.end())
+            names.push_back(h);
     }
 
-    //get and save each accessor
-    size_t d_length = _date_vec.size();
+    LOG_VERBOSE << "Read in " << names.size() << " variables";
 
+    size_t d_length = _date_vec.size();
 
-    for (unsigned int l = 0; l < _variables.size(); l++)
+    std::vector<variable_vec> data_columns;
+    data_columns.reserve(names.size());
+    for (auto& name : names)
     {
-        //compare all columns to date length
-        auto res = _variables.find( headerItems[l]);
-        if (res == _variables.end())
-            BOOST_THROW_EXCEPTION(forcing_lookup_error()
-                << errstr_info(std::string("Failed to find ") + headerItems[l])
-                << boost::errinfo_file_name(path)
-                );
+        auto& col = parsed[name];
 
         //check all cols are the same size as the first col
-        LOG_VERBOSE << "Column " + headerItems[l] + " length=" + boost::lexical_cast<std::string>( res->second.size()), + "expected=" + boost::lexical_cast<std::string>(d_length);
-        if (d_length != res->second.size())
+        LOG_VERBOSE << "Column " + name + " length=" + boost::lexical_cast<std::string>( col.size()), + "expected=" + boost::lexical_cast<std::string>(d_length);
+        if (d_length != col.size())
         {
-            LOG_ERROR << "Col " + headerItems[l] + " is a different size. Expected size="+boost::lexical_cast<std::string>(d_length);
+            LOG_ERROR << "Col " + name + " is a different size. Expected size="+boost::lexical_cast<std::string>(d_length);
             BOOST_THROW_EXCEPTION(forcing_lookup_error()
-                << errstr_info("Col " + headerItems[l] + " is a different size. Expected size="+boost::lexical_cast<std::string>(d_length))
+                << errstr_info("Col " + name + " is a different size. Expected size="+boost::lexical_cast<std::string>(d_length))
                 << boost::errinfo_file_name(path));
         }
-        
+
+        data_columns.push_back(std::move(col));
     }
 
-    delete[] headerItems;
+    _set_columns(names, data_columns);
 
     //we can only check date-time consistency if we have more than 1 datetime
     if (_date_vec.size() > 1)
@@ -507,22 +579,10 @@ void timeseries::to_file(std::string file)
             << boost::errinfo_file_name(file));
 
     
-    std::string* headerItems = new std::string[_variables.size()];
-
-    //build a list of all the headers
-    //unknown order
-    int i = 0;
     out << "datetime";
-    variable_vec::const_iterator *tItr = new variable_vec::const_iterator[_variables.size()];
-    for (ts_hashmap::iterator itr = _variables.begin(); itr != _variables.end(); itr++)
+    for (auto& name : _names)
     {
-        headerItems[i] = itr->first;
-        out << "," << itr->first;
-
-        //save vector iterators
-        tItr[i] = itr->second.begin();
-        _rows = itr->second.size();
-        i++;
+        out << "," << name;
     }
     out << std::endl;
 
@@ -530,16 +590,12 @@ void timeseries::to_file(std::string file)
     for (size_t k = 0; k < _rows; k++)
     {
         out << boost::posix_time::to_iso_string(_date_vec.at(k));
-        for (size_t j = 0; j < _variables.size(); j++)
+        for (size_t j = 0; j < _names.size(); j++)
         {
-            out << "," << *(tItr[j]);
-            tItr[j]++;
+            out << "," << _column(j)[k];
         }
         out << std::endl;
     }
-
-    delete[] tItr;
-    delete[] headerItems;
 }
 
 bool timeseries::is_open()
@@ -566,38 +622,9 @@ double timeseries::range_min(timeseries::iterator& start, timeseries::iterator&
 timeseries::iterator timeseries::begin()
 {
     iterator step;
+    step._currentStep._ts = this;
+    step._currentStep._row = 0;
 
-    //iterate over the map of vectors and build a list of all the variable names
-    //unknown order
-    for (auto& itr : _variables)
-    {
-//        auto res = step._currentStep->_itrs.insert(itr.first);
-        //create the keyname for this variable and store the iterator
-//        if (res == )
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_insertion_error()
-//                    << errstr_info("Failed to insert " + itr.first)
-//                    );
-//        }
-//
-        //insert the iterator
-        step._currentStep->_itrs[itr.first] = itr.second.begin();
-    }
-
-    //set the date vector to be the begining of the internal data vector
-    step._currentStep->_date_itr = _date_vec.begin();
-
-//    for (auto& itr : _variables)
-//   {
-//       LOG_DEBUG << itr.first << ":";
-//       for(auto& jtr : itr.second)
-//       {
-//           LOG_DEBUG << boost::lexical_cast<std::string>(jtr);
-//       }
-//       
-//   }
-   
-//    LOG_DEBUG << step->get("t");
     return step;
 
 }
@@ -606,133 +633,62 @@ timeseries::iterator timeseries::begin()
 timeseries::iterator timeseries::end()
 {
     iterator step;
-    //loop over the variable map and save the iterator to the end
-    //unknown order that'll get the variables in.
-    for (auto& itr : _variables)
-    {
-//        auto res = step._currentStep->_itrs.insert(itr.first);
-//        if (!)
-//        {
-//            BOOST_THROW_EXCEPTION(forcing_insertion_error()
-//                    << errstr_info("Failed to insert " + itr.first)
-//                    );
-//        }
-        step._currentStep->_itrs[itr.first] = itr.second.end();
+    step._currentStep._ts = this;
+    step._currentStep._row = _rows;
 
-    }
-    step._currentStep->_date_itr = _date_vec.end();
     return step;
 }
 
 
 timestep& timeseries::iterator::dereference() const
 {
-    return *_currentStep;
+    return _currentStep;
 }
 
 bool timeseries::iterator::equal(iterator const& other) const
 {
-    bool isEqual = false;
-
-    //different sizes? try to bail early
-    if (_currentStep->_itrs.size() != other._currentStep->_itrs.size())
-    {
-        return false;
-    }
-    
-    //no point checking headers as the order built is undefined
-    //check each iterator
-    for (auto& itr : _currentStep->_itrs)
-    {
-        for (auto& jtr : other._currentStep->_itrs)
-        {
-            if (itr.second == jtr.second)
-                isEqual = true;
-        }
-    }
-
-    if (isEqual && !(_currentStep->_date_itr == other._currentStep->_date_itr))
-        isEqual = false; //negate if the date vectors don't match
-    
-    return isEqual;
+    return _currentStep._ts == other._currentStep._ts &&
+           _currentStep._row == other._currentStep._row;
 
 }
 
 void timeseries::iterator::increment()
 {
-    //walks the map locking each node so that the increment can happen
-    //walk order is not guaranteed
-//    unsigned int size = _currentStep->_itrs.size();
-//    std::string *headers = new std::string[size];
-//    timestep::itr_map::accessor *accesors = new timestep::itr_map::accessor[size];
-    int i = 0;
-
-    for (auto& itr : _currentStep->_itrs)
-    {
-        itr.second++;
-//        _currentStep->_itrs.find(accesors[i], itr.first);
-//        (accesors[i]->second)++;
-//        i++;
-    }
-    
-    _currentStep->_date_itr++;
-//
-//    delete[] headers;
-//    delete[] accesors;
+    ++_currentStep._row;
 }
 
 void timeseries::iterator::decrement()
 {
-    //walks the map locking each node so that the increment can happen
-    //walk order is not guaranteed
-//    unsigned int size = _currentStep->_itrs.size();
-//    std::string *headers = new std::string[size];
-//    timestep::itr_map::accessor *accesors = new timestep::itr_map::accessor[size];
-//    int i = 0;
-
-    for (auto& itr : _currentStep->_itrs)
-    {
-//        _currentStep->_itrs.find(accesors[i], itr.first);
-//        (accesors[i]->second)--;
-        itr.second --;
-//        i++;
-    }
-    _currentStep->_date_itr--;
-//    delete[] headers;
-//    delete[] accesors;
-
+    --_currentStep._row;
 }
 
 timeseries::iterator::iterator()
 {
-    _currentStep = boost::make_shared<timestep>();
 }
 
 timeseries::iterator::iterator(const iterator& src)
 {
-    _currentStep = boost::make_shared<timestep>(src._currentStep);
+    _currentStep._ts = src._currentStep._ts;
+    _currentStep._row = src._currentStep._row;
 }
 
 timeseries::iterator::~iterator()
 {
-   // delete _currentStep;
 }
 
 timeseries::iterator& timeseries::iterator::operator=(const timeseries::iterator& rhs)
 {
-    if (this == &rhs)
-        return (*this);
-    _currentStep = boost::make_shared<timestep>(rhs._currentStep);
+    _currentStep._ts = rhs._currentStep._ts;
+    _currentStep._row = rhs._currentStep._row;
     return *this;
 }
 
 std::ptrdiff_t timeseries::iterator::distance_to(timeseries::iterator const& other) const
 {
-    return std::distance(this->_currentStep->_date_itr,other._currentStep->_date_itr);
+    return static_cast<std::ptrdiff_t>(other._currentStep._row) - static_cast<std::ptrdiff_t>(_currentStep._row);
 }
 
 void timeseries::iterator::advance(timeseries::iterator::difference_type N)
 {
-    for (int i = 0;i<N;i++)
-        this->increment();
+    _currentStep._row += N;
 }
\ No newline at end of file
@@ -59,14 +59,18 @@
 \class timeseries
 \brief Holds the meterological data.
 
-This class holds meterological data. Each variable name is a string which acts as a key into a map, with the map entry containing a tbb::concurrent_vector allowing for parallel usage.
+This class holds meterological data. The data are stored as a single column-major matrix, one column per variable.
+Each variable name is a string which acts as a key into a map giving the column index. Hot loops should resolve the
+column index once with column_index() and then use timestep::get(size_t)/set(size_t).
 
     "var1"        |     "var2"     |     "var3"   |
     ------------------------------------------------
     [...]         |      [...]     |      [...]   |
-    vector 1      |     vector 2   |     vector 3 |
+    column 0      |     column 1   |     column 2 |
     [...]         |      [...]     |      [...]   |
 
+Iterators and timesteps only hold the row index, so stepping through the timeseries doesn't allocate.
+
  */
 class timeseries// : boost::noncopyable
 {
@@ -108,11 +112,23 @@ public:
     date_vec get_date_timeseries();
 
     /**
-    * Returns a list of all the variable names in this timeseries
+    * Returns a list of all the variable names in this timeseries, in column order
     * \return A vector of variable names
     */
     std::vector<std::string> list_variables();
 
+    /**
+    * Returns the column index of a variable, for use with timestep::get(size_t) and timestep::set(size_t,double).
+    * The index is valid until the next call to subset, init or open. Throws forcing_lookup_error if the variable doesn't exist.
+    * \param variable Variable name
+    */
+    size_t column_index(const std::string& variable) const;
+
+    /**
+    * Returns true if the variable exists
+    */
+    bool has(const std::string& variable) const;
+
     /**
     * Returns the length (number of elements) of the timeseries.
     */
@@ -237,21 +253,33 @@ public:
     double range_max(timeseries::iterator& start, timeseries::iterator& end, std::string variable);
     
 private:
+    friend class timestep;
 
 #ifdef USE_SPARSEHASH
-    typedef google::dense_hash_map<std::string,variable_vec> ts_hashmap;
+    typedef google::dense_hash_map<std::string,size_t> ts_hashmap;
 #else
-    typedef std::unordered_map<std::string,variable_vec> ts_hashmap;
+    typedef std::unordered_map<std::string,size_t> ts_hashmap;
 #endif
 
-    // This is a hashmap interface, vector back end
-    // "var1"        |     "var2"     |     "var3"   |      
-    // ------------------------------------------------      
+    // This is a hashmap interface, column-major matrix back end
+    // "var1"        |     "var2"     |     "var3"   |
+    // ------------------------------------------------
     //      [...]    |      [...]     |      [...]   |
-    //    vector 1   |     vector 2   |     vector 3 |
+    //    column 0   |     column 1   |     column 2 |
     //      [...]    |      [...]     |      [...]   |
+    // _data[column * _rows + row]
     ts_hashmap _variables;
+    std::vector<std::string> _names; // column index -> name
+    variable_vec _data;
     date_vec _date_vec;
+
+    double* _column(size_t column) { return _data.data() + column * _rows; }
+
+    // replaces the matrix with the given columns
+    void _set_columns(const std::vector<std::string>& names, const std::vector<variable_vec>& columns);
+
+    // adds a column filled with value and returns its index
+    size_t _add_column(const std::string& name, double value);
     
     size_t _cols;
     size_t _rows;
@@ -259,9 +287,6 @@ private:
     std::string _file;
     size_t _timeseries_length;
 
-    
-    //pushes variables back, only useful for reading from a file
-    void push_back(double data, std::string variable);
 
 
 };
@@ -271,11 +296,12 @@ private:
  Used to iterate over the timeseries instance.
  Thread safe.
  Dereference returns a timestep object.
+ Only holds the timeseries and a row index, so copying, stepping and comparing are all O(1) and don't allocate.
   */
  class timeseries::iterator : public boost::iterator_facade<
                          timeseries::iterator,
                          timestep,
-                         boost::bidirectional_traversal_tag> 
+                         boost::random_access_traversal_tag> 
  {
  public:
     iterator();
@@ -294,8 +320,8 @@ private:
      void advance(timeseries::iterator::difference_type N);
      std::ptrdiff_t distance_to(iterator const& other) const;
 
-     //iterators for the current step
-     boost::shared_ptr<timestep> _currentStep;
+     //the current step. mutable as dereference is const
+     mutable timestep _currentStep;
 
  };
 
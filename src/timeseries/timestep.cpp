@@ -23,21 +23,19 @@
 
 
 #include "timestep.hpp"
+#include "timeseries.hpp"
 
 
 timestep::timestep(const boost::shared_ptr<timestep> src)
 {
-   
-    _itrs = itr_map(src->_itrs);
-
-    _date_itr = date_variable::iterator(src->_date_itr);
+    _ts = src->_ts;
+    _row = src->_row;
 }
 
 timestep::timestep()
 {
-#if USE_SPARSEHASH
-   _itrs.set_empty_key("");
-#endif
+    _ts = nullptr;
+    _row = 0;
 }
 
 timestep::~timestep()
@@ -49,9 +47,9 @@ std::string timestep::to_string()
 {
     std::stringstream s;
     s << get_posix() << "\t";
-    for (timestep::itr_map::const_iterator itr = _itrs.begin(); itr != _itrs.end(); itr++)
+    for (size_t c = 0; c < _ts->_names.size(); c++)
     {
-        s << boost::lexical_cast<std::string>(*(itr->second)) << std::string("\t");
+        s << boost::lexical_cast<std::string>(get(c)) << std::string("\t");
     }
 
     return s.str();
@@ -59,92 +57,76 @@ std::string timestep::to_string()
 
 int timestep::month()
 {
-    return _date_itr->date().month();
+    return get_posix().date().month();
 }
 
 
 int timestep::day()
 {
-    return _date_itr->date().day();
+    return get_posix().date().day();
 
 }
 
 int timestep::year()
 {
-    return _date_itr->date().year();
+    return get_posix().date().year();
 }
 
 int timestep::hour()
 {
-    return boost::posix_time::to_tm(*_date_itr).tm_hour;
+    return get_posix().time_of_day().hours();
 }
 int timestep::min()
 {
-    return boost::posix_time::to_tm(*_date_itr).tm_min;
+    return get_posix().time_of_day().minutes();
 }
 int timestep::sec()
 {
-    return boost::posix_time::to_tm(*_date_itr).tm_sec;
+    return get_posix().time_of_day().seconds();
 }
 
 
 boost::gregorian::date timestep::get_gregorian()
 {
-    boost::gregorian::date date;
-
-    date = boost::gregorian::from_string(boost::lexical_cast<std::string>(_date_itr->date()));
-    return date;
-
+    return get_posix().date();
 }
 
 boost::posix_time::ptime timestep::get_posix()
 {
-    return *_date_itr;
+    return _ts->_date_vec[_row];
 }
 
 bool timestep::has(const std::string &variable)
 {
-    auto res = _itrs.find(variable);
-
-    if(res == _itrs.end())
-        return false;
-    else
-        return true;
+    return _ts->has(variable);
 }
 
 double timestep::get(const std::string &variable)
 {
-#ifdef SAFE_CHECKS
-    auto res = _itrs.find(variable);
-    if(res == _itrs.end())
-        BOOST_THROW_EXCEPTION( forcing_lookup_error() << errstr_info("Variable " + variable + " does not exist."));
-#endif
-
-    return _itrs[variable][0];
+    return get(_ts->column_index(variable));
+}
 
+double timestep::get(size_t column)
+{
+    return _ts->_column(column)[_row];
 }
 
 void timestep::set(const std::string &variable, const double &value)
 {
-    //this is slower than just getting the value, but it prevents subtle bugs where
+    //column_index throws if the variable doesn't exist, which prevents subtle bugs where
     // a module tries to create a variable it didn't allocate in a provides call
-#ifdef SAFE_CHECKS
-    auto res = _itrs.find(variable);
-    if(res == _itrs.end())
-        BOOST_THROW_EXCEPTION( forcing_lookup_error() << errstr_info("Variable " + variable + " does not exist."));
-#endif
-
-    _itrs[variable][0] = value;
+    set(_ts->column_index(variable), value);
+}
 
+void timestep::set(size_t column, const double &value)
+{
+    _ts->_column(column)[_row] = value;
 }
 
 timestep::variable_vec::iterator timestep::get_itr(const std::string &varName)
 {
-    auto res = _itrs.find(varName);
-    if(res == _itrs.end())
-        BOOST_THROW_EXCEPTION( forcing_lookup_error() << errstr_info("Variable " + varName + " does not exist."));
+    size_t column = _ts->column_index(varName);
 
-    return res->second;
+    return _ts->_data.begin() + column * _ts->_rows + _row;
 
 }
-
@@ -25,26 +25,22 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp> // for boost::posix
 
-#ifdef USE_SPARSEHASH
-    #include <sparsehash/dense_hash_map>
-#else
-    #include <unordered_map>
-#endif
-
-#include <tbb/concurrent_vector.h>
 #include <vector>
 #include <cstddef>
-#include <unordered_map>
+#include <string>
 
 #include "exception.hpp"
 
 
 #include "logger.hpp"
 
+class timeseries;
+
 /**
 \class timestep
 
-Conceptualizes a timestep within a timeseries. Holds a map of iterators into the main timeseries vectors, allowing for easy access of variables, and ensuring all variables at at the same timestep.
+Conceptualizes a timestep within a timeseries. Holds the timeseries and the current row into it, allowing for easy access of variables, and ensuring all variables at at the same timestep.
+Variables may be accessed by name, or by the column index from timeseries::column_index, which avoids the name lookup.
  */
 class timestep
 {
@@ -71,7 +67,7 @@ public:
 
 
     /**
-    * Converts the current time step to a std::string. There is no guarantee made about variable output order.Dates will be in the form 2008-Feb-23 23:59:59
+    * Converts the current time step to a std::string. Variables are output in column order. Dates will be in the form 2008-Feb-23 23:59:59
     */
     std::string to_string();
 
@@ -118,11 +114,17 @@ public:
     boost::posix_time::ptime get_posix();
 
     /**
-    * Gets the value associated with a variable. If it doesn't exist, return NaN
+    * Gets the value associated with a variable. Throws forcing_lookup_error if it doesn't exist
     * \param variable Variable name
     */
     double get(const std::string &variable) ;
 
+    /**
+    * Gets the value of the variable in the given column
+    * \param column Column index from timeseries::column_index
+    */
+    double get(size_t column);
+
     /**
      * Returns true if the specified variable is available in the timeseries.
      */
@@ -140,19 +142,18 @@ public:
     */
     void set(const std::string &variable, const double &value);
 
+    /**
+    * Sets the value of the variable in the given column for this timestep
+    * \param column Column index from timeseries::column_index
+    * \param value the value
+    */
+    void set(size_t column, const double &value);
 
     
 private:
     friend class timeseries;
 
-#ifdef USE_SPARSEHASH
-    typedef google::dense_hash_map<std::string,variable_vec::iterator> itr_map;
-#else
-    typedef std::unordered_map<std::string,variable_vec::iterator> itr_map;
-#endif
-
-    //holds the iterators for the current timestep. 
-    //these are iterators into each vector in the variable hashmap
-    itr_map _itrs; 
-    date_variable::iterator _date_itr;
+    // the timeseries we are a row of, and which row
+    timeseries* _ts;
+    size_t _row;
 };
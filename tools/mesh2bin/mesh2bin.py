@@ -0,0 +1,155 @@
+#!/usr/bin/env python
+# Converts a CHM .mesh json file, and optionally any number of .param and .ic json files, into the binary mesh
+# format that CHM can mmap (see src/mesh/mesh_binary.hpp for the layout).
+#
+# Usage:
+#   python mesh2bin.py basin.mesh -p basin.param -p landcover.param -i basin.ic -o basin.chmbin
+#
+# The resulting file can be used directly as the "mesh" entry in the CHM configuration. Any parameter files still
+# listed in the configuration are loaded on top and override parameters of the same name in the binary file.
+
+import argparse
+import json
+import struct
+import sys
+from array import array
+
+MAGIC = b'CHMMESH\0'
+VERSION = 1
+
+# magic, version, is_geographic, nvertex, nelem, nparam, nic, has_global_id, then 10 offsets/lengths
+HEADER = struct.Struct('<8sII' + 'Q' * 5 + 'Q' * 10)
+
+
+def pad8(n):
+    return (n + 7) & ~7
+
+
+def f8(values):
+    a = array('d', (float(v) for v in values))
+    if sys.byteorder != 'little':
+        a.byteswap()
+    return a
+
+
+def i8(values):
+    a = array('q', (int(v) for v in values))
+    if sys.byteorder != 'little':
+        a.byteswap()
+    return a
+
+
+def flatten(rows):
+    return [v for r in rows for v in r]
+
+
+def names_block(names):
+    out = b''
+    for n in names:
+        b = n.encode('utf-8')
+        out += struct.pack('<Q', len(b)) + b + b'\0' * (pad8(len(b)) - len(b))
+    return out
+
+
+def load_columns(files, nelem, what):
+    cols = {}
+    for f in files:
+        with open(f) as fp:
+            data = json.load(fp)
+        for name, values in data.items():
+            if len(values) == 0:
+                print('%s %s is zero length and will be ignored.' % (what, name))
+                continue
+            if len(values) != nelem:
+                raise ValueError('%s %s in %s has %d values, expected %d' % (what, name, f, len(values), nelem))
+            # later files override earlier ones, as in CHM
+            cols[name] = f8(values)
+    return cols
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert CHM json mesh/param/ic files to a binary mesh')
+    parser.add_argument('mesh', help='.mesh json file')
+    parser.add_argument('-p', '--param', action='append', default=[], help='.param json file. Can be repeated')
+    parser.add_argument('-i', '--ic', action='append', default=[], help='initial condition json file. Can be repeated')
+    parser.add_argument('-o', '--output', required=True, help='output binary mesh')
+    args = parser.parse_args()
+
+    with open(args.mesh) as fp:
+        js = json.load(fp)
+
+    mesh = js['mesh']
+    nvertex = len(mesh['vertex'])
+    nelem = len(mesh['elem'])
+    vertex = f8(flatten(mesh['vertex']))
+    elem = i8(flatten(mesh['elem']))
+    neigh = i8(flatten(mesh['neigh']))
+
+    if nvertex != int(mesh['nvertex']) or nelem != int(mesh['nelem']):
+        raise ValueError('nvertex/nelem do not match the vertex/elem arrays')
+    if len(vertex) != 3 * nvertex or len(elem) != 3 * nelem or len(neigh) != 3 * nelem:
+        raise ValueError('vertex, elem and neigh entries must all have 3 items')
+
+    global_id = None
+    if 'cell_global_id' in mesh:
+        global_id = i8(mesh['cell_global_id'])
+
+    proj4 = mesh.get('proj4', '').encode('utf-8')
+
+    # parameters and ics embedded in the .mesh are loaded first, as CHM does
+    params = {}
+    for name, values in js.get('parameters', {}).items():
+        if len(values) > 0:
+            params[name] = f8(values)
+    params.update(load_columns(args.param, nelem, 'Parameter'))
+
+    ics = {}
+    for name, values in js.get('initial_conditions', {}).items():
+        if len(values) > 0:
+            ics[name] = f8(values)
+    ics.update(load_columns(args.ic, nelem, 'Initial condition'))
+
+    param_names = sorted(params.keys())
+    ic_names = sorted(ics.keys())
+
+    # lay out the sections, all 8 byte aligned
+    offset = pad8(HEADER.size)
+    sections = []
+
+    def add(buf):
+        nonlocal offset
+        start = offset
+        sections.append((start, buf))
+        offset = pad8(offset + len(buf))
+        return start
+
+    proj4_offset = add(proj4)
+    vertex_offset = add(vertex.tobytes())
+    elem_offset = add(elem.tobytes())
+    neigh_offset = add(neigh.tobytes())
+    global_id_offset = add(global_id.tobytes()) if global_id is not None else 0
+    param_names_offset = add(names_block(param_names))
+    param_offset = add(b''.join(params[n].tobytes() for n in param_names))
+    ic_names_offset = add(names_block(ic_names))
+    ic_offset = add(b''.join(ics[n].tobytes() for n in ic_names))
+
+    header = HEADER.pack(MAGIC, VERSION, int(mesh['is_geographic']),
+                         nvertex, nelem, len(param_names), len(ic_names), int(global_id is not None),
+                         proj4_offset, len(proj4),
+                         vertex_offset, elem_offset, neigh_offset, global_id_offset,
+                         param_names_offset, param_offset,
+                         ic_names_offset, ic_offset)
+
+    with open(args.output, 'wb') as out:
+        out.write(header)
+        for start, buf in sections:
+            out.seek(start)
+            out.write(buf)
+        out.truncate(offset)
+
+    print('Wrote %s: %d vertexes, %d elems, %d parameters, %d initial conditions' %
+          (args.output, nvertex, nelem, len(param_names), len(ic_names)))
+
+
+if __name__ == '__main__':
+    main()